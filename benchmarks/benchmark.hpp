@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+///Run a function several times
+/// \param runs number of runs
+/// \param run the function
+/// \return time the fastest run took, in milliseconds
+template <typename function>
+double fastestRun(size_t runs, function&& run)
+{
+	auto fastest = std::numeric_limits<double>::max();
+	for(size_t i { 0 }; i < runs; ++i)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		run();
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		fastest = std::min(fastest, elapsed.count());
+	}
+	return fastest;
+}
+
+///Print a line of results
+/// \param name what was measured
+/// \param milliseconds how long it took
+/// \param reference how long the reference took, to print the speedup. 0 to not print it
+inline void printResult(const std::string& name, double milliseconds, double reference = 0)
+{
+	std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3) << std::setw(12) << milliseconds << " ms";
+	if(reference > 0) std::cout << std::setprecision(2) << std::setw(10) << reference / milliseconds << 'x';
+	std::cout << '\n';
+}
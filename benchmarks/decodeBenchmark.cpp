@@ -0,0 +1,49 @@
+//Image decoding benchmark : parse glTF files, which decodes their images on the worker threads, with more and more workers.
+//Prints the time each worker count takes and the speedup against a single worker. Run from the build directory, or give the files
+//to load on the command line
+#include <Ogre.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Ogre_glTF.hpp>
+
+#include "benchmark.hpp"
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> files { argv + 1, argv + argc };
+	if(files.empty()) files = { "damagedHelmet/damagedHelmet.gltf", "BrainStem.glb", "Monster.glb" };
+
+	//Parsing doesn't need a render system, only the resource managers
+	auto root = std::make_unique<Ogre::Root>("", "", "Ogre_glTF_DecodeBenchmark.log");
+	Ogre::LogManager::getSingleton().getDefaultLog()->setDebugOutputEnabled(false);
+
+	const auto hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<size_t> workerCounts;
+	for(size_t workers { 1 }; workers < hardwareThreads; workers *= 2) workerCounts.push_back(workers);
+	workerCounts.push_back(hardwareThreads);
+
+	double singleWorker { 0 };
+	for(const auto workers : workerCounts)
+	{
+		//The worker count is only read when the loader starts its threads
+		Ogre_glTF::glTFLoader loader;
+		auto options			  = loader.getOptions();
+		options.workerThreadCount = workers;
+		loader.setOptions(options);
+
+		const auto time = fastestRun(5, [&] {
+			for(const auto& file : files)
+				if(!loader.loadFromFileSystem(file).isOk()) throw std::runtime_error("Could not load " + file);
+		});
+
+		if(workers == 1) singleWorker = time;
+		printResult(std::to_string(workers) + " worker threads", time, singleWorker);
+	}
+
+	return 0;
+}
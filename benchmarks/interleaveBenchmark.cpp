@@ -0,0 +1,104 @@
+//Vertex interleaving benchmark : interleave the vertices of the common layouts with interleaveVertices(), and with the loop
+//modelConverter used before it (one memcpy per attribute per vertex, the stride read through a virtual call every time). A primitive
+//small enough to stay in the cache shows what the loops cost, a million vertices show what reading and writing the memory costs
+#include "Ogre_glTF_vertexInterleaver.hpp"
+
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+
+using namespace Ogre_glTF;
+
+///Attribute read the way vertexBufferPart was : its stride through a virtual call
+struct referencePart
+{
+	virtual ~referencePart() = default;
+	virtual size_t getPartStride() const = 0;
+	const unsigned char* data;
+};
+
+///Attribute with a given size, in its own tightly packed array like most glTF accessors
+struct packedPart : referencePart
+{
+	size_t size;
+	packedPart(const unsigned char* address, size_t attributeSize) : size { attributeSize } { data = address; }
+	size_t getPartStride() const override { return size; }
+};
+
+///The loop constructVertexBuffer used to interleave vertices with
+void referenceInterleave(const std::vector<std::unique_ptr<referencePart>>& parts, unsigned char* destination, size_t vertexCount, size_t stride)
+{
+	size_t bytesWrittenInCurrentStride { 0 };
+	for(size_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+	{
+		bytesWrittenInCurrentStride = 0;
+		for(const auto& part : parts)
+		{
+			memcpy(destination + (bytesWrittenInCurrentStride + vertexIndex * stride), part->data + vertexIndex * part->getPartStride(), part->getPartStride());
+			bytesWrittenInCurrentStride += part->getPartStride();
+		}
+	}
+}
+
+///A layout to measure
+struct layout
+{
+	std::string name;
+	std::vector<size_t> sizes;
+};
+
+///Interleave vertices of each layout with both loops, and print how long they took
+/// \param layouts the layouts to measure
+/// \param vertexCount number of vertices of each layout
+/// \param runs number of times each loop is run, the fastest counts
+void measure(const std::vector<layout>& layouts, size_t vertexCount, size_t runs)
+{
+	std::cout << vertexCount << " vertices\n";
+
+	std::mt19937 random { 42 };
+	for(const auto& measured : layouts)
+	{
+		const auto stride = std::accumulate(std::begin(measured.sizes), std::end(measured.sizes), size_t(0));
+
+		std::vector<std::vector<unsigned char>> attributes;
+		std::vector<vertexSource> sources;
+		std::vector<std::unique_ptr<referencePart>> parts;
+		for(const auto size : measured.sizes)
+		{
+			attributes.emplace_back(vertexCount * size);
+			for(auto& byte : attributes.back()) byte = static_cast<unsigned char>(random());
+			sources.push_back({ attributes.back().data(), size, size });
+			parts.push_back(std::make_unique<packedPart>(attributes.back().data(), size));
+		}
+
+		std::vector<unsigned char> reference(vertexCount * stride), interleaved(vertexCount * stride);
+		const auto referenceTime = fastestRun(runs, [&] { referenceInterleave(parts, reference.data(), vertexCount, stride); });
+		const auto kernelTime	= fastestRun(runs, [&] { interleaveVertices(sources, interleaved.data(), vertexCount); });
+
+		std::cout << measured.name << (reference == interleaved ? "" : " (RESULTS DIFFER)") << '\n';
+		printResult("  previous loop", referenceTime);
+		printResult("  interleaveVertices", kernelTime, referenceTime);
+	}
+}
+
+int main()
+{
+	const std::vector<layout> layouts {
+		{ "normal, position, uv", { 12, 12, 8 } },
+		{ "normal, position, tangent, uv", { 12, 12, 16, 8 } },
+		{ "joints, normal, position, uv, weights", { 4, 12, 12, 8, 16 } },
+		{ "joints, normal, position, tangent, uv, weights", { 4, 12, 12, 16, 8, 16 } },
+		{ "qtangent, position, uv (quantized)", { 8, 8, 4 } },
+		{ "joints, qtangent, position, uv, weights (quantized)", { 4, 8, 8, 4, 4 } },
+		{ "position, color (generic loop)", { 12, 4 } },
+	};
+
+	measure(layouts, 8191, 1000);
+	measure(layouts, 1000000, 5);
+	return 0;
+}
@@ -0,0 +1,102 @@
+//Memory benchmark : load a GLB file with each loading path, every one in its own process, and print the peak resident memory each
+//process reached. The copying path is tinygltf reading the file in a vector and copying the BIN chunk again in the model. The in place
+//paths read the accessors from a memory mapping of the file, or from the bytes of the GlbFile resource. Run from the build directory,
+//or give the file to load on the command line. Use a large file : small ones are lost in the memory Ogre itself uses
+#include <Ogre.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+#include <Ogre_glTF.hpp>
+
+///Get the peak resident memory of this process, in bytes. 0 if the platform can't tell
+size_t peakResidentMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters {};
+	if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof counters)) return 0;
+	return size_t(counters.PeakWorkingSetSize);
+#else
+	rusage usage {};
+	if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return size_t(usage.ru_maxrss);
+#else
+	return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+///The ways to load the file, the first one loads nothing, to know what Ogre and the loader use on their own
+const std::vector<std::string> modes { "nothing", "copy", "mapped", "resource" };
+
+///Load a file the way a mode says, in this process, and print the peak resident memory
+/// \param mode one of the modes
+/// \param file the GLB file
+void measure(const std::string& mode, const std::string& file)
+{
+	//Parsing doesn't need a render system, only the resource managers
+	auto root = std::make_unique<Ogre::Root>("", "", "Ogre_glTF_MemoryBenchmark.log");
+	Ogre::LogManager::getSingleton().getDefaultLog()->setDebugOutputEnabled(false);
+
+	Ogre_glTF::glTFLoader loader;
+	auto options			  = loader.getOptions();
+	options.memoryMappedFiles = mode == "mapped";
+	loader.setOptions(options);
+
+	//The adapter is kept until the measure : a path that frees its copies only once done still has them at its peak
+	std::unique_ptr<Ogre_glTF::loaderAdapter> adapter;
+	if(mode == "copy" || mode == "mapped")
+		adapter = std::make_unique<Ogre_glTF::loaderAdapter>(loader.loadFromFileSystem(file));
+	else if(mode == "resource")
+	{
+		const auto separator = file.find_last_of("/\\");
+		const auto directory = separator == std::string::npos ? std::string { "./" } : file.substr(0, separator + 1);
+		const auto name		 = separator == std::string::npos ? file : file.substr(separator + 1);
+		auto& resources		 = Ogre::ResourceGroupManager::getSingleton();
+		resources.addResourceLocation(directory, "FileSystem");
+		resources.initialiseAllResourceGroups();
+		adapter = std::make_unique<Ogre_glTF::loaderAdapter>(loader.loadGlbResource(name));
+	}
+	if(adapter && !adapter->isOk()) throw std::runtime_error("Could not load " + file + " : " + adapter->getLastError());
+
+	std::cout << std::left << std::setw(40) << "  " + mode << std::right << std::setw(12) << peakResidentMemory() / 1024 << " KiB\n";
+}
+
+int main(int argc, char* argv[])
+{
+	//A process started by this benchmark : the mode, then the file
+	if(argc == 3)
+	{
+		measure(argv[1], argv[2]);
+		return 0;
+	}
+
+	const std::string file { argc > 1 ? argv[1] : "BrainStem.glb" };
+	std::cout << file << " : peak resident memory of a process that loads it with each path\n" << std::flush;
+
+	//The peak of a process never goes down : each path has to be measured in a process of its own
+	for(const auto& mode : modes)
+		if(std::system(("\"" + std::string { argv[0] } + "\" " + mode + " \"" + file + "\"").c_str()) != 0)
+			std::cerr << "  " << mode << " failed\n";
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+//Skin benchmark : create the meshes of skinned models with the library, which writes the compacted blend indices and weights in the
+//vertex buffer and only maps blend indices to bones, and with the path it used before on top of that : one bone assignment per vertex
+//and influence given to each submesh, then compiled by Ogre. Runs on the NULL render system, from the build directory, or give the
+//files to load
+#include <Ogre.h>
+#include <OgreMesh2.h>
+#include <OgreMeshManager2.h>
+#include <OgreSubMesh2.h>
+#include <Vao/OgreVertexArrayObject.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Ogre_glTF.hpp>
+
+#include "benchmark.hpp"
+
+#ifdef _DEBUG
+const char NULL_RENDER_PLUGIN[] = "RenderSystem_NULL_d";
+#else
+const char NULL_RENDER_PLUGIN[] = "RenderSystem_NULL";
+#endif
+
+///The path the library used before : every influence of every vertex given to the submesh one at a time, then compiled by Ogre. The
+///assignments use the bones of the submesh's blend index map, 4 per vertex like the glTF files, with the weights of a real vertex
+/// \param mesh a skinned mesh created by the library
+void assignEveryInfluence(const Ogre::MeshPtr& mesh)
+{
+	for(unsigned i { 0 }; i < mesh->getNumSubMeshes(); ++i)
+	{
+		auto subMesh	 = mesh->getSubMesh(i);
+		const auto& bones = subMesh->mBlendIndexToBoneIndexMap;
+		if(bones.empty() || subMesh->mVao[Ogre::VpNormal].empty()) continue;
+
+		const auto vertexCount = subMesh->mVao[Ogre::VpNormal].front()->getVertexBuffers().front()->getNumElements();
+		for(Ogre::uint32 vertex { 0 }; vertex < vertexCount; ++vertex)
+			for(size_t influence { 0 }; influence < 4; ++influence)
+				subMesh->addBoneAssignment(Ogre::VertexBoneAssignment(vertex, bones[(vertex + influence) % bones.size()], influence == 0 ? 0.7f : 0.1f));
+		subMesh->_compileBoneAssignments();
+	}
+}
+
+///Load a file, and time the creation of its mesh
+/// \param loader the loader
+/// \param file the file
+/// \param afterCreation what is done to the mesh once created, as part of the timed work
+/// \return the time the fastest run took, in milliseconds
+template <typename meshFunction>
+double timeMeshCreation(const Ogre_glTF::glTFLoader& loader, const std::string& file, meshFunction afterCreation)
+{
+	auto fastest = std::numeric_limits<double>::max();
+	for(size_t run { 0 }; run < 10; ++run)
+	{
+		//Parsing and vertex conversions happen when loading, the mesh is only created by getMesh()
+		auto adapter = loader.loadFromFileSystem(file);
+		if(!adapter.isOk()) throw std::runtime_error("Could not load " + file + " : " + adapter.getLastError());
+
+		Ogre::MeshPtr mesh;
+		fastest = std::min(fastest, fastestRun(1, [&] {
+							   mesh = adapter.getMesh();
+							   afterCreation(mesh);
+						   }));
+		Ogre::MeshManager::getSingleton().remove(mesh->getHandle());
+	}
+	return fastest;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> files { argv + 1, argv + argc };
+	if(files.empty()) files = { "CesiumMan.glb", "BrainStem.glb" };
+
+	auto root = std::make_unique<Ogre::Root>("", "", "Ogre_glTF_SkinBenchmark.log");
+	Ogre::LogManager::getSingleton().getDefaultLog()->setDebugOutputEnabled(false);
+	root->loadPlugin(NULL_RENDER_PLUGIN);
+	root->setRenderSystem(root->getAvailableRenderers().front());
+	root->initialise(false);
+
+	//Creating a window is what initializes the VaoManager
+	Ogre::NameValuePairList params;
+	root->createRenderWindow("Ogre_glTF_SkinBenchmark", 1, 1, false, &params);
+
+	Ogre_glTF::glTFLoader loader;
+	for(const auto& file : files)
+	{
+		const auto referenceTime = timeMeshCreation(loader, file, assignEveryInfluence);
+		const auto directTime	= timeMeshCreation(loader, file, [](const Ogre::MeshPtr&) {});
+
+		std::cout << file << '\n';
+		printResult("  bone assignment per influence", referenceTime);
+		printResult("  blend elements written directly", directTime, referenceTime);
+	}
+
+	return 0;
+}
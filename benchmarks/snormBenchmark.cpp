@@ -0,0 +1,50 @@
+//Normal map benchmark : convert a 4096x4096 RGBA normal map to SNORM with convertNormalsToSNORM(), and with the loop textureImporter
+//used before it (a ColourValue made with float math and written with PixelBox::setColourAt for every pixel)
+#include <OgrePixelBox.h>
+#include <OgreColourValue.h>
+
+#include <random>
+#include <vector>
+
+#include "Ogre_glTF_pixelConverter.hpp"
+
+#include "benchmark.hpp"
+
+using namespace Ogre_glTF;
+
+///The loop getNormalSNORM used to fill the texture with, writing into a CPU side pixel box instead of a locked buffer
+void referenceConversion(const std::vector<Ogre::uint8>& image, size_t width, size_t height, size_t component, Ogre::PixelBox& pixels)
+{
+	for(size_t y { 0 }; y < height; y++)
+		for(size_t x { 0 }; x < width; x++)
+			pixels.setColourAt(Ogre::ColourValue(2.0f * (float(image[component * (y * width + x) + 2]) / 255.0f) - 1.0f,
+												 2.0f * (float(image[component * (y * width + x) + 1]) / 255.0f) - 1.0f,
+												 2.0f * (float(image[component * (y * width + x) + 0]) / 255.0f) - 1.0f,
+												 1.0f),
+							   x,
+							   y,
+							   0);
+}
+
+int main()
+{
+	constexpr size_t size { 4096 }, component { 4 };
+
+	std::mt19937 random { 42 };
+	std::vector<Ogre::uint8> image(size * size * component);
+	for(auto& byte : image) byte = static_cast<Ogre::uint8>(random());
+
+	std::vector<Ogre::int8> converted(size * size * component);
+	Ogre::PixelBox pixels { Ogre::uint32(size), Ogre::uint32(size), 1, Ogre::PF_R8G8B8A8_SNORM, converted.data() };
+
+	const auto referenceTime  = fastestRun(3, [&] { referenceConversion(image, size, size, component, pixels); });
+	const auto kernelTime	 = fastestRun(3, [&] { convertNormalsToSNORM(image.data(), size * size, component, false, converted.data()); });
+	const auto twoChannelTime = fastestRun(3, [&] { convertNormalsToSNORM(image.data(), size * size, component, true, converted.data()); });
+
+	std::cout << size << 'x' << size << " RGBA normal map\n";
+	printResult("  previous setColourAt loop", referenceTime);
+	printResult("  convertNormalsToSNORM, RGBA", kernelTime, referenceTime);
+	printResult("  convertNormalsToSNORM, RG", twoChannelTime, referenceTime);
+
+	return 0;
+}
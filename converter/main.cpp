@@ -0,0 +1,207 @@
+//Offline converter : turn every glTF and GLB file of a directory tree into native Ogre files (v2 .mesh, .skeleton and pre-converted
+//textures). Runs on the NULL render system, loads the files in parallel, and only converts the files that changed since the last run.
+#include <Ogre.h>
+#include <OgreArchive.h>
+#include <OgreArchiveManager.h>
+#include <OgreFileSystemLayer.h>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+
+//The library we are using
+#include <Ogre_glTF.hpp>
+
+#ifdef _DEBUG
+const char NULL_RENDER_PLUGIN[] = "RenderSystem_NULL_d";
+#else
+const char NULL_RENDER_PLUGIN[] = "RenderSystem_NULL";
+#endif
+
+///Name of the file, written in the output directory, that remembers the content key of every converted file
+const char MANIFEST_NAME[] = "glTF_conversion_manifest.txt";
+
+///First line of the manifest. Change it when the output of the converter changes, to convert everything again
+const char MANIFEST_VERSION[] = "Ogre_glTF conversion manifest 2";
+
+///Content key of each converted file, by path relative to the input directory
+using manifest = std::map<std::string, std::string>;
+
+void printUsage()
+{
+	std::cout << "Usage : Ogre_glTF_Converter <input directory> <output directory> [worker thread count]\n"
+				 "Convert every .glb and .gltf file found in the input directory (and its subdirectories) to native Ogre files.\n"
+				 "Files that didn't change since the last conversion are skipped.\n";
+}
+
+///Make sure a path ends with a separator
+std::string asDirectory(std::string path)
+{
+	if(!path.empty() && path.back() != '/' && path.back() != '\\') path += '/';
+	return path;
+}
+
+///Get the content key of a file : it covers the file, the buffers and images it references, and the options of the loader, so
+///a file is converted again when any of them changes. Empty if the file can't be read, the loading reports the error
+std::string getContentKey(const Ogre_glTF::glTFLoader& gltf, const std::string& path)
+{
+	try
+	{
+		return gltf.getContentKey(path);
+	}
+	catch(const std::exception&)
+	{
+		return {};
+	}
+}
+
+///Read the manifest written by a previous run. Returns an empty one if there's none, or if it was written by another version
+manifest readManifest(const std::string& path)
+{
+	manifest content;
+	std::ifstream file(path);
+	std::string line;
+	if(!std::getline(file, line) || line != MANIFEST_VERSION) return content;
+
+	//Each line is the key, a space, and the path (that can contain spaces)
+	while(std::getline(file, line))
+	{
+		const auto separator = line.find(' ');
+		if(separator == std::string::npos) continue;
+		content[line.substr(separator + 1)] = line.substr(0, separator);
+	}
+
+	return content;
+}
+
+///Write the manifest for the next run
+void writeManifest(const std::string& path, const manifest& content)
+{
+	std::ofstream file(path, std::ios_base::trunc);
+	file << MANIFEST_VERSION << '\n';
+	for(const auto& entry : content) file << entry.second << ' ' << entry.first << '\n';
+}
+
+///Create a directory and all its parents
+void createDirectories(const std::string& path)
+{
+	for(auto separator = path.find_first_of("/\\", 1); separator != std::string::npos; separator = path.find_first_of("/\\", separator + 1))
+		Ogre::FileSystemLayer::createDirectory(path.substr(0, separator));
+	Ogre::FileSystemLayer::createDirectory(path);
+}
+
+///A file being loaded by the worker threads
+struct conversionJob
+{
+	///Path relative to the input directory
+	std::string relativePath;
+
+	///Content key of the file
+	std::string hash;
+
+	///The loading in progress
+	std::future<Ogre_glTF::loaderAdapter> adapter;
+};
+
+int main(int argc, char* argv[])
+{
+	if(argc < 3)
+	{
+		printUsage();
+		return 1;
+	}
+
+	const auto inputDirectory  = asDirectory(argv[1]);
+	const auto outputDirectory = asDirectory(argv[2]);
+	const auto threadCount	 = argc > 3 ? size_t(std::stoul(argv[3])) : size_t(0);
+
+	//No configuration files, no window to show : the NULL render system is enough to build meshes and skeletons
+	auto root = std::make_unique<Ogre::Root>("", "", "Ogre_glTF_Converter.log");
+	root->loadPlugin(NULL_RENDER_PLUGIN);
+	root->setRenderSystem(root->getAvailableRenderers().front());
+	root->initialise(false);
+
+	//Creating a window is what initializes the VaoManager
+	Ogre::NameValuePairList params;
+	root->createRenderWindow("Ogre_glTF_Converter", 1, 1, false, &params);
+
+	auto gltf	= std::make_unique<Ogre_glTF::glTFLoader>();
+	auto options = gltf->getOptions();
+	options.workerThreadCount = threadCount;
+	gltf->setOptions(options);
+
+	//List the files to convert
+	auto archive = Ogre::ArchiveManager::getSingleton().load(inputDirectory, "FileSystem", true);
+	std::vector<std::string> inputs;
+	for(const auto pattern : { "*.glb", "*.gltf" })
+	{
+		const auto found = archive->find(pattern, true);
+		inputs.insert(std::end(inputs), std::begin(*found), std::end(*found));
+	}
+
+	createDirectories(outputDirectory);
+	const auto previousManifest = readManifest(outputDirectory + MANIFEST_NAME);
+	manifest currentManifest;
+
+	size_t converted { 0 }, skipped { 0 }, failed { 0 };
+
+	//Export the oldest file being loaded. Exporting creates Ogre resources, so it has to happen on this thread
+	std::deque<conversionJob> jobs;
+	const auto exportOldest = [&] {
+		auto job = std::move(jobs.front());
+		jobs.pop_front();
+
+		const auto lastSeparator = job.relativePath.find_last_of("/\\");
+		const auto subdirectory  = lastSeparator == std::string::npos ? std::string {} : job.relativePath.substr(0, lastSeparator + 1);
+		const auto fileName		 = job.relativePath.substr(subdirectory.size());
+		const auto baseName		 = fileName.substr(0, fileName.find_last_of('.'));
+
+		try
+		{
+			auto adapter = job.adapter.get();
+			createDirectories(outputDirectory + subdirectory);
+			adapter.exportNative(outputDirectory + subdirectory, baseName);
+
+			currentManifest[job.relativePath] = job.hash;
+			++converted;
+			std::cout << "Converted " << job.relativePath << '\n';
+		}
+		catch(const std::exception& e)
+		{
+			++failed;
+			std::cerr << "Failed to convert " << job.relativePath << " : " << e.what() << '\n';
+		}
+	};
+
+	//Keep a few files ahead of the export, without loading the whole tree in memory at once
+	const auto maxJobsInFlight = 2 * std::max<size_t>(1, threadCount ? threadCount : std::thread::hardware_concurrency());
+
+	for(const auto& input : inputs)
+	{
+		const auto hash = getContentKey(*gltf, inputDirectory + input);
+
+		//Unchanged since last time, and the output is still there
+		const auto previous = previousManifest.find(input);
+		const auto baseName = input.substr(0, input.find_last_of('.'));
+		if(!hash.empty() && previous != std::end(previousManifest) && previous->second == hash && std::ifstream(outputDirectory + baseName + ".mesh"))
+		{
+			currentManifest[input] = hash;
+			++skipped;
+			continue;
+		}
+
+		jobs.push_back({ input, hash, gltf->loadAsync(inputDirectory + input) });
+		if(jobs.size() >= maxJobsInFlight) exportOldest();
+	}
+
+	while(!jobs.empty()) exportOldest();
+
+	writeManifest(outputDirectory + MANIFEST_NAME, currentManifest);
+	std::cout << converted << " converted, " << skipped << " unchanged, " << failed << " failed\n";
+
+	return failed == 0 ? 0 : 1;
+}
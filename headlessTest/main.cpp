@@ -0,0 +1,347 @@
+//Headless tests : load the models shipped in the build directory on the NULL render system, and check the Ogre objects the loader
+//makes from them. Run from that directory, it also holds the Hlms data the datablocks need (like the demo program). The files the
+//tests generate are written to the directory given as argument, or to the temporary directory of the system.
+//Returns 0 if every test passed
+#include <Ogre.h>
+#include <OgreArchive.h>
+#include <OgreArchiveManager.h>
+#include <OgreFileSystemLayer.h>
+#include <OgreMesh2.h>
+#include <OgreSubMesh2.h>
+#include <Hlms/Pbs/OgreHlmsPbs.h>
+#include <Hlms/Pbs/OgreHlmsPbsDatablock.h>
+#include <Vao/OgreVertexArrayObject.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+//The library we are testing
+#include <Ogre_glTF.hpp>
+
+#ifdef _DEBUG
+const char NULL_RENDER_PLUGIN[] = "RenderSystem_NULL_d";
+#else
+const char NULL_RENDER_PLUGIN[] = "RenderSystem_NULL";
+#endif
+
+///Directory where the tests write the files they generate, with a separator at the end. Never the source tree
+std::string generatedFiles;
+
+///Fail the running test if a condition is false
+/// \param condition what should be true
+/// \param message what is wrong otherwise
+void check(bool condition, const std::string& message)
+{
+	if(!condition) throw std::runtime_error(message);
+}
+
+///Register HlmsPbs, the datablocks are made by it
+/// \param dataFolder directory that contains the Hlms folders
+void declareHlmsPbs(const std::string& dataFolder)
+{
+	Ogre::String dataFolderPath;
+	Ogre::StringVector libraryFoldersPaths;
+	Ogre::HlmsPbs::getDefaultPaths(dataFolderPath, libraryFoldersPaths);
+
+	auto& archiveManager = Ogre::ArchiveManager::getSingleton();
+	auto archivePbs		 = archiveManager.load(dataFolder + dataFolderPath, "FileSystem", true);
+	Ogre::ArchiveVec archivePbsLibraryFolders;
+	for(const auto& libraryFolderPath : libraryFoldersPaths)
+		archivePbsLibraryFolders.push_back(archiveManager.load(dataFolder + libraryFolderPath, "FileSystem", true));
+
+	auto hlmsPbs = OGRE_NEW Ogre::HlmsPbs(archivePbs, &archivePbsLibraryFolders);
+	Ogre::Root::getSingleton().getHlmsManager()->registerHlms(hlmsPbs);
+}
+
+///Check what every model should have : submeshes that draw triangles from vertices, and a datablock for each of them
+/// \param model the model, as returned by the loader
+/// \param name name of the file, for the messages
+void checkModel(const Ogre_glTF::ModelInformation& model, const std::string& name)
+{
+	check(model.mesh && model.mesh->getNumSubMeshes() > 0, name + " has no submesh");
+	check(model.pbrMaterialList.size() == model.mesh->getNumSubMeshes(), name + " doesn't have a datablock per submesh");
+
+	for(size_t i { 0 }; i < model.mesh->getNumSubMeshes(); ++i)
+	{
+		const auto& vaos = model.mesh->getSubMesh(i)->mVao[Ogre::VpNormal];
+		check(!vaos.empty() && !vaos.front()->getVertexBuffers().empty(), name + " has a submesh without vertices");
+		check(vaos.front()->getVertexBuffers().front()->getNumElements() > 0, name + " has a submesh without vertices");
+		check(model.pbrMaterialList[i] != nullptr, name + " has a submesh without datablock");
+	}
+}
+
+///Files loaded on the worker threads, several at once, give complete models
+void loadAsync()
+{
+	const std::vector<std::string> files { "CesiumMan.glb", "MyCube.glb", "damagedHelmet/damagedHelmet.gltf" };
+
+	Ogre_glTF::glTFLoader loader;
+	auto options			  = loader.getOptions();
+	options.workerThreadCount = 2;
+	loader.setOptions(options);
+
+	std::vector<std::future<Ogre_glTF::loaderAdapter>> pending;
+	for(const auto& file : files) pending.push_back(loader.loadAsync(file));
+
+	for(size_t i { 0 }; i < files.size(); ++i)
+	{
+		auto adapter = pending[i].get();
+		check(adapter.isOk(), files[i] + " didn't load : " + adapter.getLastError());
+		checkModel(adapter.getModelInformation(), files[i]);
+	}
+
+	//The skin is built on the worker too
+	check(Ogre::MeshManager::getSingleton().getByName("Cesium_Man")->hasSkeleton(), "CesiumMan.glb has no skeleton");
+
+	//A file that doesn't exist gives an adapter that says so, the error isn't lost on the worker
+	auto missing = loader.loadAsync("doesNotExist.glb").get();
+	check(!missing.isOk(), "a missing file loaded");
+	bool thrown { false };
+	try
+	{
+		missing.getModelInformation();
+	}
+	catch(const Ogre_glTF::LoadingError&)
+	{
+		thrown = true;
+	}
+	check(thrown, "a missing file didn't throw a LoadingError");
+}
+
+///Write a glTF file with a mesh of 4 triangles, each its own primitive with its own vertices. The first, second and fourth use the same
+///material, the third another one. The file and its buffer are written in the generated files directory
+/// \param baseName name of the files, without extension. Also the name of the mesh
+/// \param samePositions if true, every primitive reads the positions of the first one instead of its own, like primitives an exporter
+///cut from a mesh by material
+/// \return path to the glTF file
+std::string writeTrianglesModel(const std::string& baseName, bool samePositions = false)
+{
+	constexpr size_t primitiveCount { 4 }, primitiveBytes { 3 * 3 * sizeof(float) + 4 * sizeof(Ogre::uint16) };
+	const int materials[primitiveCount] { 0, 0, 1, 0 };
+
+	std::ofstream buffer(generatedFiles + baseName + ".bin", std::ios_base::binary | std::ios_base::trunc);
+	std::stringstream primitives, views, accessors;
+	for(size_t i { 0 }; i < primitiveCount; ++i)
+	{
+		const float x { float(i) }, positions[] { x, 0, 0, x + 1, 0, 0, x, 1, 0 };
+		const Ogre::uint16 indices[] { 0, 1, 2, 0 };
+		buffer.write(reinterpret_cast<const char*>(positions), sizeof positions);
+		buffer.write(reinterpret_cast<const char*>(indices), sizeof indices);
+
+		const auto separator = i == 0 ? "" : ",";
+		primitives << separator << R"({"attributes":{"POSITION":)" << (samePositions ? 0 : 2 * i) << R"(},"indices":)" << 2 * i + 1 << R"(,"material":)" << materials[i] << '}';
+		views << separator << R"({"buffer":0,"byteOffset":)" << i * primitiveBytes << R"(,"byteLength":36},)"
+			  << R"({"buffer":0,"byteOffset":)" << i * primitiveBytes + 36 << R"(,"byteLength":6})";
+		accessors << separator << R"({"bufferView":)" << 2 * i << R"(,"componentType":5126,"count":3,"type":"VEC3","min":[)" << x << R"(,0,0],"max":[)"
+				  << x + 1 << R"(,1,0]},{"bufferView":)" << 2 * i + 1 << R"(,"componentType":5123,"count":3,"type":"SCALAR"})";
+	}
+
+	const auto path = generatedFiles + baseName + ".gltf";
+	std::ofstream(path, std::ios_base::trunc)
+		<< R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],"meshes":[{"name":")" << baseName
+		<< R"(","primitives":[)" << primitives.str() << R"(]}],"materials":[{"name":"first"},{"name":"second"}],"buffers":[{"uri":")" << baseName
+		<< R"(.bin","byteLength":)" << primitiveCount * primitiveBytes << R"(}],"bufferViews":[)" << views.str() << R"(],"accessors":[)"
+		<< accessors.str() << "]}";
+	return path;
+}
+
+///Count the different vertex buffers and index buffers the submeshes of a mesh draw from
+/// \param mesh the mesh
+/// \return the number of vertex buffers, and the number of index buffers
+std::pair<size_t, size_t> countBuffers(const Ogre::MeshPtr& mesh)
+{
+	std::set<const Ogre::VertexBufferPacked*> vertexBuffers;
+	std::set<const Ogre::IndexBufferPacked*> indexBuffers;
+	for(size_t i { 0 }; i < mesh->getNumSubMeshes(); ++i)
+		for(const auto vao : mesh->getSubMesh(i)->mVao[Ogre::VpNormal])
+		{
+			vertexBuffers.insert(std::begin(vao->getVertexBuffers()), std::end(vao->getVertexBuffers()));
+			if(vao->getIndexBuffer()) indexBuffers.insert(vao->getIndexBuffer());
+		}
+	return { vertexBuffers.size(), indexBuffers.size() };
+}
+
+///Primitives with the same vertex format draw from one vertex buffer when they are pooled, each from its own submesh with its own
+///indices, and each submesh keeps the datablock of its material, even when the mesh was already made by another adapter
+void pooledVertexBuffers()
+{
+	const auto separatePath = writeTrianglesModel("separatePrimitives");
+	const auto pooledPath	= writeTrianglesModel("pooledPrimitives");
+
+	Ogre_glTF::glTFLoader loader;
+	auto separateAdapter = loader.loadFromFileSystem(separatePath);
+	const auto separate  = separateAdapter.getModelInformation();
+	check(separate.mesh->getNumSubMeshes() == 4, "the primitives don't have their own submesh");
+	check(countBuffers(separate.mesh) == std::make_pair<size_t, size_t>(4, 4), "every primitive doesn't have its own buffers");
+
+	auto options			  = loader.getOptions();
+	options.poolVertexBuffers = true;
+	loader.setOptions(options);
+
+	auto pooledAdapter = loader.loadFromFileSystem(pooledPath);
+	const auto pooled  = pooledAdapter.getModelInformation();
+	check(pooled.mesh->getNumSubMeshes() == 4, "pooled primitives don't have their own submesh");
+	check(countBuffers(pooled.mesh) == std::make_pair<size_t, size_t>(1, 4), "pooled primitives don't draw from one vertex buffer");
+	check(pooled.pbrMaterialList[0] == pooled.pbrMaterialList[1] && pooled.pbrMaterialList[0] != pooled.pbrMaterialList[2],
+		  "pooled submeshes don't have the datablock of their material");
+
+	auto againAdapter = loader.loadFromFileSystem(pooledPath);
+	const auto again  = againAdapter.getModelInformation();
+	check(again.mesh == pooled.mesh, "the mesh was made again");
+	check(again.pbrMaterialList == pooled.pbrMaterialList, "submeshes of an existing mesh got the datablock of another primitive");
+}
+
+///Primitives that read the same attribute accessors draw from a single vertex buffer with their own indices, that pooling doesn't copy,
+///and the mesh can be removed once nothing uses it
+void sharedVertexBuffer()
+{
+	const auto path = writeTrianglesModel("sharedVertices", true);
+
+	Ogre_glTF::glTFLoader loader;
+	auto options			   = loader.getOptions();
+	options.shareVertexBuffers = true;
+	options.poolVertexBuffers  = true;
+	loader.setOptions(options);
+
+	{
+		auto adapter	 = loader.loadFromFileSystem(path);
+		const auto model = adapter.getModelInformation();
+		check(model.mesh->getNumSubMeshes() == 4, "primitives with the same vertices don't have their own submesh");
+		check(countBuffers(model.mesh) == std::make_pair<size_t, size_t>(1, 4), "primitives with the same vertices don't share their vertex buffer");
+	}
+
+	check(loader.releaseUnusedMeshes() == 1, "the unused mesh with a shared vertex buffer wasn't released");
+	check(!Ogre::MeshManager::getSingleton().getByName("sharedVertices"), "the released mesh is still in the MeshManager");
+}
+
+///Normals and tangents stored on normalized bytes (KHR_mesh_quantization) are given to Hlms as a QTangent, the only integer normal it
+///reads, like the ones stored on normalized shorts
+void byteNormals()
+{
+	//A triangle : float positions, then byte normals and tangents padded to 4 bytes per vertex as the extension requires, then indices
+	const float positions[] { 0, 0, 0, 1, 0, 0, 0, 1, 0 };
+	const Ogre::int8 normals[] { 0, 0, 127, 0, 0, 0, 127, 0, 0, 0, 127, 0 }, tangents[] { 127, 0, 0, 127, 127, 0, 0, 127, 127, 0, 0, 127 };
+	const Ogre::uint16 indices[] { 0, 1, 2, 0 };
+
+	std::ofstream buffer(generatedFiles + "byteNormals.bin", std::ios_base::binary | std::ios_base::trunc);
+	buffer.write(reinterpret_cast<const char*>(positions), sizeof positions);
+	buffer.write(reinterpret_cast<const char*>(normals), sizeof normals);
+	buffer.write(reinterpret_cast<const char*>(tangents), sizeof tangents);
+	buffer.write(reinterpret_cast<const char*>(indices), sizeof indices);
+	buffer.close();
+
+	const auto path = generatedFiles + "byteNormals.gltf";
+	std::ofstream(path, std::ios_base::trunc)
+		<< R"({"asset":{"version":"2.0"},"extensionsUsed":["KHR_mesh_quantization"],"extensionsRequired":["KHR_mesh_quantization"],)"
+		<< R"("scene":0,"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],"meshes":[{"name":"byteNormals","primitives":[{"attributes":)"
+		<< R"({"POSITION":0,"NORMAL":1,"TANGENT":2},"indices":3}]}],"buffers":[{"uri":"byteNormals.bin","byteLength":68}],"bufferViews":[)"
+		<< R"({"buffer":0,"byteOffset":0,"byteLength":36},{"buffer":0,"byteOffset":36,"byteLength":12,"byteStride":4},)"
+		<< R"({"buffer":0,"byteOffset":48,"byteLength":12},{"buffer":0,"byteOffset":60,"byteLength":6}],"accessors":[)"
+		<< R"({"bufferView":0,"componentType":5126,"count":3,"type":"VEC3","min":[0,0,0],"max":[1,1,0]},)"
+		<< R"({"bufferView":1,"componentType":5120,"normalized":true,"count":3,"type":"VEC3"},)"
+		<< R"({"bufferView":2,"componentType":5120,"normalized":true,"count":3,"type":"VEC4"},)"
+		<< R"({"bufferView":3,"componentType":5123,"count":3,"type":"SCALAR"}]})";
+
+	Ogre_glTF::glTFLoader loader;
+	auto adapter	 = loader.loadFromFileSystem(path);
+	const auto model = adapter.getModelInformation();
+	checkModel(model, "byteNormals.gltf");
+
+	const auto& elements = model.mesh->getSubMesh(0)->mVao[Ogre::VpNormal].front()->getVertexBuffers().front()->getVertexElements();
+	const auto find		 = [&](Ogre::VertexElementSemantic semantic) {
+		 return std::find_if(std::begin(elements), std::end(elements), [&](const Ogre::VertexElement2& element) { return element.mSemantic == semantic; });
+	};
+	check(find(Ogre::VES_NORMAL) != std::end(elements) && find(Ogre::VES_NORMAL)->mType == Ogre::VET_SHORT4_SNORM, "byte normals aren't a QTangent");
+	check(find(Ogre::VES_TANGENT) == std::end(elements), "byte tangents are given to Hlms beside the QTangent");
+}
+
+///With generateMipmaps, a texture is created with the whole chain built on the CPU, and the render system isn't asked to make it
+void uploadedMipmaps()
+{
+	Ogre_glTF::glTFLoader loader;
+	auto options			= loader.getOptions();
+	options.generateMipmaps = true;
+	loader.setOptions(options);
+
+	//Not loaded by another test, its texture doesn't exist yet
+	auto adapter	   = loader.loadFromFileSystem("Monster.glb");
+	const auto model   = adapter.getModelInformation();
+	const auto texture = static_cast<Ogre::HlmsPbsDatablock*>(model.pbrMaterialList.front())->getTexture(Ogre::PBSM_DIFFUSE);
+	check(texture.get() != nullptr, "Monster.glb has no base colour texture");
+
+	Ogre::uint8 chainLength { 0 };
+	for(auto width = texture->getWidth(), height = texture->getHeight(); width > 1 || height > 1; ++chainLength)
+	{
+		width  = std::max<Ogre::uint32>(1, width / 2);
+		height = std::max<Ogre::uint32>(1, height / 2);
+	}
+	check(texture->getNumMipmaps() == chainLength, "the texture doesn't have its whole mipmap chain");
+	check((texture->getUsage() & Ogre::TU_AUTOMIPMAP) == 0, "the render system is asked to generate the mipmaps");
+}
+
+///A test, and its name
+struct headlessTest
+{
+	const char* name;
+	std::function<void()> run;
+};
+
+///Get the temporary directory of the system
+std::string temporaryDirectory()
+{
+	for(const auto variable : { "TMPDIR", "TEMP", "TMP" })
+		if(const auto value = std::getenv(variable)) return value;
+	return "/tmp";
+}
+
+int main(int argc, char* argv[])
+{
+	generatedFiles = (argc > 1 ? std::string { argv[1] } : temporaryDirectory() + "/Ogre_glTF_HeadlessTest") + '/';
+	Ogre::FileSystemLayer::createDirectory(generatedFiles);
+
+	//No configuration files, no window to show
+	auto root = std::make_unique<Ogre::Root>("", "", "Ogre_glTF_HeadlessTest.log");
+	root->loadPlugin(NULL_RENDER_PLUGIN);
+	root->setRenderSystem(root->getAvailableRenderers().front());
+	root->initialise(false);
+
+	//Creating a window is what initializes the VaoManager
+	Ogre::NameValuePairList params;
+	root->createRenderWindow("Ogre_glTF_HeadlessTest", 1, 1, false, &params);
+	declareHlmsPbs("./");
+	Ogre::ResourceGroupManager::getSingleton().addResourceLocation(generatedFiles, "FileSystem");
+
+	const std::vector<headlessTest> tests {
+		{ "loadAsync", loadAsync },
+		{ "pooledVertexBuffers", pooledVertexBuffers },
+		{ "sharedVertexBuffer", sharedVertexBuffer },
+		{ "byteNormals", byteNormals },
+		{ "uploadedMipmaps", uploadedMipmaps },
+	};
+
+	size_t failed { 0 };
+	for(const auto& test : tests)
+	{
+		try
+		{
+			test.run();
+			std::cout << "PASSED " << test.name << '\n';
+		}
+		catch(const std::exception& e)
+		{
+			++failed;
+			std::cout << "FAILED " << test.name << " : " << e.what() << '\n';
+		}
+	}
+
+	std::cout << tests.size() - failed << '/' << tests.size() << " tests passed\n";
+	return failed == 0 ? 0 : 1;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <future>
 #include <Ogre.h>
 #include <OgreItem.h>
 #include "Ogre_glTF_DLL.hpp"
@@ -26,7 +27,7 @@ namespace Ogre_glTF
 
 		///Smart pointer to the loaded mesh
 		Ogre::MeshPtr mesh;
-		///List of materials that correspond to each of the submeshes in the model
+		///List of materials that correspond to each of the submeshes in the model. Submeshes cut from the same primitive share one
 		std::vector<Ogre::HlmsDatablock*> pbrMaterialList;
 
 		///Local transform on the glTF node this model came from
@@ -45,6 +46,94 @@ namespace Ogre_glTF
 		} transform;
 	};
 
+	///Options that change how glTFLoader reads and converts assets
+	struct LoaderOptions
+	{
+		///Map files loaded from the filesystem in memory instead of reading them. The file is only opened once, and the converters read
+		///the binary chunk of GLB files in place. tinygltf still copies that chunk into the model while it parses the file : the copy
+		///only lives until parsing ends. The .bin files of .gltf files are read by tinygltf as usual, they are not mapped
+		bool memoryMappedFiles = false;
+
+		///Number of worker threads used for background loading and image decoding. 0 means one per hardware thread. Only read when
+		///the loader starts its threads, the first time a file is loaded
+		size_t workerThreadCount = 0;
+
+		///Don't decode images while loading. Only their compressed bytes are kept, and they are decoded when a material needs them.
+		///Decoded pixels and compressed bytes are released once every texture made from an image has been uploaded
+		bool decodeImagesOnDemand = false;
+
+		///Make the metalness and roughness textures as two full RGB(A) greyscale images, one pass over the metallicRoughness image for
+		///each, like older versions did. By default they are single channel (PF_L8) textures split from the image in one pass. Only
+		///useful to compare the two
+		bool legacyMetalRoughTextures = false;
+
+		///Store normal maps as PF_R8G8_SNORM, with only x and y. Hlms computes z in the shader. Half the memory of the default RGBA
+		///normal maps, at the cost of a square root per pixel
+		bool twoChannelNormalMaps = false;
+
+		///Name the textures after the content of the encoded image they are made from instead of after the file, so an image used by
+		///several files, by every adapter and every loader, is decoded, converted and uploaded once. Images all the textures of which
+		///already exist are not decoded. The textures stay in the TextureManager after the datablocks that use them are destroyed : call
+		///glTFLoader::releaseUnusedTextures() to remove them
+		bool shareTextures = false;
+
+		///Build the whole mipmap chain of every texture on the CPU, on the worker threads when the textures are prepared in advance, and
+		///upload it with the texture. Base colour and emissive images are averaged in linear space, normal maps are renormalized. The
+		///render system doesn't generate anything, so the result is the same with the NULL render system
+		bool generateMipmaps = false;
+
+		///Directory where converted models are cached, keyed by the content of the file, of the buffers and images it references, and
+		///these options (see glTFLoader::getContentKey()). When a file is found
+		///in the cache, glTF parsing and all the conversions are skipped. Only used for files loaded from the filesystem. Empty to disable
+		std::string cacheDirectory;
+
+		///Convert vertex attributes to smaller formats : normals and tangents to a 16 bit QTangent, texture coordinates and positions to half
+		///floats when they are precise enough. The bytes saved and the largest errors are written to the log for each mesh
+		bool quantizeVertices = false;
+
+		///Reorder the triangles of each primitive for the post transform vertex cache and to reduce overdraw, then renumber the vertices in
+		///the order they are used. The average cache miss ratio (ACMR) and transformed vertex ratio (ATVR) before and after are written to the log
+		bool optimizeIndices = false;
+
+		///Cut primitives that have more than 65535 vertices in several submeshes that use 16 bit indices, with the same material.
+		///Indices of smaller primitives are always stored on 16 bits. The submeshes of a split primitive follow each other in the mesh
+		bool splitLargeMeshes = false;
+
+		///Put the vertices of the primitives that have the same vertex format and index type in a single vertex buffer, instead of one
+		///buffer per primitive. Each primitive keeps its submesh and its own index buffer, that points to its range of the vertex buffer.
+		///Like with shareVertexBuffers, the loader keeps such a mesh alive until glTFLoader::releaseUnusedMeshes() removes it
+		bool poolVertexBuffers = false;
+
+		///Let the primitives that read the same attribute accessors, like the ones exporters cut from a mesh by material, draw from a
+		///single vertex buffer uploaded once, instead of each keeping the vertices its indices use. Their vertices are not reordered by
+		///optimizeIndices. Ogre can't destroy such a mesh by itself : the loader keeps it alive until glTFLoader::releaseUnusedMeshes()
+		///removes it, or until Ogre shuts down. Don't unload it yourself
+		bool shareVertexBuffers = false;
+
+		///Camera distances at which levels of detail of the mesh start to be used, one level per distance. Each level is made by collapsing
+		///the edges of the triangle lists that change the surface the least. UV and normal seams and the borders of the surface are kept,
+		///and skinned vertices are only merged with vertices that have similar bone weights. The distances are given to the level of detail
+		///strategy of the mesh. Only Ogre 2.1 lets the loader set them : with other versions the levels are generated but not used.
+		///Empty to not generate levels of detail
+		std::vector<float> lodDistances;
+
+		///Fraction of the triangles of the previous level each level of detail keeps
+		float lodReduction = 0.5f;
+
+		///Largest number of bones a vertex is influenced by, between 1 and 4 (the most Ogre skins with). Vertices with more, from the
+		///JOINTS_1 and WEIGHTS_1 attributes, keep the bones with the largest weights and the weights are renormalized. Joints are stored
+		///on a byte when the skeleton has 256 bones or less, and weights too when quantizeVertices is set
+		size_t maxBoneInfluences = 4;
+
+		///Give the shadow map passes a vertex buffer of their own, with only the positions (and the blend indices and weights of skinned
+		///meshes, and the texture coordinates of alpha tested materials). Vertices that only differed by their normal or UVs are welded
+		bool shadowCasterVertices = false;
+
+		///Fraction of the triangles of each level of detail the shadow casters keep, when shadowCasterVertices is on. Below 1, the
+		///shadow casters are simplified further than the meshes that are seen
+		float shadowCasterReduction = 1.0f;
+	};
+
 	///Plugin accessible interface that plugin users can use
 	struct glTFLoaderInterface
 	{
@@ -116,6 +205,18 @@ namespace Ogre_glTF
 
 		///Return the last error generated by the underlying glTF loading library
 		std::string getLastError() const;
+
+		///Create everything from the file (mesh, skeleton, datablocks) and return it in a ModelInformation structure.
+		///Need to be called from the thread that owns the render system. Throws a LoadingError if the file couldn't be loaded
+		ModelInformation getModelInformation();
+
+		///Write the content of the file as native Ogre files : a v2 .mesh, a .skeleton if the model is skinned, and the textures the
+		///materials use, already converted, as .ogltex files. The mesh and skeleton are only created for the time of the export.
+		///Need to be called from the thread that owns the render system (the NULL render system is fine)
+		/// \param directory existing directory where the files are written
+		/// \param baseName name of the files, without extension. The mesh refers to the skeleton as baseName.skeleton
+		/// \return paths of the written files
+		std::vector<std::string> exportNative(const std::string& directory, const std::string& baseName);
 	};
 
 	///Class that is responsible for initializing the library with the loader, and giving out
@@ -141,6 +242,13 @@ namespace Ogre_glTF
 		///Deinitialize the library at this object destruction
 		~glTFLoader();
 
+		///Set the options used by the next load operations
+		/// \param options the new options
+		void setOptions(const LoaderOptions& options);
+
+		///Get the options currently in use
+		const LoaderOptions& getOptions() const;
+
 		///Load a glTF text or binary file. Give you an adapter to use this file with Ogre
 		/// \param path String containing the path to a file to load (either .glTF or .glc)
 		loaderAdapter loadFromFileSystem(const std::string& path) const;
@@ -148,9 +256,39 @@ namespace Ogre_glTF
 		///Load a GLB from Ogre's resource manager
 		loaderAdapter loadGlbResource(const std::string& name) const;
 
+		///Load a glTF text or binary file on a worker thread. JSON parsing, image decoding, vertex interleaving and texture pixel conversions
+		///are done in the background. The adapter you get from the future only has to create the GPU objects (mesh, textures, datablocks):
+		///call getItem(), getMesh() or getModelInformation() on it from the thread that owns the render system.
+		/// \param path String containing the path to a file to load (either .glTF or .glb)
+		std::future<loaderAdapter> loadAsync(const std::string& path) const;
+
+		///Load many glTF text or binary files from the filesystem. Files are read, parsed and decoded on the worker threads a few files
+		///ahead of the one whose GPU objects are being created, so loading and uploading overlap. Buffers and images that are identical in
+		///multiple files are only stored and decoded once, and a path listed multiple times is only loaded once. The decoded images are
+		///kept until the whole batch is loaded, so a batch uses as much memory as all of its distinct images at once.
+		///Need to be called from the thread that owns the render system
+		/// \param paths paths to the files to load
+		/// \return the model data of each file, in the same order as the paths
+		std::vector<ModelInformation> loadBatch(const std::vector<std::string>& paths) const;
+
+		///Get a key that changes whenever loading a file would give something else : when the file, one of the buffers or images it
+		///references, or one of the options of this loader that change the conversion changes. Cache entries are named after it
+		/// \param path path to the glTF or GLB file. Throws FileIOError if it can't be read
+		std::string getContentKey(const std::string& path) const;
+
 		///Get the model data. Contains everything you need to create object from the model contained on the glTF asset
 		ModelInformation getModelData(const std::string& modelName, LoadFrom loadLocation) override;
 
+		///Remove from the TextureManager the textures shared between files (see LoaderOptions::shareTextures) that nothing holds a
+		///reference to anymore : no datablock, no adapter, no TexturePtr of yours. Need to be called from the thread that owns the render system
+		/// \return number of textures removed
+		size_t releaseUnusedTextures() const;
+
+		///Remove from the MeshManager the meshes with shared vertex buffers (see LoaderOptions::shareVertexBuffers) that nothing holds a
+		///reference to anymore : no item, no ModelInformation, no MeshPtr of yours. Need to be called from the thread that owns the render system
+		/// \return number of meshes removed
+		size_t releaseUnusedMeshes() const;
+
 		///Deleted copy constructor
 		glTFLoader(const glTFLoader&) = delete;
 
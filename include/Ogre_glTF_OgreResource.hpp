@@ -2,6 +2,7 @@
 
 #include <OgreSharedPtr.h>
 #include <OgreResourceManager.h>
+#include <memory>
 
 #include "Ogre_glTF_DLL.hpp"
 
@@ -13,12 +14,24 @@ namespace Ogre_glTF
 		///Internally use a type called "byte" to represent a byte
 		using byte = Ogre::uint8;
 
-		///Loaded data is a plain old string of bytes
-		std::vector<byte> data;
+		///Object that own the bytes of the file. Either a memory mapping of the file, or the memory stream that contains it
+		std::shared_ptr<const void> storage;
 
-		///Ogre does it's thing, and give you a "data stream". This fetch every byte out of that stream, and write it inside the vector of byte
+		///Start of the loaded data
+		const byte* data = nullptr;
+
+		///Number of bytes loaded
+		size_t dataSize = 0;
+
+		///Ogre does it's thing, and give you a "data stream". If it's already in memory, keep that memory. Otherwise, read it once in a memory stream
 		void readFromStream(Ogre::DataStreamPtr& stream);
 
+		///If the file is stored in a "FileSystem" archive, map it in memory directly instead of streaming it
+		bool mapFromFileSystem();
+
+		///Check that what has been loaded looks like a GLB file
+		void checkHeader() const;
+
 	protected:
 		///Ogre resource API: called by "load"
 		void loadImpl() override;
@@ -41,11 +54,14 @@ namespace Ogre_glTF
 		///Resource unloading, will dispose of memory
 		virtual ~GlbFile();
 
-		///Get the address of the data. This is effectively the start of the underlying vector
+		///Get the address of the data. The data stays where it was loaded, it's never copied around
 		const byte* getData() const;
 
-		///Get the number of bytes stored. This is effectivly the size of the vector
+		///Get the number of bytes stored
 		size_t getSize() const override;
+
+		///Get the object that owns the data. Holding it keeps the data alive even if the resource is unloaded
+		std::shared_ptr<const void> getStorage() const;
 	};
 
 	///Define a pointer type
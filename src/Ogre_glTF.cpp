@@ -7,6 +7,16 @@
 #include "Ogre_glTF_skeletonImporter.hpp"
 #include "Ogre_glTF_common.hpp"
 #include "Ogre_glTF_OgreResource.hpp"
+#include "Ogre_glTF_bufferResolver.hpp"
+#include "Ogre_glTF_mappedFile.hpp"
+#include "Ogre_glTF_threadPool.hpp"
+#include "Ogre_glTF_imageDecoder.hpp"
+#include "Ogre_glTF_stagedImageFile.hpp"
+#include "Ogre_glTF_modelCache.hpp"
+#include "Ogre_glTF_batchContent.hpp"
+#include "Ogre_glTF_sharedTextures.hpp"
+#include "Ogre_glTF_sharedVertexBuffers.hpp"
+#include "Ogre_glTF_internal_utils.hpp"
 
 #define TINYGLTF_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,6 +25,10 @@
 
 #include <OgreItem.h>
 #include <OgreMesh2.h>
+#include <OgreMeshManager2.h>
+#include <OgreMeshSerializer.h>
+#include <OgreOldSkeletonManager.h>
+#include <OgreSkeletonSerializer.h>
 
 using namespace Ogre_glTF;
 
@@ -23,7 +37,7 @@ struct loaderAdapter::impl
 {
 	///Constructor, initialize once all the objects inclosed in this class. They need a reference
 	///to a model object (and sometimes more) given at construct time
-	impl() : textureImp(model), materialLoad(model, textureImp), modelConv(model), skeletonImp(model) {}
+	impl() : buffers(model), textureImp(model), materialLoad(model, textureImp), modelConv(model, buffers), skeletonImp(model, buffers) {}
 
 	///Variable to check if everything is alright with the adapter
 	bool valid = false;
@@ -37,6 +51,9 @@ struct loaderAdapter::impl
 	///Where tinygltf will write it's warning messages
 	std::string warnings = "";
 
+	///Buffer resolver : know if the data of a buffer is inside the model, or somewhere else (e.g. in a memory mapped file)
+	bufferResolver buffers;
+
 	///Texture importer object : go through the texture array and load them into Ogre
 	textureImporter textureImp;
 
@@ -49,6 +66,123 @@ struct loaderAdapter::impl
 
 	///Skeleton importer : load skins from the glTF model, create equivalent OgreSkeleton objects
 	skeletonImporter skeletonImp;
+
+	///Cache the model is read from, or will be written to. Null if caching is disabled
+	std::unique_ptr<modelCache> cache;
+
+	///Key of the model in the cache
+	std::string cacheKey;
+
+	///True if the model has been read from the cache. The glTF model is empty then
+	bool fromCache = false;
+
+	///True once the model has been written to the cache, or if it doesn't need to be
+	bool cacheWritten = false;
+
+	///Transform read from the cache
+	ModelInformation::ModelTransform cachedTransform;
+
+	///True if the model read from the cache has a skeleton
+	bool cachedSkin = false;
+
+	///Use the content of a cache entry instead of the glTF model
+	/// \param content what has been read from the cache
+	void useCache(cachedModel content)
+	{
+		fromCache		= true;
+		cacheWritten	= true;
+		cachedTransform = content.transform;
+		cachedSkin		= content.skinned;
+		modelConv.setPreparedMesh(std::move(content.mesh));
+		materialLoad.setDescriptions(std::move(content.materials));
+		textureImp.addStagedTextures(std::move(content.textures));
+	}
+
+	///Return true if the mesh has a skeleton
+	bool hasSkeleton() const { return fromCache ? cachedSkin : modelConv.hasSkins(); }
+
+	///Get the skeleton of the mesh, from the model or from the cache
+	/// \param adapterName name of the adapter, used to name the skeleton
+	Ogre::v1::SkeletonPtr getSkeleton(const std::string& adapterName)
+	{
+		if(!fromCache) return skeletonImp.getSkeleton(adapterName);
+
+		const auto name = adapterName + "_cachedSkeleton";
+		auto skeleton	= Ogre::v1::OldSkeletonManager::getSingleton().getByName(name);
+		if(skeleton) return skeleton;
+		return cache->loadSkeleton(cacheKey, name);
+	}
+
+	///Textures converted for the cache, kept until the model is written to it
+	std::vector<stagedTexture> cacheTextures;
+
+	///Convert every texture the materials use, if the model is going to be written to the cache. Called before the textures are
+	///uploaded : the importer uploads copies of the conversions instead of doing them again, the originals wait for writeCache()
+	void stageCacheTextures()
+	{
+		if(!valid || !cache || cacheWritten || !cacheTextures.empty()) return;
+
+		cacheTextures = textureImp.stageAll();
+
+		//Plain images are still uploaded from the model
+		std::vector<stagedTexture> converted;
+		for(const auto& texture : cacheTextures)
+			if(texture.variant != textureVariant::plain) converted.push_back(texture);
+		textureImp.addStagedTextures(std::move(converted));
+	}
+
+	///Write the converted model to the cache, if enabled and not already done. Called once the mesh, the textures and the datablocks
+	///have been created without error, so a model that fails to convert is never cached. Needs to be called from the thread that owns
+	///the render system, as the skeleton is serialized from an Ogre skeleton. Failing to write is not an error, the model is still loaded
+	/// \param adapterName name of the adapter, used to name the skeleton
+	void writeCache(const std::string& adapterName)
+	{
+		if(!valid || !cache || cacheWritten) return;
+		cacheWritten = true;
+
+		try
+		{
+			Ogre::v1::SkeletonPtr skeleton;
+			if(modelConv.hasSkins()) skeleton = skeletonImp.getSkeleton(adapterName);
+
+			cache->write(cacheKey, modelConv.getTransform(), modelConv.getPreparedMesh(), materialLoad.describeAll(), cacheTextures, skeleton.get());
+		}
+		catch(const std::exception& e)
+		{
+			OgreLog("Could not write " + adapterName + " to the cache : " + e.what());
+		}
+
+		std::vector<stagedTexture>().swap(cacheTextures);
+	}
+
+	///Apply the loader options that change how the content is converted
+	/// \param options the options the file is loaded with
+	void setOptions(const LoaderOptions& options)
+	{
+		modelConv.setVertexQuantization(options.quantizeVertices);
+		textureImp.setLegacyMetalRough(options.legacyMetalRoughTextures);
+		textureImp.setTwoChannelNormals(options.twoChannelNormalMaps);
+		textureImp.setTextureSharing(options.shareTextures);
+		textureImp.setMipmapGeneration(options.generateMipmaps);
+		modelConv.setIndexOptimization(options.optimizeIndices);
+		modelConv.setLargeMeshSplitting(options.splitLargeMeshes);
+		modelConv.setVertexBufferPooling(options.poolVertexBuffers);
+		modelConv.setVertexBufferSharing(options.shareVertexBuffers);
+		modelConv.setLodGeneration(options.lodDistances, options.lodReduction);
+		modelConv.setMaxBoneInfluences(options.maxBoneInfluences);
+		modelConv.setShadowCasters(options.shadowCasterVertices, options.shadowCasterReduction);
+	}
+
+	///Do all the work that doesn't need the render system : vertex interleaving, texture pixel conversions...
+	///After this, only the creation of GPU objects is left to do. This can be called from a worker thread
+	/// \param workers if not null, the primitives are prepared in parallel on them
+	void prepare(threadPool* workers = nullptr)
+	{
+		if(!valid) return;
+
+		modelConv.prepareMesh(workers);
+		textureImp.prepareTextures(workers);
+	}
 };
 
 loaderAdapter::loaderAdapter() : pimpl { std::make_unique<impl>() } { OgreLog("Created adapter object..."); }
@@ -59,26 +193,32 @@ Ogre::Item* loaderAdapter::getItem(Ogre::SceneManager* smgr) const
 {
 	if(isOk())
 	{
+		pimpl->stageCacheTextures();
 		pimpl->textureImp.loadTextures();
 		Ogre::MeshPtr Mesh = getMesh();
 
 		auto Item = smgr->createItem(Mesh);
-		for(size_t i = 0; i < Item->getNumSubItems(); ++i) { Item->getSubItem(i)->setDatablock(getDatablock(i)); }
+		for(size_t i = 0; i < Item->getNumSubItems(); ++i) { Item->getSubItem(i)->setDatablock(getDatablock(pimpl->modelConv.getSubmeshPrimitive(i))); }
+		pimpl->writeCache(adapterName);
 		return Item;
 	}
 	return nullptr;
 }
 
-ModelInformation::ModelTransform loaderAdapter::getTransform() { return this->pimpl->modelConv.getTransform(); }
+ModelInformation::ModelTransform loaderAdapter::getTransform()
+{
+	if(pimpl->fromCache) return pimpl->cachedTransform;
+	return pimpl->modelConv.getTransform();
+}
 
 Ogre::MeshPtr loaderAdapter::getMesh() const
 {
 	auto Mesh = this->pimpl->modelConv.getOgreMesh();
 
-	if(this->pimpl->modelConv.hasSkins())
+	if(this->pimpl->hasSkeleton())
 	{
 		//load skeleton information
-		auto skeleton = this->pimpl->skeletonImp.getSkeleton(this->adapterName);
+		auto skeleton = this->pimpl->getSkeleton(this->adapterName);
 		Mesh->_notifySkeleton(skeleton);
 	}
 	return Mesh;
@@ -88,7 +228,68 @@ Ogre::HlmsDatablock* loaderAdapter::getDatablock(size_t index) const { return pi
 
 size_t loaderAdapter::getDatablockCount() { return pimpl->materialLoad.getDatablockCount(); }
 
-loaderAdapter::loaderAdapter(loaderAdapter&& other) noexcept : pimpl { std::move(other.pimpl) }
+ModelInformation loaderAdapter::getModelInformation()
+{
+	if(!isOk()) throw LoadingError("Can't create " + adapterName + ", it hasn't been loaded correctly : " + getLastError());
+
+	pimpl->stageCacheTextures();
+	pimpl->textureImp.loadTextures();
+
+	ModelInformation model;
+	model.mesh		= getMesh();
+	model.transform = getTransform();
+	for(size_t i { 0 }; i < model.mesh->getNumSubMeshes(); i++) model.pbrMaterialList.push_back(getDatablock(pimpl->modelConv.getSubmeshPrimitive(i)));
+
+	pimpl->writeCache(adapterName);
+	return model;
+}
+
+std::vector<std::string> loaderAdapter::exportNative(const std::string& directory, const std::string& baseName)
+{
+	if(!isOk()) throw LoadingError("Can't export " + adapterName + ", it hasn't been loaded correctly");
+
+	auto folder = directory;
+	if(!folder.empty() && folder.back() != '/' && folder.back() != '\\') folder += '/';
+
+	auto& content = *pimpl;
+	std::vector<std::string> files;
+
+	const auto meshPath = folder + baseName + ".mesh";
+	auto mesh			= content.modelConv.createOgreMesh(meshPath, true);
+
+	Ogre::v1::SkeletonPtr skeleton;
+	if(content.hasSkeleton())
+	{
+		//The mesh file refers to the skeleton by name, it has to be the name of the skeleton file
+		const auto skeletonFile = baseName + ".skeleton";
+		skeleton				= content.fromCache ? content.cache->loadSkeleton(content.cacheKey, skeletonFile) : content.skeletonImp.createSkeleton(skeletonFile);
+		mesh->_notifySkeleton(skeleton);
+
+		Ogre::v1::SkeletonSerializer().exportSkeleton(skeleton.get(), folder + skeletonFile);
+		files.push_back(folder + skeletonFile);
+	}
+
+	Ogre::MeshSerializer(Ogre::Root::getSingleton().getRenderSystem()->getVaoManager()).exportMesh(mesh.get(), meshPath);
+	files.push_back(meshPath);
+
+	for(const auto& texture : content.textureImp.stageAll())
+	{
+		//Don't use the texture name, it contains the id of the importer, that changes from one run to another
+		const auto texturePath = folder + baseName + "_image" + std::to_string(texture.imageIndex) + textureImporter::getVariantSuffix(texture.variant)
+			+ stagedImageFile::extension;
+		stagedImageFile::write(texturePath, texture.image);
+		files.push_back(texturePath);
+	}
+
+	//Only the files were needed
+	Ogre::MeshManager::getSingleton().remove(mesh->getHandle());
+	if(skeleton) Ogre::v1::OldSkeletonManager::getSingleton().remove(skeleton->getHandle());
+
+	OgreLog("Exported " + adapterName + " as " + std::to_string(files.size()) + " files in " + directory);
+	return files;
+}
+
+loaderAdapter::loaderAdapter(loaderAdapter&& other) noexcept : pimpl { std::move(other.pimpl) }, adapterName { std::move(other.adapterName) }
 {
 
 	OgreLog("Moved adapter object...");
@@ -96,7 +297,8 @@ loaderAdapter::loaderAdapter(loaderAdapter&& other) noexcept : pimpl { std::move
 
 loaderAdapter& loaderAdapter::operator=(loaderAdapter&& other) noexcept
 {
-	pimpl = std::move(other.pimpl);
+	pimpl		= std::move(other.pimpl);
+	adapterName = std::move(other.adapterName);
 	return *this;
 }
 
@@ -107,15 +309,83 @@ std::string loaderAdapter::getLastError() const { return pimpl->error; }
 ///Implementation of the glTF loader. Exist as a pImpl inside the glTFLoader class
 struct glTFLoader::glTFLoaderImpl
 {
-	///The loader object from TinyGLTF
-	tinygltf::TinyGLTF loader;
+	///Options used for loading
+	LoaderOptions options;
 
-	///Constructor. the loader is on the stack, there isn't much state to set inside the object
+	///Make sure the worker threads are only started once
+	mutable std::once_flag workersStarted;
+
+	///Worker threads used for background loading and image decoding, shared by all the files. Declared last so it's destroyed (and
+	///its pending tasks finished) first
+	mutable std::unique_ptr<threadPool> workers;
+
+	///Constructor. There isn't much state to set inside the object
 	glTFLoaderImpl() { OgreLog("initialized TinyGLTF loader"); }
 
+	///Get the worker threads. They are started the first time they are needed, with the thread count set in the options at that time
+	threadPool& getWorkers() const
+	{
+		std::call_once(workersStarted, [this] {
+			workers = std::make_unique<threadPool>(options.workerThreadCount);
+			OgreLog("Started " + std::to_string(workers->size()) + " worker threads");
+		});
+		return *workers;
+	}
+
+	///Parse a file with tinygltf. Images are not decoded during parsing, but on the worker threads, all at the same time
+	///If the images are decoded on demand, only their encoded bytes are kept, and given to the texture importer
+	/// \param adapter the adapter to load into
+	/// \param loadOptions the options to use for this file
+	/// \param batch content shared with the other files loaded at the same time, or nullptr
+	/// \param parse function that parses the file with the TinyGLTF object it gets
+	template <typename parsingFunction>
+	bool parseWith(loaderAdapter& adapter, const LoaderOptions& loadOptions, batchContent* batch, parsingFunction parse) const
+	{
+		tinygltf::TinyGLTF loader;
+		imageDecoder decoder(getWorkers(), loadOptions.decodeImagesOnDemand, batch, loadOptions.shareTextures);
+		decoder.install(loader);
+
+		const auto parsed  = parse(loader);
+		const auto decoded = decoder.finish(adapter.pimpl->model, adapter.pimpl->error);
+
+		//The hashes name the shared textures, they have to be known before the textures are listed
+		auto& textures = adapter.pimpl->textureImp;
+		textures.setImageHashes(decoder.takeImageHashes());
+		textures.addSharedPixels(decoder.takeSharedPixels());
+		if(loadOptions.decodeImagesOnDemand)
+			textures.setEncodedImages(decoder.takeEncodedImages());
+		else
+			textures.addSkippedImages(decoder.takeEncodedImages());
+		return parsed && decoded;
+	}
+
 	///For file type detection. Ascii is plain old JSON text, Binary is .glc files.
 	enum class FileType { Ascii, Binary, Unknown };
 
+	///Check if the given bytes start with the GLB magic number
+	/// \param bytes start of the file content
+	/// \param length number of bytes available
+	static bool hasBinaryMagic(const unsigned char* bytes, size_t length) { return length >= 4 && memcmp(bytes, "glTF", 4) == 0; }
+
+	///Determine the file type from the extension of the file
+	static FileType detectTypeFromExtension(const std::string& path)
+	{
+		auto extension = path.substr(path.find_last_of('.') + 1);
+		std::transform(std::begin(extension), std::end(extension), std::begin(extension), [](char c) { return char(tolower(int(c))); });
+		if(extension == "gltf") return FileType::Ascii;
+		if(extension == "glb") return FileType::Binary;
+
+		return FileType::Unknown;
+	}
+
+	///Get the directory that contains a file. Used to resolve external resources (buffers, images) of the glTF file
+	static std::string getBaseDirectory(const std::string& path)
+	{
+		const auto lastSeparator = path.find_last_of("/\\");
+		if(lastSeparator == std::string::npos) return "./";
+		return path.substr(0, lastSeparator + 1);
+	}
+
 	///Probe inside the file, or check the extension to determine if we have to load a text file, or a binary file
 	FileType detectType(const std::string& path) const
 	{
@@ -124,11 +394,10 @@ struct glTFLoader::glTFLoaderImpl
 			auto probe = std::ifstream(path, std::ios_base::binary);
 			if(!probe) throw FileIOError("Could not open " + path);
 
-			std::array<char, 5> buffer {};
-			for(size_t i { 0 }; i < 4; ++i) probe >> buffer[i];
-			buffer[4] = 0;
+			std::array<unsigned char, 4> buffer {};
+			probe.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
 
-			if(std::string("glTF") == std::string(buffer.data()))
+			if(hasBinaryMagic(buffer.data(), size_t(probe.gcount())))
 			{
 				//OgreLog("Detected binary file thanks to the magic number at the start!");
 				return FileType::Binary;
@@ -136,34 +405,142 @@ struct glTFLoader::glTFLoaderImpl
 		}
 
 		//If we don't have any better, check the file extension.
-		auto extension = path.substr(path.find_last_of('.') + 1);
-		std::transform(std::begin(extension), std::end(extension), std::begin(extension), [](char c) { return char(tolower(int(c))); });
-		if(extension == "gltf") return FileType::Ascii;
-		if(extension == "glb") return FileType::Binary;
-
-		return FileType::Unknown;
+		return detectTypeFromExtension(path);
 	}
 
-	///Load the content of a file into an adapter object
-	bool loadInto(loaderAdapter& adapter, const std::string& path)
+	///Load the content of a file into an adapter object. The TinyGLTF object is local, so this can be called from multiple threads at once
+	/// \param adapter the adapter to load into
+	/// \param path the path to the file
+	/// \param loadOptions the options to use for this file
+	/// \param batch content shared with the other files loaded at the same time, or nullptr
+	bool loadInto(loaderAdapter& adapter, const std::string& path, const LoaderOptions& loadOptions, batchContent* batch = nullptr) const
 	{
+		if(loadOptions.memoryMappedFiles) return loadMappedInto(adapter, path, loadOptions, batch);
+
+		auto& content = *adapter.pimpl;
 		switch(detectType(path))
 		{
 			default:
 			case FileType::Unknown: return false;
 			case FileType::Ascii:
 				//OgreLog("Detected ascii file type");
-				return loader.LoadASCIIFromFile(&adapter.pimpl->model, &adapter.pimpl->error, &adapter.pimpl->warnings, path);
+				return parseWith(adapter, loadOptions, batch, [&](tinygltf::TinyGLTF& loader) {
+					return loader.LoadASCIIFromFile(&content.model, &content.error, &content.warnings, path);
+				});
 			case FileType::Binary:
 				//OgreLog("Deteted binary file type");
-				return loader.LoadBinaryFromFile(&adapter.pimpl->model, &adapter.pimpl->error, &adapter.pimpl->warnings, path);
+				return parseWith(adapter, loadOptions, batch, [&](tinygltf::TinyGLTF& loader) {
+					return loader.LoadBinaryFromFile(&content.model, &content.error, &content.warnings, path);
+				});
+		}
+	}
+
+	///Load the content of a file into an adapter object by mapping the file in memory. The file is opened only once, the type is
+	///probed from the mapped bytes, and the binary chunk of a GLB file is read in place by the converters
+	bool loadMappedInto(loaderAdapter& adapter, const std::string& path, const LoaderOptions& loadOptions, batchContent* batch = nullptr) const
+	{
+		auto file			 = std::make_shared<mappedFile>(path);
+		auto& content		 = *adapter.pimpl;
+		const auto baseDir	= getBaseDirectory(path);
+		const auto fileType = hasBinaryMagic(file->data(), file->size()) ? FileType::Binary : detectTypeFromExtension(path);
+		const auto size		= internal_utils::parseableSize(file->size(), path);
+
+		switch(fileType)
+		{
+			default:
+			case FileType::Unknown: return false;
+			case FileType::Ascii:
+				//External buffers and images are resolved by tinygltf, the JSON text is not needed once parsed
+				return parseWith(adapter, loadOptions, batch, [&](tinygltf::TinyGLTF& loader) {
+					return loader.LoadASCIIFromString(
+						&content.model, &content.error, &content.warnings, reinterpret_cast<const char*>(file->data()), size, baseDir);
+				});
+			case FileType::Binary:
+			{
+				if(!parseWith(adapter, loadOptions, batch, [&](tinygltf::TinyGLTF& loader) {
+					   return loader.LoadBinaryFromMemory(&content.model, &content.error, &content.warnings, file->data(), size, baseDir);
+				   }))
+					return false;
+
+				//tinygltf always copies the binary chunk into the model while parsing, there's no way to give it a view instead.
+				//Give that memory back right away, and read the binary chunk from the mapping, which stays alive as long as the adapter
+				const auto bytes = file->data();
+				content.buffers.redirectGlbBinaryChunk(bytes, size, std::move(file));
+				return true;
+			}
+		}
+	}
+
+	///Load a GLB file from a resource. The binary chunk is read in place from the resource's memory, the model only holds the JSON content
+	///once parsed : tinygltf's own copy of the chunk is released as soon as the parsing ends
+	bool loadGlb(loaderAdapter& adapter, GlbFilePtr file, const LoaderOptions& loadOptions) const
+	{
+		auto& content	= *adapter.pimpl;
+		const auto size = internal_utils::parseableSize(file->getSize(), file->getName());
+		if(!parseWith(adapter, loadOptions, nullptr, [&](tinygltf::TinyGLTF& loader) {
+			   return loader.LoadBinaryFromMemory(&content.model, &content.error, &content.warnings, file->getData(), size, ".", 0);
+		   }))
+			return false;
+
+		//The storage is shared with the adapter, so the buffer survives the resource being unloaded
+		content.buffers.redirectGlbBinaryChunk(file->getData(), file->getSize(), file->getStorage());
+		return true;
+	}
+
+	///Replace the buffers stored in the model by copies shared with the other files of a batch
+	/// \param adapter the adapter that has just been loaded
+	/// \param batch content shared with the other files loaded at the same time
+	static void shareBuffers(loaderAdapter& adapter, batchContent& batch)
+	{
+		auto& content = *adapter.pimpl;
+		for(size_t i { 0 }; i < content.model.buffers.size(); ++i)
+		{
+			auto& data = content.model.buffers[i].data;
+
+			//Already served from somewhere else, like a mapped GLB file
+			if(data.empty()) continue;
+
+			auto shared = batch.shareBuffer(std::move(data));
+			content.buffers.redirect(int(i), shared->data(), shared->size(), shared);
 		}
 	}
 
-	bool loadGlb(loaderAdapter& adapter, GlbFilePtr file)
+	///Load a file from the filesystem into a new adapter
+	/// \param path the path to the file
+	/// \param loadOptions the options to use for this file
+	/// \param batch content shared with the other files loaded at the same time, or nullptr
+	loaderAdapter loadFromFileSystem(const std::string& path, const LoaderOptions& loadOptions, batchContent* batch = nullptr) const
 	{
-		return loader.LoadBinaryFromMemory(
-			&adapter.pimpl->model, &adapter.pimpl->error, &adapter.pimpl->warnings, file->getData(), int(file->getSize()), ".", 0);
+		OgreLog("loading file " + path);
+		loaderAdapter adapter;
+		adapter.adapterName = path;
+		adapter.pimpl->setOptions(loadOptions);
+
+		if(!loadOptions.cacheDirectory.empty())
+		{
+			auto& content	 = *adapter.pimpl;
+			content.cache	 = std::make_unique<modelCache>(loadOptions.cacheDirectory);
+			content.cacheKey = modelCache::getKey(path, loadOptions);
+			if(auto cached = content.cache->read(content.cacheKey))
+			{
+				OgreLog("Found " + path + " in the cache, skipping glTF parsing");
+				content.useCache(std::move(*cached));
+				content.valid = true;
+				return adapter;
+			}
+		}
+
+		adapter.pimpl->valid = loadInto(adapter, path, loadOptions, batch);
+		OgreLogPeakMemory("After loading " + path);
+		if(!adapter.pimpl->valid)
+		{
+			OgreLog("Could not load " + path + " : " + adapter.getLastError());
+			return adapter;
+		}
+
+		if(batch) shareBuffers(adapter, *batch);
+		adapter.pimpl->modelConv.debugDump();
+		return adapter;
 	}
 };
 
@@ -176,34 +553,85 @@ glTFLoader::glTFLoader() : loaderImpl { std::make_unique<glTFLoaderImpl>() }
 	OgreLog("glTFLoader created!");
 }
 
-loaderAdapter glTFLoader::loadFromFileSystem(const std::string& path) const
+loaderAdapter glTFLoader::loadFromFileSystem(const std::string& path) const { return loaderImpl->loadFromFileSystem(path, loaderImpl->options); }
+
+std::future<loaderAdapter> glTFLoader::loadAsync(const std::string& path) const
 {
-	OgreLog("loading file " + path);
-	loaderAdapter adapter;
-	adapter.adapterName = path;
-	loaderImpl->loadInto(adapter, path);
+	//The worker only knows about the implementation (that doesn't move), and a copy of the options as they are now
+	const auto implementation = loaderImpl.get();
+	const auto loadOptions	= loaderImpl->options;
+
+	return loaderImpl->getWorkers().submit([implementation, path, loadOptions] {
+		auto adapter = implementation->loadFromFileSystem(path, loadOptions);
+		adapter.pimpl->prepare(&implementation->getWorkers());
+		return adapter;
+	});
+}
+
+std::vector<ModelInformation> glTFLoader::loadBatch(const std::vector<std::string>& paths) const
+{
+	const auto implementation = loaderImpl.get();
+	const auto loadOptions	= loaderImpl->options;
+	auto& workers			  = loaderImpl->getWorkers();
+	auto batch				  = std::make_shared<batchContent>();
+
+	//A path listed multiple times is loaded for its first occurrence only
+	std::unordered_map<std::string, size_t> firstOccurrence;
+	std::vector<size_t> loadedAt(paths.size());
+	for(size_t i { 0 }; i < paths.size(); ++i) loadedAt[i] = firstOccurrence.emplace(paths[i], i).first->second;
+
+	std::vector<std::future<loaderAdapter>> loading(paths.size());
+	size_t nextToLoad { 0 };
+	const auto loadUpTo = [&](size_t end) {
+		for(; nextToLoad < std::min(end, paths.size()); ++nextToLoad)
+		{
+			if(loadedAt[nextToLoad] != nextToLoad) continue;
+			loading[nextToLoad] = workers.submit([implementation, path = paths[nextToLoad], loadOptions, batch] {
+				auto adapter = implementation->loadFromFileSystem(path, loadOptions, batch.get());
+				adapter.pimpl->prepare(&implementation->getWorkers());
+				return adapter;
+			});
+		}
+	};
 
-	//if (adapter.getLastError().empty())
+	//Keep the workers a few files ahead of the upload, without having the whole batch in memory at once
+	const auto filesAhead = 2 * workers.size();
+
+	std::vector<ModelInformation> models(paths.size());
+	for(size_t i { 0 }; i < paths.size(); ++i)
 	{
-		OgreLog("Debug : it looks like the file was loaded without error!");
-		adapter.pimpl->valid = true;
+		loadUpTo(i + 1 + filesAhead);
+		if(loadedAt[i] != i)
+		{
+			models[i] = models[loadedAt[i]];
+			continue;
+		}
+
+		//Help with the loading while waiting, then create the GPU objects while the workers go on with the next files
+		auto adapter = workers.get(loading[i]);
+		models[i]	= adapter.getModelInformation();
 	}
 
-	adapter.pimpl->modelConv.debugDump();
-	return adapter;
+	batch->logStatistics();
+	OgreLogPeakMemory("After loading a batch of " + std::to_string(paths.size()) + " files");
+	return models;
 }
 
 loaderAdapter glTFLoader::loadGlbResource(const std::string& name) const
 {
 	OgreLog("Loading GLB from resource manager " + name);
+	OgreLogPeakMemory("Before loading " + name);
 	auto& glbManager = GlbFileManager::getSingleton();
 	auto glbFile	 = glbManager.load(name, Ogre::ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME);
 
 	loaderAdapter adapter;
-	if(glbFile)
+	adapter.pimpl->setOptions(loaderImpl->options);
+	if(glbFile) adapter.pimpl->valid = loaderImpl->loadGlb(adapter, glbFile, loaderImpl->options);
+	OgreLogPeakMemory("After loading " + name);
+	if(!adapter.pimpl->valid)
 	{
-		loaderImpl->loadGlb(adapter, glbFile);
-		adapter.pimpl->valid = true;
+		OgreLog("Could not load " + name + " : " + adapter.getLastError());
+		return adapter;
 	}
 
 	adapter.pimpl->modelConv.debugDump();
@@ -222,17 +650,22 @@ ModelInformation glTFLoader::getModelData(const std::string& modelName, LoadFrom
 		return loaderAdapter {};
 	}();
 
-	if(!adapter.isOk()) OgreLog("adapter is signaling it isn't in \"ok\" state");
+	//Prepare the primitives on the workers now, instead of one after the other when the mesh is first asked for. Same for the
+	//mipmap chains of the textures
+	if(adapter.pimpl->valid)
+	{
+		adapter.pimpl->modelConv.prepareMesh(&loaderImpl->getWorkers());
+		if(loaderImpl->options.generateMipmaps) adapter.pimpl->textureImp.prepareTextures(&loaderImpl->getWorkers());
+	}
 
-	adapter.pimpl->textureImp.loadTextures();
+	return adapter.getModelInformation();
+}
 
-	ModelInformation model;
-	model.mesh		= adapter.getMesh();
-	model.transform = adapter.getTransform();
-	for(size_t i { 0 }; i < adapter.getDatablockCount(); i++) model.pbrMaterialList.push_back(adapter.getDatablock(i));
+std::string glTFLoader::getContentKey(const std::string& path) const { return modelCache::getKey(path, loaderImpl->options); }
 
-	return model;
-}
+size_t glTFLoader::releaseUnusedTextures() const { return sharedTextures::releaseUnused(); }
+
+size_t glTFLoader::releaseUnusedMeshes() const { return sharedVertexBuffers::releaseUnused(); }
 
 glTFLoader::glTFLoader(glTFLoader&& other) noexcept : loaderImpl(std::move(other.loaderImpl)) {}
 
@@ -243,3 +676,7 @@ glTFLoader& glTFLoader::operator=(glTFLoader&& other) noexcept
 }
 
 glTFLoader::~glTFLoader() = default;
+
+void glTFLoader::setOptions(const LoaderOptions& options) { loaderImpl->options = options; }
+
+const LoaderOptions& glTFLoader::getOptions() const { return loaderImpl->options; }
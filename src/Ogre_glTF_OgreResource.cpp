@@ -1,11 +1,51 @@
 #include "Ogre_glTF_OgreResource.hpp"
 #include "Ogre_glTF.hpp"
+#include "Ogre_glTF_common.hpp"
+#include "Ogre_glTF_mappedFile.hpp"
+#include <OgreArchive.h>
 
 void Ogre_glTF::GlbFile::readFromStream(Ogre::DataStreamPtr& stream)
 {
-	data.resize(stream->size());
-	stream->read(reinterpret_cast<void*>(data.data()), data.size());
+	//Archives that decompress their content (e.g. Zip) already give us the whole file in memory, just hold on to it
+	auto memoryStream = dynamic_cast<Ogre::MemoryDataStream*>(stream.get());
+	if(!memoryStream)
+	{
+		//Read the stream once, directly into the memory that we are going to use
+		stream		 = Ogre::DataStreamPtr(OGRE_NEW Ogre::MemoryDataStream(mName, stream, true, true));
+		memoryStream = static_cast<Ogre::MemoryDataStream*>(stream.get());
+	}
+
+	data	 = memoryStream->getPtr();
+	dataSize = memoryStream->size();
+	storage  = std::shared_ptr<const void>(data, [stream](const void*) { /*The stream is released with the last copy of this deleter*/ });
+}
+
+bool Ogre_glTF::GlbFile::mapFromFileSystem()
+{
+	const auto fileInfoList = Ogre::ResourceGroupManager::getSingleton().findResourceFileInfo(mGroup, mName);
+	if(fileInfoList.isNull() || fileInfoList->empty()) return false;
+
+	const auto& fileInfo = fileInfoList->front();
+	if(!fileInfo.archive || fileInfo.archive->getType() != "FileSystem") return false;
+
+	try
+	{
+		auto file = std::make_shared<mappedFile>(fileInfo.archive->getName() + "/" + fileInfo.filename);
+		data	  = file->data();
+		dataSize  = file->size();
+		storage   = std::move(file);
+		return true;
+	}
+	catch(const FileIOError& e)
+	{
+		(void)e;
+		OgreLog("Could not map " + mName + " in memory, streaming it instead");
+		return false;
+	}
+}
 
+void Ogre_glTF::GlbFile::checkHeader() const
+{
 	if(calculateSize() < 20) throw FileIOError("GLB file needs to be at least 20 bytes long. This cannot be possibly valid!");
 	{
 		char magic[5];
@@ -18,14 +58,21 @@ void Ogre_glTF::GlbFile::readFromStream(Ogre::DataStreamPtr& stream)
 
 void Ogre_glTF::GlbFile::loadImpl()
 {
-	auto stream = Ogre::ResourceGroupManager::getSingleton().openResource(mName, mGroup, true, this);
-	readFromStream(stream);
+	if(!mapFromFileSystem())
+	{
+		auto stream = Ogre::ResourceGroupManager::getSingleton().openResource(mName, mGroup, true, this);
+		readFromStream(stream);
+	}
+
+	checkHeader();
 }
 
 void Ogre_glTF::GlbFile::unloadImpl()
 {
-	data.clear();
-	data.resize(0);
+	//Anybody still reading from the data holds its own reference to the storage
+	storage  = nullptr;
+	data	 = nullptr;
+	dataSize = 0;
 }
 
 size_t Ogre_glTF::GlbFile::calculateSize() const { return getSize(); }
@@ -43,9 +90,11 @@ Ogre_glTF::GlbFile::GlbFile(Ogre::ResourceManager* creator,
 
 Ogre_glTF::GlbFile::~GlbFile() { GlbFile::unload(); }
 
-const Ogre_glTF::GlbFile::byte* Ogre_glTF::GlbFile::getData() const { return data.data(); }
+const Ogre_glTF::GlbFile::byte* Ogre_glTF::GlbFile::getData() const { return data; }
+
+size_t Ogre_glTF::GlbFile::getSize() const { return dataSize; }
 
-size_t Ogre_glTF::GlbFile::getSize() const { return data.size(); }
+std::shared_ptr<const void> Ogre_glTF::GlbFile::getStorage() const { return storage; }
 
 Ogre::Resource* Ogre_glTF::GlbFileManager::createImpl(const Ogre::String& name,
 													  Ogre::ResourceHandle handle,
@@ -0,0 +1,73 @@
+#include "Ogre_glTF_batchContent.hpp"
+#include "Ogre_glTF_threadPool.hpp"
+#include "Ogre_glTF_common.hpp"
+
+using namespace Ogre_glTF;
+
+batchContent::sharedBytes batchContent::shareBuffer(std::vector<unsigned char>&& data)
+{
+	//Hashing is the expensive part, don't hold the lock for it
+	const auto hash = contentHash(data.data(), data.size());
+
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto candidates = buffers.equal_range(hash);
+	for(auto it = candidates.first; it != candidates.second;)
+	{
+		auto existing = it->second.lock();
+		if(!existing)
+		{
+			it = buffers.erase(it);
+			continue;
+		}
+
+		if(*existing == data)
+		{
+			sharedBufferBytes += data.size();
+			std::vector<unsigned char>().swap(data);
+			return existing;
+		}
+		++it;
+	}
+
+	auto shared = std::make_shared<const std::vector<unsigned char>>(std::move(data));
+	buffers.emplace(hash, shared);
+	return shared;
+}
+
+std::shared_ptr<batchContent::sharedImage>
+	batchContent::decode(std::vector<unsigned char>&& encoded, int requiredWidth, int requiredHeight, threadPool& workers)
+{
+	const int requiredSize[] { requiredWidth, requiredHeight };
+	const auto hash = contentHash(encoded.data(), encoded.size(), contentHash(requiredSize, sizeof requiredSize));
+
+	std::lock_guard<std::mutex> lock(mutex);
+	const auto candidates = images.equal_range(hash);
+	for(auto it = candidates.first; it != candidates.second; ++it)
+	{
+		const auto& existing = it->second;
+		if(existing->requiredWidth == requiredWidth && existing->requiredHeight == requiredHeight && *existing->encoded == encoded)
+		{
+			++sharedImageCount;
+			return existing;
+		}
+	}
+
+	auto image			  = std::make_shared<sharedImage>();
+	image->encoded		  = std::make_shared<const std::vector<unsigned char>>(std::move(encoded));
+	image->requiredWidth  = requiredWidth;
+	image->requiredHeight = requiredHeight;
+
+	//The task only holds the encoded bytes, the image itself can go away with the batch before the decoding is done
+	image->decoded = workers.submit([bytes = image->encoded, requiredWidth, requiredHeight] {
+		return std::make_shared<const imageDecoder::decodedImage>(imageDecoder::decode(*bytes, requiredWidth, requiredHeight));
+	}).share();
+
+	images.emplace(hash, image);
+	return image;
+}
+
+void batchContent::logStatistics() const
+{
+	OgreLog("Batch loading shared " + std::to_string(sharedBufferBytes) + " bytes of identical buffers and " + std::to_string(sharedImageCount)
+			+ " identical images between files");
+}
@@ -0,0 +1,59 @@
+#include "Ogre_glTF_bufferResolver.hpp"
+#include "Ogre_glTF_common.hpp"
+
+#include <cstring>
+
+using namespace Ogre_glTF;
+
+bufferResolver::bufferResolver(tinygltf::Model& input) : model { input } {}
+
+const unsigned char* bufferResolver::data(int bufferIndex) const
+{
+	const auto external = externalBuffers.find(bufferIndex);
+	if(external != std::end(externalBuffers)) return external->second.address;
+
+	return model.buffers[bufferIndex].data.data();
+}
+
+size_t bufferResolver::size(int bufferIndex) const
+{
+	const auto external = externalBuffers.find(bufferIndex);
+	if(external != std::end(externalBuffers)) return external->second.size;
+
+	return model.buffers[bufferIndex].data.size();
+}
+
+void bufferResolver::redirect(int bufferIndex, const unsigned char* address, size_t size, std::shared_ptr<const void> owner)
+{
+	externalBuffers[bufferIndex] = { address, size };
+	owners.push_back(std::move(owner));
+
+	//Actually give the memory back, clear() alone would keep the capacity
+	std::vector<unsigned char>().swap(model.buffers[bufferIndex].data);
+}
+
+bool bufferResolver::redirectGlbBinaryChunk(const unsigned char* glb, size_t length, std::shared_ptr<const void> owner)
+{
+	//The buffer stored in the GLB is always the first one, and doesn't have an URI
+	if(model.buffers.empty() || !model.buffers.front().uri.empty()) return false;
+
+	//12 bytes header, followed by the JSON chunk (8 bytes of chunk header + content), then the BIN chunk
+	const auto readUint32 = [glb](size_t offset) {
+		uint32_t value;
+		memcpy(&value, glb + offset, sizeof value);
+		return value;
+	};
+
+	if(length < 20) return false;
+	const size_t jsonChunkLength = readUint32(12);
+	const size_t binChunkHeader  = 20 + jsonChunkLength;
+	if(binChunkHeader + 8 > length) return false;
+
+	const size_t binChunkLength = readUint32(binChunkHeader);
+	const uint32_t binChunkType = readUint32(binChunkHeader + 4);
+	if(binChunkType != 0x004E4942 /*"BIN\0"*/ || binChunkHeader + 8 + binChunkLength > length) return false;
+
+	OgreLog("Reading GLB binary chunk in place (" + std::to_string(binChunkLength) + " bytes)");
+	redirect(0, glb + binChunkHeader + 8, binChunkLength, std::move(owner));
+	return true;
+}
@@ -1,11 +1,44 @@
 #include "Ogre_glTF_common.hpp"
 
 #include <OgreLogManager.h>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	///Capture of the messages of this thread, if any
+	thread_local logCapture* threadCapture { nullptr };
+}
+
+logCapture::logCapture(std::vector<std::string>& output) : messages { output }, previous { threadCapture } { threadCapture = this; }
+
+logCapture::~logCapture() { threadCapture = previous; }
+
+logCapture* logCapture::current() { return threadCapture; }
+
+logCaptureSuspension::logCaptureSuspension() : suspended { threadCapture } { threadCapture = nullptr; }
+
+logCaptureSuspension::~logCaptureSuspension() { threadCapture = suspended; }
 
 void OgreLog(const std::string& message)
 {
 #ifdef _DEBUG
-	Ogre::LogManager::getSingleton().logMessage(message);
+	if(auto capture = logCapture::current())
+		capture->add(message);
+	else
+		Ogre::LogManager::getSingleton().logMessage(message);
 #else
 	//Do something with message?
 #endif
@@ -18,3 +51,55 @@ void OgreLog(const std::stringstream& message)
 #else
 #endif
 }
+
+size_t getPeakResidentMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters {};
+	if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof counters)) return 0;
+	return size_t(counters.PeakWorkingSetSize);
+#else
+	rusage usage {};
+	if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+	return size_t(usage.ru_maxrss); //Already in bytes
+#else
+	return size_t(usage.ru_maxrss) * 1024; //In kilobytes
+#endif
+#endif
+}
+
+void OgreLogPeakMemory(const std::string& context)
+{
+#ifdef _DEBUG
+	OgreLog(context + " : peak resident memory is " + std::to_string(getPeakResidentMemory() / 1024) + " KiB");
+#else
+	(void)context;
+#endif
+}
+
+uint64_t contentHash(const void* data, size_t size, uint64_t seed)
+{
+	constexpr uint64_t prime { 0x100000001b3ull };
+	const auto bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash { 0xcbf29ce484222325ull ^ seed ^ (uint64_t(size) * prime) };
+
+	//FNV style mixing, but on 8 bytes at a time instead of one, so hashing a big file is bounded by memory bandwidth
+	size_t i { 0 };
+	for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof word);
+		hash = (hash ^ word) * prime;
+		hash ^= hash >> 29;
+	}
+	for(; i < size; ++i) hash = (hash ^ bytes[i]) * prime;
+
+	//Murmur3 finalizer, so every input bit affects every output bit
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ull;
+	hash ^= hash >> 33;
+	return hash;
+}
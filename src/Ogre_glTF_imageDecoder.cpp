@@ -0,0 +1,148 @@
+#include "Ogre_glTF_imageDecoder.hpp"
+#include "Ogre_glTF_threadPool.hpp"
+#include "Ogre_glTF_batchContent.hpp"
+#include "Ogre_glTF_common.hpp"
+#include "Ogre_glTF_sharedTextures.hpp"
+
+#include "stb_image.h"
+
+#include <chrono>
+
+using namespace Ogre_glTF;
+
+imageDecoder::imageDecoder(threadPool& pool, bool deferred, batchContent* shared, bool skipShared) :
+ workers { pool },
+ deferDecoding { deferred },
+ skipSharedImages { skipShared },
+ batch { shared }
+{
+}
+
+imageDecoder::decodedImage imageDecoder::decode(const std::vector<unsigned char>& encoded, int requiredWidth, int requiredHeight)
+{
+	decodedImage output;
+
+	//Keep the channels the file has, the texture importer deals with RGB and RGBA
+	auto pixels = stbi_load_from_memory(encoded.data(), int(encoded.size()), &output.width, &output.height, &output.component, 0);
+	if(!pixels)
+	{
+		output.error = "Unknown image format or corrupted image data\n";
+		return output;
+	}
+
+	if((requiredWidth > 0 && requiredWidth != output.width) || (requiredHeight > 0 && requiredHeight != output.height))
+	{
+		output.error = "Image size mismatch\n";
+		stbi_image_free(pixels);
+		return output;
+	}
+
+	output.pixels.assign(pixels, pixels + size_t(output.width) * size_t(output.height) * size_t(output.component));
+	stbi_image_free(pixels);
+	return output;
+}
+
+bool imageDecoder::loadImageData(tinygltf::Image* image,
+								 const int imageIndex,
+								 std::string* error,
+								 std::string* warning,
+								 int requiredWidth,
+								 int requiredHeight,
+								 const unsigned char* bytes,
+								 int size,
+								 void* userData)
+{
+	(void)warning;
+
+	auto decoder = static_cast<imageDecoder*>(userData);
+	if(!decoder || !bytes || size <= 0)
+	{
+		if(error) *error += "Invalid image data for image " + std::to_string(imageIndex) + "\n";
+		return false;
+	}
+
+	//The bytes may point into a temporary buffer, or into a buffer that will be released after parsing, keep our own copy
+	std::vector<unsigned char> encoded(bytes, bytes + size);
+	const auto hash					 = contentHash(encoded.data(), encoded.size());
+	decoder->imageHashes[imageIndex] = hash;
+
+	//Image doesn't have any pixels yet, they'll be set by finish()
+	image->width	 = requiredWidth;
+	image->height	= requiredHeight;
+	image->component = 0;
+
+	//The textures made from this image are probably all there already, the texture importer decodes it if one is missing
+	if(decoder->deferDecoding || (decoder->skipSharedImages && sharedTextures::containsImage(hash)))
+	{
+		decoder->encodedImages[imageIndex] = std::move(encoded);
+		return true;
+	}
+
+	if(decoder->batch)
+	{
+		auto shared = decoder->batch->decode(std::move(encoded), requiredWidth, requiredHeight, decoder->workers);
+		decoder->pendingShared.emplace_back(imageIndex, shared->decoded);
+		return true;
+	}
+
+	decoder->pending.emplace_back(imageIndex, decoder->workers.submit([encoded = std::move(encoded), requiredWidth, requiredHeight] {
+		return decode(encoded, requiredWidth, requiredHeight);
+	}));
+	return true;
+}
+
+void imageDecoder::install(tinygltf::TinyGLTF& loader) { loader.SetImageLoader(&imageDecoder::loadImageData, this); }
+
+bool imageDecoder::finish(tinygltf::Model& model, std::string& error)
+{
+	if(pending.empty() && pendingShared.empty()) return true;
+
+	const auto start = std::chrono::steady_clock::now();
+	auto success	 = true;
+
+	//Set the size of the image in the model, or report why it couldn't be decoded
+	const auto describe = [&](int imageIndex, const decodedImage& decoded) {
+		if(!decoded.error.empty())
+		{
+			error += "Image " + std::to_string(imageIndex) + " : " + decoded.error;
+			success = false;
+			return false;
+		}
+
+		if(imageIndex < 0 || size_t(imageIndex) >= model.images.size()) return false;
+
+		auto& image		= model.images[imageIndex];
+		image.width		= decoded.width;
+		image.height	= decoded.height;
+		image.component = decoded.component;
+		return true;
+	};
+
+	//Wait for all of them, even after a failure: the tasks must not outlive the decoding
+	for(auto& decoding : pending)
+	{
+		auto decoded = workers.get(decoding.second);
+		if(describe(decoding.first, decoded)) model.images[decoding.first].image = std::move(decoded.pixels);
+	}
+
+	//Pixels shared with other files stay where they are, only a reference to them is kept
+	for(auto& decoding : pendingShared)
+	{
+		const auto decoded = workers.get(decoding.second);
+		if(describe(decoding.first, *decoded)) sharedImages[decoding.first] = sharedPixels(decoded, &decoded->pixels);
+	}
+
+	const auto waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+	OgreLog("Decoded " + std::to_string(pending.size() + pendingShared.size()) + " images on " + std::to_string(workers.size())
+			+ " worker threads, waited " + std::to_string(waited.count()) + "us after parsing");
+
+	pending.clear();
+	pendingShared.clear();
+	return success;
+}
+
+std::unordered_map<int, std::vector<unsigned char>> imageDecoder::takeEncodedImages() { return std::move(encodedImages); }
+
+std::unordered_map<int, imageDecoder::sharedPixels> imageDecoder::takeSharedPixels() { return std::move(sharedImages); }
+
+std::unordered_map<int, uint64_t> imageDecoder::takeImageHashes() { return std::move(imageHashes); }
@@ -0,0 +1,230 @@
+#include "Ogre_glTF_indexConverter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OGRE_GLTF_INDICES_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OGRE_GLTF_INDICES_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Get the number of indices of each element of a list primitive
+	/// \return 0 for strips and fans
+	size_t getElementSize(Ogre::OperationType operationType)
+	{
+		switch(operationType)
+		{
+			case Ogre::OT_POINT_LIST: return 1;
+			case Ogre::OT_LINE_LIST: return 2;
+			case Ogre::OT_TRIANGLE_LIST: return 3;
+			default: return 0;
+		}
+	}
+}
+
+bool Ogre_glTF::indicesFitIn16Bits(const Ogre::uint32* indices, size_t count)
+{
+	size_t i { 0 };
+
+#if defined(OGRE_GLTF_INDICES_SSE2)
+	//SSE2 only compares signed integers : flipping the sign bit of both sides gives an unsigned comparison
+	const auto signBit = _mm_set1_epi32(std::numeric_limits<int>::min());
+	const auto limit   = _mm_xor_si128(_mm_set1_epi32(int(largest16BitIndex)), signBit);
+	auto tooLarge	   = _mm_setzero_si128();
+	for(; i + 4 <= count; i += 4)
+	{
+		const auto values = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(indices + i)), signBit);
+		tooLarge		  = _mm_or_si128(tooLarge, _mm_cmpgt_epi32(values, limit));
+	}
+	if(_mm_movemask_epi8(tooLarge) != 0) return false;
+#elif defined(OGRE_GLTF_INDICES_NEON)
+	const auto limit = vdupq_n_u32(largest16BitIndex);
+	auto tooLarge	= vdupq_n_u32(0);
+	for(; i + 4 <= count; i += 4) tooLarge = vorrq_u32(tooLarge, vcgtq_u32(vld1q_u32(indices + i), limit));
+	const auto halves = vorr_u32(vget_low_u32(tooLarge), vget_high_u32(tooLarge));
+	if((vget_lane_u32(halves, 0) | vget_lane_u32(halves, 1)) != 0) return false;
+#endif
+
+	for(; i < count; ++i)
+	{
+		Ogre::uint32 index;
+		memcpy(&index, indices + i, sizeof index);
+		if(index > largest16BitIndex) return false;
+	}
+	return true;
+}
+
+void Ogre_glTF::narrowIndices(const Ogre::uint32* source, Ogre::uint16* destination, size_t count)
+{
+	size_t i { 0 };
+
+#if defined(OGRE_GLTF_INDICES_SSE2)
+	//SSE2 only packs with signed saturation : moving the values to the signed 16 bit range makes the packing exact
+	const auto offset32 = _mm_set1_epi32(0x8000);
+	const auto offset16 = _mm_set1_epi16(std::numeric_limits<short>::min());
+	for(; i + 8 <= count; i += 8)
+	{
+		const auto low	= _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)), offset32);
+		const auto high = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 4)), offset32);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_xor_si128(_mm_packs_epi32(low, high), offset16));
+	}
+#elif defined(OGRE_GLTF_INDICES_NEON)
+	for(; i + 8 <= count; i += 8) vst1q_u16(destination + i, vcombine_u16(vmovn_u32(vld1q_u32(source + i)), vmovn_u32(vld1q_u32(source + i + 4))));
+#endif
+
+	for(; i < count; ++i)
+	{
+		Ogre::uint32 index;
+		memcpy(&index, source + i, sizeof index);
+		destination[i] = Ogre::uint16(index);
+	}
+}
+
+void Ogre_glTF::widenIndices(const Ogre::uint8* source, Ogre::uint16* destination, size_t count)
+{
+	size_t i { 0 };
+
+#if defined(OGRE_GLTF_INDICES_SSE2)
+	const auto zero = _mm_setzero_si128();
+	for(; i + 16 <= count; i += 16)
+	{
+		const auto values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi8(values, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 8), _mm_unpackhi_epi8(values, zero));
+	}
+#elif defined(OGRE_GLTF_INDICES_NEON)
+	for(; i + 16 <= count; i += 16)
+	{
+		const auto values = vld1q_u8(source + i);
+		vst1q_u16(destination + i, vmovl_u8(vget_low_u8(values)));
+		vst1q_u16(destination + i + 8, vmovl_u8(vget_high_u8(values)));
+	}
+#endif
+
+	for(; i < count; ++i) destination[i] = source[i];
+}
+
+void Ogre_glTF::copyUsedVertices(const primitiveData& vertexSet, primitiveData& primitive)
+{
+	const auto indices = primitive.readIndices();
+	if(std::any_of(indices.begin(), indices.end(), [&](Ogre::uint32 index) { return index >= vertexSet.vertexCount; }))
+		throw LoadingError("Index out of the vertex buffer in primitive");
+
+	constexpr auto unused = std::numeric_limits<Ogre::uint32>::max();
+	std::vector<Ogre::uint32> remap(vertexSet.vertexCount, unused);
+	for(const auto index : indices) remap[index] = 0;
+
+	Ogre::uint32 used { 0 };
+	for(auto& newIndex : remap)
+		if(newIndex != unused) newIndex = used++;
+
+	const auto stride		 = vertexSet.vertexCount > 0 ? vertexSet.vertices->size() / vertexSet.vertexCount : 0;
+	primitive.vertexElements = vertexSet.vertexElements;
+	primitive.vertexCount	 = used;
+	primitive.vertices		 = std::make_unique<geometryBuffer<unsigned char>>(used * stride);
+	for(size_t vertex { 0 }; vertex < vertexSet.vertexCount; ++vertex)
+		if(remap[vertex] != unused) memcpy(primitive.vertices->data() + remap[vertex] * stride, vertexSet.vertices->data() + vertex * stride, stride);
+
+	primitive.boneAssignments.clear();
+	for(const auto& assignment : vertexSet.boneAssignments)
+		if(assignment.vertexIndex < vertexSet.vertexCount && remap[assignment.vertexIndex] != unused)
+			primitive.boneAssignments.emplace_back(remap[assignment.vertexIndex], assignment.boneIndex, assignment.weight);
+
+	//Each primitive often uses few enough of the shared vertices to go back to 16 bit indices
+	if(used <= largest16BitIndex + 1) primitive.indexType = Ogre::IndexBufferPacked::IT_16BIT;
+
+	std::vector<Ogre::uint32> renumbered(indices.size());
+	std::transform(indices.begin(), indices.end(), renumbered.begin(), [&](Ogre::uint32 index) { return remap[index]; });
+	primitive.indices = primitive.makeIndexBuffer(renumbered);
+}
+
+std::vector<primitiveData> Ogre_glTF::splitPrimitive(const primitiveData& primitive, size_t maxVertices)
+{
+	std::vector<primitiveData> pieces;
+	const auto elementSize = getElementSize(primitive.operationType);
+	if(elementSize == 0 || primitive.vertexCount == 0 || maxVertices < elementSize) return pieces;
+
+	const auto indices = primitive.readIndices();
+	const auto stride  = primitive.vertices->size() / primitive.vertexCount;
+
+	//Bone assignments of each vertex, as one sorted array. The ones of vertex v start at assignmentOffsets[v]
+	auto assignments = primitive.boneAssignments;
+	std::stable_sort(assignments.begin(), assignments.end(), [](const Ogre::VertexBoneAssignment& a, const Ogre::VertexBoneAssignment& b) {
+		return a.vertexIndex < b.vertexIndex;
+	});
+	std::vector<size_t> assignmentOffsets(primitive.vertexCount + 1, 0);
+	for(const auto& assignment : assignments) ++assignmentOffsets[assignment.vertexIndex + 1];
+	for(size_t vertex { 0 }; vertex < primitive.vertexCount; ++vertex) assignmentOffsets[vertex + 1] += assignmentOffsets[vertex];
+
+	//Index of each original vertex in the current piece, and the original index of each vertex of the current piece
+	constexpr auto notInPiece = std::numeric_limits<Ogre::uint32>::max();
+	std::vector<Ogre::uint32> remap(primitive.vertexCount, notInPiece);
+	std::vector<Ogre::uint32> pieceVertices;
+	std::vector<Ogre::uint16> pieceIndices;
+
+	const auto finishPiece = [&] {
+		primitiveData piece;
+		piece.vertexElements  = primitive.vertexElements;
+		piece.operationType	  = primitive.operationType;
+		piece.sourcePrimitive = primitive.sourcePrimitive;
+
+		piece.vertexCount = pieceVertices.size();
+		piece.vertices	  = std::make_unique<geometryBuffer<unsigned char>>(piece.vertexCount * stride);
+		for(size_t vertex { 0 }; vertex < piece.vertexCount; ++vertex)
+		{
+			const auto original = pieceVertices[vertex];
+			memcpy(piece.vertices->data() + vertex * stride, primitive.vertices->data() + original * stride, stride);
+
+			for(auto assignment = assignments.begin() + assignmentOffsets[original]; assignment != assignments.begin() + assignmentOffsets[original + 1]; ++assignment)
+				piece.boneAssignments.emplace_back(Ogre::uint32(vertex), assignment->boneIndex, assignment->weight);
+
+			remap[original] = notInPiece;
+		}
+
+		piece.indexType	 = Ogre::IndexBufferPacked::IT_16BIT;
+		piece.indexCount = pieceIndices.size();
+		auto buffer		 = std::make_unique<geometryBuffer<Ogre::uint16>>(piece.indexCount);
+		std::copy(pieceIndices.begin(), pieceIndices.end(), buffer->data());
+		piece.indices = std::move(buffer);
+
+		pieces.push_back(std::move(piece));
+		pieceVertices.clear();
+		pieceIndices.clear();
+	};
+
+	for(size_t element { 0 }; element + elementSize <= indices.size(); element += elementSize)
+	{
+		const auto first = indices.begin() + element;
+		const auto last	 = first + elementSize;
+		if(std::any_of(first, last, [&](Ogre::uint32 index) { return index >= primitive.vertexCount; }))
+			throw LoadingError("Index out of the vertex buffer in primitive");
+
+		//Count the vertices this element would add, once each
+		size_t added { 0 };
+		for(auto index = first; index != last; ++index)
+			if(remap[*index] == notInPiece && std::find(first, index, *index) == index) ++added;
+
+		if(pieceVertices.size() + added > maxVertices) finishPiece();
+
+		for(auto index = first; index != last; ++index)
+		{
+			if(remap[*index] == notInPiece)
+			{
+				remap[*index] = Ogre::uint32(pieceVertices.size());
+				pieceVertices.push_back(*index);
+			}
+			pieceIndices.push_back(Ogre::uint16(remap[*index]));
+		}
+	}
+
+	if(!pieceIndices.empty()) finishPiece();
+	return pieces;
+}
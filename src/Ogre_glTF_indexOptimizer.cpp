@@ -0,0 +1,301 @@
+#include "Ogre_glTF_indexOptimizer.hpp"
+#include "Ogre_glTF_common.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Size of the LRU cache the vertex scores are computed for
+	constexpr size_t forsythCacheSize = 32;
+
+	///Score of a vertex : higher when it has been used recently, and when few triangles still need it
+	/// \param cachePosition position of the vertex in the LRU cache, -1 if it's not in it
+	/// \param remainingTriangles number of triangles using this vertex that are not in the output yet
+	float vertexScore(int cachePosition, size_t remainingTriangles)
+	{
+		if(remainingTriangles == 0) return -1.0f;
+
+		float score { 0 };
+		if(cachePosition >= 0)
+		{
+			//The vertices of the last triangle are scored a bit lower, or the order would go back and forth on the same strip
+			if(cachePosition < 3)
+				score = 0.75f;
+			else
+				score = std::pow(1.0f - float(cachePosition - 3) / float(forsythCacheSize - 3), 1.5f);
+		}
+
+		//Finishing off vertices that have few triangles left removes them from the working set for good
+		return score + 2.0f / std::sqrt(float(remainingTriangles));
+	}
+}
+
+constexpr size_t indexOptimizer::simulatedCacheSize;
+
+vertexCacheStatistics vertexCacheStatistics::compute(const std::vector<Ogre::uint32>& indices, size_t vertexCount, size_t cacheSize)
+{
+	if(indices.size() < 3 || vertexCount == 0) return {};
+
+	//A vertex is in a FIFO cache if less than cacheSize vertices have been added since it was
+	std::vector<size_t> addedAt(vertexCount, 0);
+	size_t time { cacheSize + 1 }, misses { 0 };
+	for(const auto index : indices)
+	{
+		if(time - addedAt[index] > cacheSize)
+		{
+			addedAt[index] = time++;
+			++misses;
+		}
+	}
+
+	return { float(misses) / float(indices.size() / 3), float(misses) / float(vertexCount) };
+}
+
+void indexOptimizer::optimizeVertexCache()
+{
+	const auto triangleCount = indices.size() / 3;
+	if(triangleCount == 0) return;
+
+	//The triangles that use each vertex, as one array. The ones of vertex v start at triangleOffsets[v]
+	std::vector<Ogre::uint32> triangleOffsets(vertexCount + 1, 0);
+	for(const auto index : indices) ++triangleOffsets[index + 1];
+	std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+
+	std::vector<Ogre::uint32> vertexTriangles(indices.size());
+	std::vector<Ogre::uint32> remaining(vertexCount, 0);
+	for(size_t triangle { 0 }; triangle < triangleCount; ++triangle)
+	{
+		for(size_t corner { 0 }; corner < 3; ++corner)
+		{
+			const auto vertex										  = indices[3 * triangle + corner];
+			vertexTriangles[triangleOffsets[vertex] + remaining[vertex]++] = Ogre::uint32(triangle);
+		}
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for(size_t vertex { 0 }; vertex < vertexCount; ++vertex) vertexScores[vertex] = vertexScore(-1, remaining[vertex]);
+
+	const auto triangleScore = [&](size_t triangle) {
+		return vertexScores[indices[3 * triangle]] + vertexScores[indices[3 * triangle + 1]] + vertexScores[indices[3 * triangle + 2]];
+	};
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<Ogre::uint32> output;
+	output.reserve(indices.size());
+
+	std::vector<Ogre::uint32> cache, nextCache;
+	cache.reserve(forsythCacheSize + 3);
+	nextCache.reserve(forsythCacheSize + 3);
+
+	//Start with the best triangle of the whole primitive. After that, only triangles around the cache are looked at
+	size_t bestTriangle { 0 };
+	float bestScore { triangleScore(0) };
+	for(size_t triangle { 1 }; triangle < triangleCount; ++triangle)
+	{
+		const auto score = triangleScore(triangle);
+		if(score > bestScore)
+		{
+			bestScore	= score;
+			bestTriangle = triangle;
+		}
+	}
+
+	size_t firstLeft { 0 };
+	while(output.size() < triangleCount * 3)
+	{
+		//Nothing around the cache is left : continue from the first triangle that isn't in the output
+		if(bestTriangle == triangleCount)
+		{
+			while(emitted[firstLeft]) ++firstLeft;
+			bestTriangle = firstLeft;
+		}
+
+		const auto corners = &indices[3 * bestTriangle];
+		emitted[bestTriangle] = true;
+
+		nextCache.clear();
+		for(size_t corner { 0 }; corner < 3; ++corner)
+		{
+			const auto vertex = corners[corner];
+			output.push_back(vertex);
+
+			//Remove the triangle from the ones still needing this vertex
+			const auto first = vertexTriangles.begin() + triangleOffsets[vertex];
+			const auto last	 = first + remaining[vertex];
+			std::iter_swap(std::find(first, last, Ogre::uint32(bestTriangle)), last - 1);
+			--remaining[vertex];
+
+			if(std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end()) nextCache.push_back(vertex);
+		}
+
+		//The vertices of the triangle move to the front of the cache, pushing the others back
+		for(const auto vertex : cache)
+			if(std::find(corners, corners + 3, vertex) == corners + 3) nextCache.push_back(vertex);
+		std::swap(cache, nextCache);
+
+		for(size_t position { 0 }; position < cache.size(); ++position)
+		{
+			const auto vertex	 = cache[position];
+			const auto inCache	 = position < forsythCacheSize;
+			cachePosition[vertex] = inCache ? int(position) : -1;
+			vertexScores[vertex]  = vertexScore(cachePosition[vertex], remaining[vertex]);
+		}
+
+		//The next triangle is the best one among those that use a vertex whose score changed
+		bestTriangle = triangleCount;
+		bestScore	= -std::numeric_limits<float>::max();
+		for(const auto vertex : cache)
+		{
+			const auto first = vertexTriangles.begin() + triangleOffsets[vertex];
+			for(auto it = first; it != first + remaining[vertex]; ++it)
+			{
+				const auto score = triangleScore(*it);
+				if(score > bestScore)
+				{
+					bestScore	= score;
+					bestTriangle = *it;
+				}
+			}
+		}
+
+		if(cache.size() > forsythCacheSize) cache.resize(forsythCacheSize);
+	}
+
+	indices = std::move(output);
+}
+
+void indexOptimizer::optimizeOverdraw(const std::vector<Ogre::Vector3>& positions)
+{
+	const auto triangleCount = indices.size() / 3;
+	if(positions.size() != vertexCount || triangleCount == 0) return;
+
+	//Cut the triangles in clusters where the vertex cache starts over : a triangle with none of its vertices in the cache.
+	//Clusters can be drawn in any order without making the vertex cache less efficient
+	std::vector<size_t> clusterStarts;
+	std::vector<size_t> addedAt(vertexCount, 0);
+	size_t time { simulatedCacheSize + 1 };
+	for(size_t triangle { 0 }; triangle < triangleCount; ++triangle)
+	{
+		size_t misses { 0 };
+		for(size_t corner { 0 }; corner < 3; ++corner)
+		{
+			const auto vertex = indices[3 * triangle + corner];
+			if(time - addedAt[vertex] > simulatedCacheSize)
+			{
+				addedAt[vertex] = time++;
+				++misses;
+			}
+		}
+		if(triangle == 0 || misses == 3) clusterStarts.push_back(triangle);
+	}
+	clusterStarts.push_back(triangleCount);
+
+	const auto clusterCount = clusterStarts.size() - 1;
+	if(clusterCount < 2) return;
+
+	//Area weighted center and normal of each cluster, and center of the whole primitive
+	std::vector<Ogre::Vector3> clusterCenters(clusterCount, Ogre::Vector3::ZERO), clusterNormals(clusterCount, Ogre::Vector3::ZERO);
+	Ogre::Vector3 center { Ogre::Vector3::ZERO };
+	float totalArea { 0 };
+	for(size_t cluster { 0 }; cluster < clusterCount; ++cluster)
+	{
+		float clusterArea { 0 };
+		for(auto triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+		{
+			const auto& a	  = positions[indices[3 * triangle]];
+			const auto& b	  = positions[indices[3 * triangle + 1]];
+			const auto& c	  = positions[indices[3 * triangle + 2]];
+			const auto normal = (b - a).crossProduct(c - a);
+			const auto area	  = normal.length();
+
+			clusterCenters[cluster] += (a + b + c) * (area / 3.0f);
+			clusterNormals[cluster] += normal;
+			clusterArea += area;
+		}
+
+		center += clusterCenters[cluster];
+		totalArea += clusterArea;
+		if(clusterArea > 0) clusterCenters[cluster] /= clusterArea;
+	}
+	if(totalArea > 0) center /= totalArea;
+
+	//Clusters that face away from the center are in front of the others when seen from outside : drawing them first lets the depth
+	//test reject what's behind them
+	std::vector<float> keys(clusterCount);
+	for(size_t cluster { 0 }; cluster < clusterCount; ++cluster)
+	{
+		auto normal = clusterNormals[cluster];
+		normal.normalise();
+		keys[cluster] = (clusterCenters[cluster] - center).dotProduct(normal);
+	}
+
+	std::vector<size_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+	std::vector<Ogre::uint32> output;
+	output.reserve(indices.size());
+	for(const auto cluster : order)
+		output.insert(output.end(), indices.begin() + 3 * clusterStarts[cluster], indices.begin() + 3 * clusterStarts[cluster + 1]);
+
+	indices = std::move(output);
+}
+
+void indexOptimizer::optimizeVertexFetch(primitiveData& primitive) const
+{
+	constexpr auto unused = std::numeric_limits<Ogre::uint32>::max();
+	std::vector<Ogre::uint32> remap(vertexCount, unused);
+
+	Ogre::uint32 next { 0 };
+	for(const auto index : indices)
+		if(remap[index] == unused) remap[index] = next++;
+
+	//Vertices that no triangle use are kept, at the end
+	for(auto& newIndex : remap)
+		if(newIndex == unused) newIndex = next++;
+
+	const auto stride = primitive.vertices->size() / vertexCount;
+	auto vertices	  = std::make_unique<geometryBuffer<unsigned char>>(primitive.vertices->size());
+	for(size_t vertex { 0 }; vertex < vertexCount; ++vertex)
+		memcpy(vertices->data() + remap[vertex] * stride, primitive.vertices->data() + vertex * stride, stride);
+	primitive.vertices = std::move(vertices);
+
+	for(auto& assignment : primitive.boneAssignments) assignment.vertexIndex = remap[assignment.vertexIndex];
+
+	std::vector<Ogre::uint32> remapped(indices.size());
+	std::transform(indices.begin(), indices.end(), remapped.begin(), [&](Ogre::uint32 index) { return remap[index]; });
+	primitive.indices = primitive.makeIndexBuffer(remapped);
+}
+
+std::string indexOptimizer::optimize(primitiveData& primitive, const std::vector<Ogre::Vector3>& positions)
+{
+	if(primitive.operationType != Ogre::OT_TRIANGLE_LIST || primitive.indexCount < 3 || primitive.indexCount % 3 != 0 || primitive.vertexCount == 0)
+		return {};
+
+	vertexCount = primitive.vertexCount;
+	indices		= primitive.readIndices();
+	if(std::any_of(indices.begin(), indices.end(), [&](Ogre::uint32 index) { return index >= vertexCount; }))
+	{
+		OgreLog("Not optimizing a primitive that has indices out of its vertex buffer");
+		return {};
+	}
+
+	const auto before = vertexCacheStatistics::compute(indices, vertexCount, simulatedCacheSize);
+	optimizeVertexCache();
+	optimizeOverdraw(positions);
+	const auto after = vertexCacheStatistics::compute(indices, vertexCount, simulatedCacheSize);
+	optimizeVertexFetch(primitive);
+
+	std::stringstream report;
+	report << "ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr;
+	return report.str();
+}
@@ -0,0 +1,103 @@
+#include "Ogre_glTF_mappedFile.hpp"
+#include "Ogre_glTF_common.hpp"
+#include "Ogre_glTF.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Ogre_glTF;
+
+#ifdef _WIN32
+mappedFile::mappedFile(const std::string& path)
+{
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(fileHandle == INVALID_HANDLE_VALUE)
+	{
+		fileHandle = nullptr;
+		throw FileIOError("Could not open " + path);
+	}
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+	{
+		close();
+		throw FileIOError("Could not get the content of " + path);
+	}
+	length = size_t(fileSize.QuadPart);
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(!mappingHandle)
+	{
+		close();
+		throw FileIOError("Could not create a file mapping for " + path);
+	}
+
+	address = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if(!address)
+	{
+		close();
+		throw FileIOError("Could not map " + path + " in memory");
+	}
+}
+
+void mappedFile::close()
+{
+	if(address) UnmapViewOfFile(address);
+	if(mappingHandle) CloseHandle(mappingHandle);
+	if(fileHandle) CloseHandle(fileHandle);
+
+	address		  = nullptr;
+	mappingHandle = nullptr;
+	fileHandle	= nullptr;
+}
+#else
+mappedFile::mappedFile(const std::string& path)
+{
+	fileDescriptor = open(path.c_str(), O_RDONLY);
+	if(fileDescriptor < 0) throw FileIOError("Could not open " + path);
+
+	struct stat fileStatus {};
+	if(fstat(fileDescriptor, &fileStatus) != 0 || fileStatus.st_size == 0)
+	{
+		close();
+		throw FileIOError("Could not get the content of " + path);
+	}
+	length = size_t(fileStatus.st_size);
+
+	auto view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if(view == MAP_FAILED)
+	{
+		close();
+		throw FileIOError("Could not map " + path + " in memory");
+	}
+
+	address = static_cast<const unsigned char*>(view);
+
+	//We are going to go through the whole file once, mostly in order
+	madvise(view, length, MADV_SEQUENTIAL);
+}
+
+void mappedFile::close()
+{
+	if(address) munmap(const_cast<unsigned char*>(address), length);
+	if(fileDescriptor >= 0) ::close(fileDescriptor);
+
+	address		   = nullptr;
+	fileDescriptor = -1;
+}
+#endif
+
+mappedFile::~mappedFile() { close(); }
+
+const unsigned char* mappedFile::data() const { return address; }
+
+size_t mappedFile::size() const { return length; }
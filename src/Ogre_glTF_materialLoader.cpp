@@ -36,15 +36,21 @@ void materialLoader::setEmissiveColor(Ogre::HlmsPbsDatablock* block, Ogre::Vecto
 	block->setEmissive(color);
 }
 
-bool materialLoader::isTextureIndexValid(int value) const
+bool materialLoader::isImageIndexValid(int value) const
 {
 	return !(value < 0);
 }
 
+int materialLoader::getImageIndex(int textureIndex) const
+{
+	if(textureIndex < 0) return -1;
+	return model.textures[textureIndex].source;
+}
+
 void materialLoader::setBaseColorTexture(Ogre::HlmsPbsDatablock* block, int value) const
 {
-	if(!isTextureIndexValid(value)) return;
-	auto texture = textureImporterRef.getTexture(value);
+	if(!isImageIndexValid(value)) return;
+	auto texture = textureImporterRef.getVariantTexture(value, textureVariant::plain);
 	if(texture)
 	{
 		//OgreLog("diffuse texture from textureImporter : " + texture->getName());
@@ -52,14 +58,14 @@ void materialLoader::setBaseColorTexture(Ogre::HlmsPbsDatablock* block, int valu
 	}
 }
 
-void materialLoader::setMetalRoughTexture(Ogre::HlmsPbsDatablock* block, int gltfTextureID) const
+void materialLoader::setMetalRoughTexture(Ogre::HlmsPbsDatablock* block, int imageIndex) const
 {
-	if(!isTextureIndexValid(gltfTextureID)) return;
+	if(!isImageIndexValid(imageIndex)) return;
 	//Ogre cannot use combined metal rough textures. Metal is in the R channel, and rough in the G channel. It seems that the images are loaded as BGR by the libarry
 	//R channel is channle 2 (from 0), G channel is 1.
 
-	auto metalTexure = textureImporterRef.generateGreyScaleFromChannel(gltfTextureID, 2);
-	auto roughTexure = textureImporterRef.generateGreyScaleFromChannel(gltfTextureID, 1);
+	auto metalTexure = textureImporterRef.getVariantTexture(imageIndex, textureVariant::metalness);
+	auto roughTexure = textureImporterRef.getVariantTexture(imageIndex, textureVariant::roughness);
 
 	if(metalTexure)
 	{
@@ -76,8 +82,8 @@ void materialLoader::setMetalRoughTexture(Ogre::HlmsPbsDatablock* block, int glt
 
 void materialLoader::setNormalTexture(Ogre::HlmsPbsDatablock* block, int value) const
 {
-	if(!isTextureIndexValid(value)) return;
-	auto texture = textureImporterRef.getNormalSNORM(value);
+	if(!isImageIndexValid(value)) return;
+	auto texture = textureImporterRef.getVariantTexture(value, textureVariant::normalSNORM);
 	if(texture)
 	{
 		//OgreLog("normal texture from textureImporter : " + texture->getName());
@@ -85,22 +91,10 @@ void materialLoader::setNormalTexture(Ogre::HlmsPbsDatablock* block, int value)
 	}
 }
 
-void materialLoader::setOcclusionTexture(Ogre::HlmsPbsDatablock* block, int value) const
-{
-	if(!isTextureIndexValid(value)) return;
-	auto texture = textureImporterRef.getTexture(value);
-	if(texture)
-	{
-		//OgreLog("occlusion texture from textureImporter : " + texture->getName());
-		//OgreLog("Warning: Ogre doesn't supoort occlusion map in it's HLMS PBS implementation!");
-		//block->setTexture(Ogre::PbsTextureTypes::PBSM_, 0, texture);
-	}
-}
-
 void materialLoader::setEmissiveTexture(Ogre::HlmsPbsDatablock* block, int value) const
 {
-	if(!isTextureIndexValid(value)) return;
-	auto texture = textureImporterRef.getTexture(value);
+	if(!isImageIndexValid(value)) return;
+	auto texture = textureImporterRef.getVariantTexture(value, textureVariant::plain);
 	if(texture)
 	{
 		//OgreLog("emissive texture from textureImporter : " + texture->getName());
@@ -133,77 +127,68 @@ materialLoader::materialLoader(tinygltf::Model& input, textureImporter& textureI
 {
 }
 
-Ogre::HlmsDatablock* materialLoader::getDatablock(size_t index) const
+materialDescription materialLoader::describe(size_t index) const
 {
-	OgreLog("Loading material...");
 	//TODO this will need some modification if we support multiple meshes by glTF file
-	auto HlmsPbs			 = static_cast<Ogre::HlmsPbs*>(Ogre::Root::getSingleton().getHlmsManager()->getHlms(Ogre::HlmsTypes::HLMS_PBS));
 	const auto mainMeshIndex = (model.defaultScene != 0 ? model.nodes[model.scenes[model.defaultScene].nodes.front()].mesh : 0);
 	const auto& mesh		 = model.meshes[mainMeshIndex];
-	const auto material		 = model.materials[mesh.primitives.at(index).material];
+	const auto& material	 = model.materials[mesh.primitives.at(index).material];
 
-	auto datablock = static_cast<Ogre::HlmsPbsDatablock*>(HlmsPbs->getDatablock(Ogre::IdString(material.name)));
-	if(datablock)
-	{
-		//OgreLog("Found HlmsPbsDatablock " + material.name + " in Ogre::HlmsPbs");
-		return datablock;
-	}
-	datablock = static_cast<Ogre::HlmsPbsDatablock*>(HlmsPbs->createDatablock(Ogre::IdString(material.name),
-																			  material.name,
-																			  Ogre::HlmsMacroblock {},
-																			  Ogre::HlmsBlendblock {},
-																			  Ogre::HlmsParamVec {}));
-	datablock->setWorkflow(Ogre::HlmsPbsDatablock::Workflows::MetallicWorkflow);
+	materialDescription description;
+	description.name = material.name;
 
-	//TODO refactor these almost exact peices of code
 	//OgreLog("values");
 	for(const auto& content : material.values)
 	{
 		//OgreLog(content.first);
-		if(content.first == "baseColorTexture")
-			setBaseColorTexture(datablock, content.second.TextureIndex());
+		if(content.first == "baseColorTexture") description.baseColorImage = getImageIndex(content.second.TextureIndex());
 
-		if(content.first == "metallicRoughnessTexture")
-			setMetalRoughTexture(datablock, content.second.TextureIndex());
+		if(content.first == "metallicRoughnessTexture") description.metalRoughImage = getImageIndex(content.second.TextureIndex());
 
-		if (content.first == "baseColorFactor")
+		if(content.first == "baseColorFactor")
 		{
-			setBaseColor(datablock, convertColor(content.second.ColorFactor()));
-
-			// Need to set the alpha channel separately
-			float alpha = content.second.number_array[3];
-			auto transparentMode = (alpha == 1) ? Ogre::HlmsPbsDatablock::None : Ogre::HlmsPbsDatablock::Transparent;
-			datablock->setTransparency(alpha, transparentMode);
+			description.hasBaseColor = true;
+			description.baseColor	= convertColor(content.second.ColorFactor());
+			description.alpha		 = static_cast<float>(content.second.number_array[3]);
 		}
 
 		if(content.first == "metallicFactor")
-			setMetallicValue(datablock, static_cast<float>(content.second.Factor()));
+		{
+			description.hasMetallic = true;
+			description.metallic	= static_cast<float>(content.second.Factor());
+		}
 
 		if(content.first == "roughnessFactor")
-			setRoughnesValue(datablock, static_cast<float>(content.second.Factor()));
+		{
+			description.hasRoughness = true;
+			description.roughness	= static_cast<float>(content.second.Factor());
+		}
 	}
 
 	//OgreLog("additionalValues");
 	for(const auto& content : material.additionalValues)
 	{
 		//OgreLog(content.first);
-		if(content.first == "normalTexture")
-			setNormalTexture(datablock, content.second.TextureIndex());
+		if(content.first == "normalTexture") description.normalImage = getImageIndex(content.second.TextureIndex());
 
 		//if (content.first == "occlusionTexture")
-		//	setOcclusionTexture(datablock, getTextureIndex(content));
+		//Ogre doesn't support occlusion maps in it's HLMS PBS implementation
 
-		if(content.first == "emissiveTexture")
-			setEmissiveTexture(datablock, content.second.TextureIndex());
+		if(content.first == "emissiveTexture") description.emissiveImage = getImageIndex(content.second.TextureIndex());
 
 		if(content.first == "emissiveFactor")
-			setEmissiveColor(datablock, convertColor(content.second.ColorFactor()));
+		{
+			description.hasEmissive = true;
+			description.emissive	= convertColor(content.second.ColorFactor());
+		}
 
-		if(content.first == "alphaMode") 
-			setAlphaMode(datablock, content.second.string_value);
+		if(content.first == "alphaMode") description.alphaMode = content.second.string_value;
 
-		if(content.first == "alphaCutoff") 
-			setAlphaCutoff(datablock, static_cast<Ogre::Real>(content.second.number_value));
+		if(content.first == "alphaCutoff")
+		{
+			description.hasAlphaCutoff = true;
+			description.alphaCutoff	= static_cast<float>(content.second.number_value);
+		}
 	}
 
 	//	OgreLog("extCommonValues");
@@ -214,11 +199,69 @@ Ogre::HlmsDatablock* materialLoader::getDatablock(size_t index) const
 	//	for(const auto& content : material.extPBRValues)
 	//		OgreLog(content.first);
 
+	return description;
+}
+
+std::vector<materialDescription> materialLoader::describeAll() const
+{
+	std::vector<materialDescription> materials;
+	for(size_t i { 0 }; i < getDatablockCount(); ++i) materials.push_back(describe(i));
+	return materials;
+}
+
+void materialLoader::setDescriptions(std::vector<materialDescription> materials) { descriptions = std::move(materials); }
+
+Ogre::HlmsDatablock* materialLoader::createDatablock(const materialDescription& description) const
+{
+	auto HlmsPbs = static_cast<Ogre::HlmsPbs*>(Ogre::Root::getSingleton().getHlmsManager()->getHlms(Ogre::HlmsTypes::HLMS_PBS));
+
+	auto datablock = static_cast<Ogre::HlmsPbsDatablock*>(HlmsPbs->getDatablock(Ogre::IdString(description.name)));
+	if(datablock)
+	{
+		//OgreLog("Found HlmsPbsDatablock " + description.name + " in Ogre::HlmsPbs");
+		return datablock;
+	}
+	datablock = static_cast<Ogre::HlmsPbsDatablock*>(HlmsPbs->createDatablock(Ogre::IdString(description.name),
+																			  description.name,
+																			  Ogre::HlmsMacroblock {},
+																			  Ogre::HlmsBlendblock {},
+																			  Ogre::HlmsParamVec {}));
+	datablock->setWorkflow(Ogre::HlmsPbsDatablock::Workflows::MetallicWorkflow);
+
+	if(description.hasBaseColor)
+	{
+		setBaseColor(datablock, description.baseColor);
+
+		// Need to set the alpha channel separately
+		auto transparentMode = (description.alpha == 1) ? Ogre::HlmsPbsDatablock::None : Ogre::HlmsPbsDatablock::Transparent;
+		datablock->setTransparency(description.alpha, transparentMode);
+	}
+
+	setBaseColorTexture(datablock, description.baseColorImage);
+	if(description.hasMetallic) setMetallicValue(datablock, description.metallic);
+	setMetalRoughTexture(datablock, description.metalRoughImage);
+	if(description.hasRoughness) setRoughnesValue(datablock, description.roughness);
+
+	if(description.hasAlphaCutoff) setAlphaCutoff(datablock, description.alphaCutoff);
+	if(!description.alphaMode.empty()) setAlphaMode(datablock, description.alphaMode);
+	if(description.hasEmissive) setEmissiveColor(datablock, description.emissive);
+	setEmissiveTexture(datablock, description.emissiveImage);
+	setNormalTexture(datablock, description.normalImage);
+
 	return datablock;
 }
 
+Ogre::HlmsDatablock* materialLoader::getDatablock(size_t index) const
+{
+	OgreLog("Loading material...");
+	if(!descriptions.empty()) return createDatablock(descriptions.at(index));
+	return createDatablock(describe(index));
+}
+
 size_t materialLoader::getDatablockCount() const //todo this could use some refactoring. This information is actually fetched like, twice.
 {
+	if(!descriptions.empty()) return descriptions.size();
+
 	const auto mainMeshIndex = (model.defaultScene != 0 ? model.nodes[model.scenes[model.defaultScene].nodes.front()].mesh : 0);
 	const auto& mesh = model.meshes[mainMeshIndex];
 	return mesh.primitives.size();
@@ -0,0 +1,280 @@
+#include "Ogre_glTF_meshSimplifier.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Key of a position, to find vertices that are at exactly the same place
+	struct positionKey
+	{
+		std::array<Ogre::uint32, 3> bits;
+
+		positionKey(const Ogre::Vector3& position) { memcpy(bits.data(), position.ptr(), sizeof bits); }
+		bool operator==(const positionKey& other) const { return bits == other.bits; }
+	};
+
+	struct positionKeyHash
+	{
+		size_t operator()(const positionKey& key) const { return (size_t(key.bits[0]) * 73856093) ^ (size_t(key.bits[1]) * 19349663) ^ (size_t(key.bits[2]) * 83492791); }
+	};
+
+	///Get the index of a corner of a triangle in a triangle list
+	Ogre::uint32* triangleCorners(std::vector<Ogre::uint32>& indices, Ogre::uint32 triangle) { return indices.data() + 3 * size_t(triangle); }
+	const Ogre::uint32* triangleCorners(const std::vector<Ogre::uint32>& indices, Ogre::uint32 triangle) { return indices.data() + 3 * size_t(triangle); }
+}
+
+void meshSimplifier::quadric::addPlane(const Ogre::Vector3& normal, double distance, double weight)
+{
+	const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+	const double plane[10] { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d };
+	for(size_t i { 0 }; i < coefficients.size(); ++i) coefficients[i] += weight * plane[i];
+}
+
+meshSimplifier::quadric& meshSimplifier::quadric::operator+=(const quadric& other)
+{
+	for(size_t i { 0 }; i < coefficients.size(); ++i) coefficients[i] += other.coefficients[i];
+	return *this;
+}
+
+double meshSimplifier::quadric::evaluate(const Ogre::Vector3& point) const
+{
+	const double x = point.x, y = point.y, z = point.z;
+	const auto& q  = coefficients;
+	return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y + q[7] * z * z
+		+ 2 * q[8] * z + q[9];
+}
+
+meshSimplifier::meshSimplifier(const std::vector<Ogre::Vector3>& vertexPositions,
+							   std::vector<Ogre::uint32> triangles,
+							   const std::vector<Ogre::VertexBoneAssignment>& boneAssignments) :
+ positions { vertexPositions },
+ indices { std::move(triangles) },
+ aliveTriangles(indices.size() / 3, true),
+ vertexTriangles(positions.size()),
+ quadrics(positions.size()),
+ movable(positions.size(), true),
+ anchor(positions.size(), true),
+ versions(positions.size(), 0)
+{
+	const auto vertexCount = Ogre::uint32(positions.size());
+
+	//Vertices sharing a position with another one are on a seam : the attributes on each side of the seam differ
+	std::unordered_map<positionKey, Ogre::uint32, positionKeyHash> firstAtPosition;
+	std::vector<Ogre::uint32> welded(vertexCount);
+	for(Ogre::uint32 vertex { 0 }; vertex < vertexCount; ++vertex)
+	{
+		const auto inserted = firstAtPosition.emplace(positions[vertex], vertex);
+		welded[vertex]		= inserted.first->second;
+		if(!inserted.second) anchor[vertex] = anchor[welded[vertex]] = false;
+	}
+
+	//Edges used by a single triangle once the seams are welded are on the border of the surface
+	std::vector<std::pair<Ogre::uint32, Ogre::uint32>> edges;
+	edges.reserve(indices.size());
+	for(Ogre::uint32 triangle { 0 }; triangle < aliveTriangles.size(); ++triangle)
+	{
+		const auto corners = triangleCorners(indices, triangle);
+		if(corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2])
+		{
+			aliveTriangles[triangle] = false;
+			continue;
+		}
+
+		++triangleCount;
+		for(size_t corner { 0 }; corner < 3; ++corner)
+		{
+			vertexTriangles[corners[corner]].push_back(triangle);
+
+			const auto a = welded[corners[corner]], b = welded[corners[(corner + 1) % 3]];
+			edges.push_back(std::minmax(a, b));
+		}
+
+		const auto& p0	= positions[corners[0]];
+		auto normal		= (positions[corners[1]] - p0).crossProduct(positions[corners[2]] - p0);
+		const auto area = normal.normalise();
+
+		//Weighted by area, so large triangles weigh more than the tiny ones around them
+		for(size_t corner { 0 }; corner < 3; ++corner) quadrics[corners[corner]].addPlane(normal, -normal.dotProduct(p0), area);
+	}
+
+	std::sort(edges.begin(), edges.end());
+	std::vector<bool> onBorder(vertexCount, false);
+	for(auto edge = edges.begin(); edge != edges.end();)
+	{
+		const auto next = std::find_if(edge, edges.end(), [&](const std::pair<Ogre::uint32, Ogre::uint32>& other) { return other != *edge; });
+		if(next - edge != 2) onBorder[edge->first] = onBorder[edge->second] = true;
+		edge = next;
+	}
+
+	for(Ogre::uint32 vertex { 0 }; vertex < vertexCount; ++vertex) movable[vertex] = anchor[vertex] && !onBorder[welded[vertex]];
+
+	if(!boneAssignments.empty())
+	{
+		boneWeights.resize(vertexCount);
+		for(const auto& assignment : boneAssignments)
+			if(assignment.vertexIndex < vertexCount) boneWeights[assignment.vertexIndex].emplace_back(assignment.boneIndex, assignment.weight);
+		for(auto& weights : boneWeights) std::sort(weights.begin(), weights.end());
+	}
+
+	for(Ogre::uint32 vertex { 0 }; vertex < vertexCount; ++vertex)
+		if(movable[vertex]) pushCollapses(vertex, false);
+}
+
+float meshSimplifier::boneWeightDifference(Ogre::uint32 a, Ogre::uint32 b) const
+{
+	if(boneWeights.empty()) return 0;
+
+	//Both lists are sorted by bone index
+	const auto& first  = boneWeights[a];
+	const auto& second = boneWeights[b];
+	float difference { 0 };
+	size_t i { 0 }, j { 0 };
+	while(i < first.size() || j < second.size())
+	{
+		if(j == second.size() || (i < first.size() && first[i].first < second[j].first))
+			difference += std::abs(first[i++].second);
+		else if(i == first.size() || second[j].first < first[i].first)
+			difference += std::abs(second[j++].second);
+		else
+			difference += std::abs(first[i++].second - second[j++].second);
+	}
+	return difference;
+}
+
+void meshSimplifier::pushCollapse(Ogre::uint32 from, Ogre::uint32 to)
+{
+	if(!movable[from] || !anchor[to]) return;
+
+	const auto& destination = positions[to];
+	auto merged				= quadrics[from];
+	merged += quadrics[to];
+
+	//A vertex moved onto one with other bone weights gets deformed differently : that costs as much as moving it that far off the surface
+	const auto skinning = boneWeightDifference(from, to) * destination.squaredDistance(positions[from]);
+	queue.push({ merged.evaluate(destination) + skinning, from, to, versions[from], versions[to] });
+}
+
+void meshSimplifier::pushCollapses(Ogre::uint32 vertex, bool both)
+{
+	for(const auto neighbor : getNeighbors(vertex))
+	{
+		pushCollapse(vertex, neighbor);
+		if(both) pushCollapse(neighbor, vertex);
+	}
+}
+
+std::vector<Ogre::uint32> meshSimplifier::getNeighbors(Ogre::uint32 vertex) const
+{
+	std::vector<Ogre::uint32> neighbors;
+	for(const auto triangle : vertexTriangles[vertex])
+	{
+		if(!aliveTriangles[triangle]) continue;
+		const auto corners = triangleCorners(indices, triangle);
+		for(size_t corner { 0 }; corner < 3; ++corner)
+			if(corners[corner] != vertex) neighbors.push_back(corners[corner]);
+	}
+	std::sort(neighbors.begin(), neighbors.end());
+	neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+	return neighbors;
+}
+
+bool meshSimplifier::breaksManifold(Ogre::uint32 from, Ogre::uint32 to) const
+{
+	//Collapsing an edge of a manifold surface keeps it manifold if the two vertices only have the vertices of the two triangles of
+	//the edge in common. Otherwise the collapse pinches the surface
+	const auto fromNeighbors = getNeighbors(from);
+	const auto toNeighbors	 = getNeighbors(to);
+	std::vector<Ogre::uint32> common;
+	std::set_intersection(fromNeighbors.begin(), fromNeighbors.end(), toNeighbors.begin(), toNeighbors.end(), std::back_inserter(common));
+	return common.size() > 2;
+}
+
+bool meshSimplifier::flipsTriangles(Ogre::uint32 from, Ogre::uint32 to) const
+{
+	for(const auto triangle : vertexTriangles[from])
+	{
+		if(!aliveTriangles[triangle]) continue;
+		const auto corners = triangleCorners(indices, triangle);
+		if(std::find(corners, corners + 3, to) != corners + 3) continue;
+
+		std::array<Ogre::Vector3, 3> before, after;
+		for(size_t corner { 0 }; corner < 3; ++corner)
+		{
+			before[corner] = positions[corners[corner]];
+			after[corner]  = corners[corner] == from ? positions[to] : before[corner];
+		}
+
+		const auto normalBefore = (before[1] - before[0]).crossProduct(before[2] - before[0]);
+		const auto normalAfter	= (after[1] - after[0]).crossProduct(after[2] - after[0]);
+		if(normalBefore.dotProduct(normalAfter) <= 0) return true;
+	}
+	return false;
+}
+
+void meshSimplifier::applyCollapse(Ogre::uint32 from, Ogre::uint32 to)
+{
+	quadrics[to] += quadrics[from];
+
+	for(const auto triangle : vertexTriangles[from])
+	{
+		if(!aliveTriangles[triangle]) continue;
+		const auto corners = triangleCorners(indices, triangle);
+		if(std::find(corners, corners + 3, to) != corners + 3)
+		{
+			aliveTriangles[triangle] = false;
+			--triangleCount;
+			continue;
+		}
+
+		std::replace(corners, corners + 3, from, to);
+		vertexTriangles[to].push_back(triangle);
+	}
+
+	vertexTriangles[from].clear();
+	auto& remaining = vertexTriangles[to];
+	remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](Ogre::uint32 triangle) { return !aliveTriangles[triangle]; }), remaining.end());
+
+	//The removed vertex can't be the end of anything anymore
+	movable[from] = anchor[from] = false;
+	++versions[from];
+	++versions[to];
+}
+
+std::vector<Ogre::uint32> meshSimplifier::simplify(size_t targetTriangleCount)
+{
+	while(triangleCount > targetTriangleCount && !queue.empty())
+	{
+		const auto candidate = queue.top();
+		queue.pop();
+
+		if(candidate.fromVersion != versions[candidate.from] || candidate.toVersion != versions[candidate.to]) continue;
+		if(!movable[candidate.from] || !anchor[candidate.to]) continue;
+
+		//The edge may have disappeared when a neighbor collapsed
+		const auto& around = vertexTriangles[candidate.from];
+		const auto stillAnEdge = std::any_of(around.begin(), around.end(), [&](Ogre::uint32 triangle) {
+			const auto corners = triangleCorners(indices, triangle);
+			return aliveTriangles[triangle] && std::find(corners, corners + 3, candidate.to) != corners + 3;
+		});
+		if(!stillAnEdge || breaksManifold(candidate.from, candidate.to) || flipsTriangles(candidate.from, candidate.to)) continue;
+
+		applyCollapse(candidate.from, candidate.to);
+		pushCollapses(candidate.to, true);
+	}
+
+	std::vector<Ogre::uint32> output;
+	output.reserve(triangleCount * 3);
+	for(Ogre::uint32 triangle { 0 }; triangle < aliveTriangles.size(); ++triangle)
+	{
+		if(!aliveTriangles[triangle]) continue;
+		const auto corners = triangleCorners(indices, triangle);
+		output.insert(output.end(), corners, corners + 3);
+	}
+	return output;
+}
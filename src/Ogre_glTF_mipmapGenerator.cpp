@@ -0,0 +1,213 @@
+#include "Ogre_glTF_mipmapGenerator.hpp"
+
+#include <OgrePixelFormat.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Largest number of pixels a reduced pixel covers : 3x3, when both sizes are odd
+	constexpr size_t maxFootprint { 9 };
+
+	///Pixels of the previous level a reduced pixel is the average of
+	struct footprint
+	{
+		///Start of each pixel
+		std::array<const Ogre::uint8*, maxFootprint> pixels;
+
+		///Number of pixels
+		size_t count;
+
+		///1 / count
+		float weight;
+
+		///Average of integer values, rounded to the nearest, without a division for every channel. The sums are small enough for a
+		///float to be exact, and a quotient that isn't whole is at least 1/9 away from the next integer : the margin never changes the result
+		/// \param sum sum of the values of every pixel
+		Ogre::uint8 average(size_t sum) const { return Ogre::uint8((float(sum) + float(count / 2)) * weight + 0.05f); }
+	};
+
+	///Get the range of pixels of a row or column that a reduced pixel covers. With an odd size, neighbours share the middle pixel
+	/// \param index index of the reduced pixel
+	/// \param size size of the previous level
+	/// \param reducedSize size of the level being made
+	/// \return first pixel, and one past the last
+	std::pair<size_t, size_t> coveredRange(size_t index, size_t size, size_t reducedSize)
+	{
+		return { index * size / reducedSize, std::min(size, ((index + 1) * size + reducedSize - 1) / reducedSize) };
+	}
+
+	///Decode an sRGB value
+	/// \param encoded sRGB value between 0 and 1
+	float decodeSRGB(float encoded) { return encoded <= 0.04045f ? encoded / 12.92f : std::pow((encoded + 0.055f) / 1.055f, 2.4f); }
+
+	///Number of buckets linear values are sorted in before encoding them to sRGB
+	constexpr size_t sRGBBuckets { 4096 };
+
+	///Conversions between sRGB encoded bytes and linear values, without calling pow() for every pixel
+	class sRGBTables
+	{
+		///Linear value of each byte
+		std::array<float, 256> linear;
+
+		///Linear values halfway between the ones of two consecutive bytes, so encoding rounds in sRGB space
+		std::array<float, 255> thresholds;
+
+		///Smallest byte of the values of each bucket
+		std::array<Ogre::uint8, sRGBBuckets + 1> smallestByte;
+
+	public:
+		sRGBTables()
+		{
+			for(size_t i { 0 }; i < linear.size(); ++i) linear[i] = decodeSRGB(float(i) / 255.0f);
+			for(size_t i { 0 }; i < thresholds.size(); ++i) thresholds[i] = decodeSRGB((float(i) + 0.5f) / 255.0f);
+			for(size_t i { 0 }; i < smallestByte.size(); ++i)
+				smallestByte[i] = Ogre::uint8(std::upper_bound(thresholds.begin(), thresholds.end(), float(i) / sRGBBuckets) - thresholds.begin());
+		}
+
+		///Get the linear value of an sRGB encoded byte
+		float toLinear(Ogre::uint8 value) const { return linear[value]; }
+
+		///Encode a linear value to the nearest sRGB byte. Buckets are narrower than the gap between two bytes : it takes a step or two
+		/// \param value linear value between 0 and 1
+		Ogre::uint8 toSRGB(float value) const
+		{
+			auto encoded = smallestByte[std::min(sRGBBuckets, size_t(value * sRGBBuckets))];
+			while(encoded < thresholds.size() && value >= thresholds[encoded]) ++encoded;
+			return encoded;
+		}
+	};
+
+	///Average every channel as it is, rounding to the nearest
+	void averageLinear(const footprint& source, size_t channels, Ogre::uint8* destination)
+	{
+		for(size_t c { 0 }; c < channels; ++c)
+		{
+			size_t sum { 0 };
+			for(size_t i { 0 }; i < source.count; ++i) sum += source.pixels[i][c];
+			destination[c] = source.average(sum);
+		}
+	}
+
+	///Average the colour channels in linear space, and the alpha channel, if any, as it is
+	void averageSRGB(const footprint& source, size_t channels, bool alpha, const sRGBTables& tables, Ogre::uint8* destination)
+	{
+		const auto colourChannels = alpha ? channels - 1 : channels;
+		for(size_t c { 0 }; c < colourChannels; ++c)
+		{
+			float sum { 0 };
+			for(size_t i { 0 }; i < source.count; ++i) sum += tables.toLinear(source.pixels[i][c]);
+			destination[c] = tables.toSRGB(sum * source.weight);
+		}
+
+		if(!alpha) return;
+		size_t sum { 0 };
+		for(size_t i { 0 }; i < source.count; ++i) sum += source.pixels[i][colourChannels];
+		destination[colourChannels] = source.average(sum);
+	}
+
+	///Average the normals and normalize the result. The fourth channel is set to 1, like stageNormalSNORM does
+	void averageNormals(const footprint& source, size_t channels, Ogre::uint8* destination)
+	{
+		const auto decode = [](Ogre::uint8 value) { return std::max(-1.0f, float(Ogre::int8(value)) / 127.0f); };
+
+		std::array<float, 3> sum { { 0, 0, 0 } };
+		for(size_t i { 0 }; i < source.count; ++i)
+		{
+			const auto pixel = source.pixels[i];
+			const auto x = decode(pixel[0]), y = decode(pixel[1]);
+			sum[0] += x;
+			sum[1] += y;
+			sum[2] += channels > 2 ? decode(pixel[2]) : std::sqrt(std::max(0.0f, 1 - x * x - y * y));
+		}
+
+		const auto length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+		if(length > 0)
+			for(auto& component : sum) component *= 127.0f / length;
+		else
+			sum = { { 0, 0, 127.0f } };
+
+		for(size_t c { 0 }; c < std::min<size_t>(channels, 3); ++c) destination[c] = Ogre::uint8(Ogre::int8(std::lround(sum[c])));
+		if(channels > 3) destination[3] = 127;
+	}
+}
+
+Ogre::uint8 Ogre_glTF::getMipmapCount(Ogre::uint32 width, Ogre::uint32 height)
+{
+	Ogre::uint8 count { 0 };
+	for(; width > 1 || height > 1; ++count)
+	{
+		width  = std::max<Ogre::uint32>(1, width / 2);
+		height = std::max<Ogre::uint32>(1, height / 2);
+	}
+	return count;
+}
+
+void Ogre_glTF::generateMipmaps(stagedImage& image, mipmapFilter filter)
+{
+	if(image.mipmaps != 0 || image.pixels.empty()) return;
+
+	const auto pixelSize = Ogre::PixelUtil::getNumElemBytes(image.format);
+	const auto channels	 = Ogre::PixelUtil::getComponentCount(image.format);
+	const auto alpha	 = Ogre::PixelUtil::hasAlpha(image.format);
+	const auto mipmaps	 = getMipmapCount(image.width, image.height);
+	static const sRGBTables tables;
+
+	//Make room for the whole chain at once, every level is then read from the one before it
+	size_t width { image.width }, height { image.height }, totalSize { 0 };
+	for(size_t level { 0 }; level <= mipmaps; ++level)
+	{
+		totalSize += width * height * pixelSize;
+		width  = std::max<size_t>(1, width / 2);
+		height = std::max<size_t>(1, height / 2);
+	}
+	image.pixels.resize(totalSize);
+
+	width  = image.width;
+	height = image.height;
+	size_t sourceOffset { 0 };
+	for(size_t level { 1 }; level <= mipmaps; ++level)
+	{
+		const auto reducedWidth		 = std::max<size_t>(1, width / 2);
+		const auto reducedHeight	 = std::max<size_t>(1, height / 2);
+		const auto destinationOffset = sourceOffset + width * height * pixelSize;
+		const auto source			 = image.pixels.data() + sourceOffset;
+		auto destination			 = image.pixels.data() + destinationOffset;
+
+		std::vector<std::pair<size_t, size_t>> columnRanges(reducedWidth);
+		for(size_t x { 0 }; x < reducedWidth; ++x) columnRanges[x] = coveredRange(x, width, reducedWidth);
+
+		footprint covered;
+		for(size_t y { 0 }; y < reducedHeight; ++y)
+		{
+			const auto rows = coveredRange(y, height, reducedHeight);
+			for(size_t x { 0 }; x < reducedWidth; ++x, destination += pixelSize)
+			{
+				const auto& columns = columnRanges[x];
+				covered.count		= 0;
+				for(auto row = rows.first; row < rows.second; ++row)
+					for(auto column = columns.first; column < columns.second; ++column)
+						covered.pixels[covered.count++] = source + (row * width + column) * pixelSize;
+				covered.weight = 1.0f / float(covered.count);
+
+				switch(filter)
+				{
+					case mipmapFilter::linear: averageLinear(covered, pixelSize, destination); break;
+					case mipmapFilter::sRGB: averageSRGB(covered, channels, alpha, tables, destination); break;
+					case mipmapFilter::normal: averageNormals(covered, channels, destination); break;
+				}
+			}
+		}
+
+		sourceOffset = destinationOffset;
+		width		 = reducedWidth;
+		height		 = reducedHeight;
+	}
+
+	image.mipmaps = mipmaps;
+}
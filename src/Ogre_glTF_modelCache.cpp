@@ -0,0 +1,506 @@
+#include "Ogre_glTF_modelCache.hpp"
+#include "Ogre_glTF_mappedFile.hpp"
+#include "Ogre_glTF_common.hpp"
+
+#include <OgreFileSystemLayer.h>
+#include <OgreOldSkeletonManager.h>
+#include <OgreSkeletonSerializer.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	constexpr char magicNumber[4] { 'O', 'G', 'L', 'C' };
+
+	///Version of the content of the entries. Part of the key, so changing it makes all the existing entries unused
+	constexpr uint32_t formatVersion { 9 };
+
+	///Extension of the main file of an entry
+	const char entryExtension[] = ".oglcache";
+
+	///Extension of the skeleton file of an entry
+	const char skeletonExtension[] = ".skeleton";
+
+	///Write plain values and blocks of bytes into a file
+	class entryWriter
+	{
+		std::ofstream& file;
+
+	public:
+		entryWriter(std::ofstream& output) : file { output } {}
+
+		template <typename T>
+		void value(const T& data)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written as they are");
+			file.write(reinterpret_cast<const char*>(&data), sizeof data);
+		}
+
+		void bytes(const void* data, size_t size)
+		{
+			value(uint64_t(size));
+			file.write(static_cast<const char*>(data), std::streamsize(size));
+		}
+
+		void string(const std::string& text) { bytes(text.data(), text.size()); }
+
+		void vector3(const Ogre::Vector3& vector)
+		{
+			value(float(vector.x));
+			value(float(vector.y));
+			value(float(vector.z));
+		}
+	};
+
+	///Read back what entryWriter wrote. Throws FileIOError if the file is shorter than expected
+	class entryReader
+	{
+		const unsigned char* cursor;
+		const unsigned char* const end;
+
+		const unsigned char* take(size_t size)
+		{
+			if(size > size_t(end - cursor)) throw FileIOError("Truncated cache entry");
+			const auto data = cursor;
+			cursor += size;
+			return data;
+		}
+
+	public:
+		entryReader(const mappedFile& file) : cursor { file.data() }, end { file.data() + file.size() } {}
+
+		template <typename T>
+		T value()
+		{
+			T data;
+			memcpy(&data, take(sizeof data), sizeof data);
+			return data;
+		}
+
+		///Get the size of the next block, and the address of its content
+		const unsigned char* bytes(size_t& size)
+		{
+			size = size_t(value<uint64_t>());
+			return take(size);
+		}
+
+		std::string string()
+		{
+			size_t size;
+			const auto data = bytes(size);
+			return { reinterpret_cast<const char*>(data), size };
+		}
+
+		Ogre::Vector3 vector3()
+		{
+			const auto x = value<float>();
+			const auto y = value<float>();
+			const auto z = value<float>();
+			return { x, y, z };
+		}
+	};
+
+	///Written instead of the index of a previous primitive, when the vertices of a primitive are not shared with one
+	constexpr uint32_t ownVertices { ~uint32_t(0) };
+
+	///Write a primitive
+	/// \param output where to write to
+	/// \param primitive the primitive
+	/// \param verticesFrom index of a previous primitive that has the same vertices, that are then not written again, or ownVertices
+	void writePrimitive(entryWriter& output, const primitiveData& primitive, uint32_t verticesFrom = ownVertices)
+	{
+		output.value(uint32_t(primitive.vertexElements.size()));
+		for(const auto& element : primitive.vertexElements)
+		{
+			output.value(uint32_t(element.mType));
+			output.value(uint32_t(element.mSemantic));
+		}
+
+		output.value(uint64_t(primitive.vertexCount));
+		output.value(verticesFrom);
+		if(verticesFrom == ownVertices) output.bytes(primitive.vertices->dataAddress(), primitive.vertices->dataSize());
+
+		output.value(uint32_t(primitive.indexType));
+		output.value(uint64_t(primitive.indexCount));
+		output.bytes(primitive.indices->dataAddress(), primitive.indices->dataSize() * primitive.indices->elementSize());
+
+		output.value(uint32_t(primitive.operationType));
+		output.value(uint32_t(primitive.sourcePrimitive));
+
+		output.value(uint32_t(primitive.lodIndices.size()));
+		for(const auto& lod : primitive.lodIndices) output.bytes(lod->dataAddress(), lod->dataSize() * lod->elementSize());
+
+		output.value(bool(primitive.shadowCaster));
+		if(primitive.shadowCaster) writePrimitive(output, *primitive.shadowCaster);
+
+		output.value(uint64_t(primitive.boneAssignments.size()));
+		for(const auto& assignment : primitive.boneAssignments)
+		{
+			output.value(uint32_t(assignment.vertexIndex));
+			output.value(uint16_t(assignment.boneIndex));
+			output.value(float(assignment.weight));
+		}
+	}
+
+	///Read a block of indices
+	/// \param input where to read from
+	/// \param indexType type of the indices
+	std::unique_ptr<geometryBuffer_base> readIndexBuffer(entryReader& input, Ogre::IndexBufferPacked::IndexType indexType)
+	{
+		size_t size;
+		const auto data			  = input.bytes(size);
+		const size_t elementSize = indexType == Ogre::IndexBufferPacked::IT_16BIT ? sizeof(Ogre::uint16) : sizeof(Ogre::uint32);
+		if(size % elementSize != 0) throw FileIOError("Inconsistent index data in cache entry");
+
+		std::unique_ptr<geometryBuffer_base> indices;
+		if(indexType == Ogre::IndexBufferPacked::IT_16BIT)
+			indices = std::make_unique<geometryBuffer<Ogre::uint16>>(size / elementSize);
+		else
+			indices = std::make_unique<geometryBuffer<Ogre::uint32>>(size / elementSize);
+		memcpy(indices->dataAddress(), data, size);
+		return indices;
+	}
+
+	///Read a primitive
+	/// \param input where to read from
+	/// \param previous the primitives already read, whose vertices it can share
+	primitiveData readPrimitive(entryReader& input, const std::vector<primitiveData>& previous)
+	{
+		primitiveData primitive;
+
+		const auto elementCount = input.value<uint32_t>();
+		for(uint32_t i { 0 }; i < elementCount; ++i)
+		{
+			const auto type		= Ogre::VertexElementType(input.value<uint32_t>());
+			const auto semantic = Ogre::VertexElementSemantic(input.value<uint32_t>());
+			primitive.vertexElements.push_back(Ogre::VertexElement2(type, semantic));
+		}
+
+		primitive.vertexCount	= size_t(input.value<uint64_t>());
+		const auto verticesFrom = input.value<uint32_t>();
+		if(verticesFrom != ownVertices)
+		{
+			if(verticesFrom >= previous.size()) throw FileIOError("Inconsistent vertex data in cache entry");
+			primitive.vertices = previous[verticesFrom].vertices;
+		}
+		else
+		{
+			size_t size;
+			auto data		   = input.bytes(size);
+			primitive.vertices = std::make_unique<geometryBuffer<unsigned char>>(size);
+			memcpy(primitive.vertices->data(), data, size);
+		}
+
+		primitive.indexType  = Ogre::IndexBufferPacked::IndexType(input.value<uint32_t>());
+		primitive.indexCount = size_t(input.value<uint64_t>());
+		primitive.indices	 = readIndexBuffer(input, primitive.indexType);
+		if(primitive.indices->dataSize() != primitive.indexCount) throw FileIOError("Inconsistent index data in cache entry");
+
+		primitive.operationType	  = Ogre::OperationType(input.value<uint32_t>());
+		primitive.sourcePrimitive = input.value<uint32_t>();
+
+		const auto lodCount = input.value<uint32_t>();
+		for(uint32_t i { 0 }; i < lodCount; ++i) primitive.lodIndices.push_back(readIndexBuffer(input, primitive.indexType));
+
+		if(input.value<bool>()) primitive.shadowCaster = std::make_unique<primitiveData>(readPrimitive(input, {}));
+
+		const auto assignmentCount = size_t(input.value<uint64_t>());
+		primitive.boneAssignments.reserve(assignmentCount);
+		for(size_t i { 0 }; i < assignmentCount; ++i)
+		{
+			const auto vertexIndex = input.value<uint32_t>();
+			const auto boneIndex   = input.value<uint16_t>();
+			const auto weight	  = input.value<float>();
+			primitive.boneAssignments.emplace_back(vertexIndex, boneIndex, weight);
+		}
+
+		return primitive;
+	}
+
+	///Image loader that only hashes the encoded bytes of the images it's given, in the order of the images
+	bool hashImage(tinygltf::Image*, const int imageIndex, std::string*, std::string*, int, int, const unsigned char* bytes, int size, void* userData)
+	{
+		auto& hashes = *static_cast<std::vector<uint64_t>*>(userData);
+		hashes.resize(std::max(hashes.size(), size_t(imageIndex) + 1));
+		hashes[size_t(imageIndex)] = contentHash(bytes, size_t(size));
+		return true;
+	}
+
+	///Check if a glTF uri points to another file, instead of embedding its content
+	/// \param uri uri of a buffer or an image, empty when it's in a buffer view or the GLB binary chunk
+	bool isExternal(const std::string& uri) { return !uri.empty() && uri.compare(0, 5, "data:") != 0; }
+
+	///Add the content of every file a glTF file references (external buffers and images) to a hash. They are loaded by tinygltf, the
+	///way the loader reads them. If the file can't be parsed, nothing is added : it doesn't load either, and no entry is written for it
+	/// \param file content of the glTF or GLB file
+	/// \param path path to the file, its references are relative to it
+	/// \param hash the hash to extend
+	uint64_t hashReferencedFiles(const mappedFile& file, const std::string& path, uint64_t hash)
+	{
+		const auto lastSeparator = path.find_last_of("/\\");
+		const auto baseDir		 = lastSeparator == std::string::npos ? std::string { "./" } : path.substr(0, lastSeparator + 1);
+
+		tinygltf::TinyGLTF loader;
+		std::vector<uint64_t> imageHashes;
+		loader.SetImageLoader(hashImage, &imageHashes);
+
+		//tinygltf takes the size as an unsigned int : larger files don't load either
+		if(file.size() > std::numeric_limits<unsigned int>::max()) return hash;
+		const auto size = static_cast<unsigned int>(file.size());
+
+		tinygltf::Model model;
+		std::string error, warnings;
+		const auto parsed = file.size() >= 4 && memcmp(file.data(), "glTF", 4) == 0
+			? loader.LoadBinaryFromMemory(&model, &error, &warnings, file.data(), size, baseDir)
+			: loader.LoadASCIIFromString(&model, &error, &warnings, reinterpret_cast<const char*>(file.data()), size, baseDir);
+		if(!parsed) return hash;
+
+		for(const auto& buffer : model.buffers)
+			if(isExternal(buffer.uri)) hash = contentHash(buffer.data.data(), buffer.data.size(), hash);
+		for(size_t i { 0 }; i < model.images.size() && i < imageHashes.size(); ++i)
+			if(isExternal(model.images[i].uri)) hash = contentHash(&imageHashes[i], sizeof imageHashes[i], hash);
+		return hash;
+	}
+
+	void writeMaterial(entryWriter& output, const materialDescription& material)
+	{
+		output.string(material.name);
+		output.value(int32_t(material.baseColorImage));
+		output.value(int32_t(material.metalRoughImage));
+		output.value(int32_t(material.normalImage));
+		output.value(int32_t(material.emissiveImage));
+		output.value(material.hasBaseColor);
+		output.vector3(material.baseColor);
+		output.value(float(material.alpha));
+		output.value(material.hasMetallic);
+		output.value(float(material.metallic));
+		output.value(material.hasRoughness);
+		output.value(float(material.roughness));
+		output.value(material.hasEmissive);
+		output.vector3(material.emissive);
+		output.string(material.alphaMode);
+		output.value(material.hasAlphaCutoff);
+		output.value(float(material.alphaCutoff));
+	}
+
+	materialDescription readMaterial(entryReader& input)
+	{
+		materialDescription material;
+		material.name			 = input.string();
+		material.baseColorImage  = input.value<int32_t>();
+		material.metalRoughImage = input.value<int32_t>();
+		material.normalImage	 = input.value<int32_t>();
+		material.emissiveImage   = input.value<int32_t>();
+		material.hasBaseColor	= input.value<bool>();
+		material.baseColor		 = input.vector3();
+		material.alpha			 = input.value<float>();
+		material.hasMetallic	 = input.value<bool>();
+		material.metallic		 = input.value<float>();
+		material.hasRoughness	= input.value<bool>();
+		material.roughness		 = input.value<float>();
+		material.hasEmissive	 = input.value<bool>();
+		material.emissive		 = input.vector3();
+		material.alphaMode		 = input.string();
+		material.hasAlphaCutoff  = input.value<bool>();
+		material.alphaCutoff	 = input.value<float>();
+		return material;
+	}
+}
+
+modelCache::modelCache(const std::string& cacheDirectory) : directory { cacheDirectory }
+{
+	if(!directory.empty() && directory.back() != '/' && directory.back() != '\\') directory += '/';
+	Ogre::FileSystemLayer::createDirectory(directory);
+}
+
+std::string modelCache::getPath(const std::string& key, const std::string& extension) const { return directory + key + extension; }
+
+std::string modelCache::getKey(const std::string& path, const LoaderOptions& options)
+{
+	//Only the options that change what is converted are part of the key. How the file is read doesn't matter
+	std::vector<uint32_t> optionsKey { formatVersion, uint32_t(options.quantizeVertices), uint32_t(options.optimizeIndices), uint32_t(options.splitLargeMeshes) };
+
+	//The level of detail settings are floats : their bits are the key
+	const auto addFloat = [&](float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof bits);
+		optionsKey.push_back(bits);
+	};
+	optionsKey.push_back(uint32_t(options.poolVertexBuffers));
+	optionsKey.push_back(uint32_t(options.shareVertexBuffers));
+	optionsKey.push_back(uint32_t(options.legacyMetalRoughTextures));
+	optionsKey.push_back(uint32_t(options.twoChannelNormalMaps));
+	optionsKey.push_back(uint32_t(options.generateMipmaps));
+	addFloat(options.lodReduction);
+	optionsKey.push_back(uint32_t(options.lodDistances.size()));
+	for(const auto distance : options.lodDistances) addFloat(distance);
+	optionsKey.push_back(uint32_t(options.maxBoneInfluences));
+	optionsKey.push_back(uint32_t(options.shadowCasterVertices));
+	addFloat(options.shadowCasterReduction);
+
+	//A .gltf file is only the JSON text : the buffers and images next to it are part of the content too
+	mappedFile file(path);
+	auto hash = contentHash(optionsKey.data(), optionsKey.size() * sizeof(uint32_t));
+	hash	  = contentHash(file.data(), file.size(), hash);
+	hash	  = hashReferencedFiles(file, path, hash);
+
+	std::stringstream key;
+	key << std::hex << std::setw(16) << std::setfill('0') << hash;
+	return key.str();
+}
+
+std::unique_ptr<cachedModel> modelCache::read(const std::string& key) const
+{
+	const auto path = getPath(key, entryExtension);
+	if(!std::ifstream(path)) return nullptr;
+
+	try
+	{
+		mappedFile file(path);
+		entryReader input(file);
+
+		char magic[4];
+		for(auto& c : magic) c = input.value<char>();
+		if(memcmp(magic, magicNumber, sizeof magic) != 0 || input.value<uint32_t>() != formatVersion) return nullptr;
+
+		auto content = std::make_unique<cachedModel>();
+
+		content->transform.position = input.vector3();
+		content->transform.scale	= input.vector3();
+		const auto w				= input.value<float>();
+		const auto x				= input.value<float>();
+		const auto y				= input.value<float>();
+		const auto z				= input.value<float>();
+		content->transform.orientation = Ogre::Quaternion { w, x, y, z };
+
+		content->mesh		= std::make_unique<meshData>();
+		content->mesh->name = input.string();
+		const auto center   = input.vector3();
+		const auto halfSize = input.vector3();
+		content->mesh->boundingBox = Ogre::Aabb { center, halfSize };
+
+		const auto primitiveCount = input.value<uint32_t>();
+		auto& primitives		  = content->mesh->primitives;
+		for(uint32_t i { 0 }; i < primitiveCount; ++i) primitives.push_back(readPrimitive(input, primitives));
+
+		const auto materialCount = input.value<uint32_t>();
+		for(uint32_t i { 0 }; i < materialCount; ++i) content->materials.push_back(readMaterial(input));
+
+		const auto textureCount = input.value<uint32_t>();
+		for(uint32_t i { 0 }; i < textureCount; ++i)
+		{
+			stagedTexture texture;
+			texture.imageIndex	  = input.value<int32_t>();
+			texture.variant		  = textureVariant(input.value<uint32_t>());
+			texture.image.width	  = input.value<uint32_t>();
+			texture.image.height  = input.value<uint32_t>();
+			texture.image.format  = Ogre::PixelFormat(input.value<uint32_t>());
+			texture.image.mipmaps = Ogre::uint8(input.value<uint32_t>());
+			size_t size;
+			const auto pixels = input.bytes(size);
+			texture.image.pixels.assign(pixels, pixels + size);
+			texture.imageHash = input.value<uint64_t>();
+			content->textures.push_back(std::move(texture));
+		}
+
+		content->skinned = input.value<bool>();
+		if(content->skinned && !std::ifstream(getPath(key, skeletonExtension))) return nullptr;
+
+		return content;
+	}
+	catch(const std::exception& e)
+	{
+		OgreLog("Ignoring cache entry " + path + " : " + e.what());
+		return nullptr;
+	}
+}
+
+void modelCache::write(const std::string& key,
+					   const ModelInformation::ModelTransform& transform,
+					   const meshData& mesh,
+					   const std::vector<materialDescription>& materials,
+					   const std::vector<stagedTexture>& textures,
+					   Ogre::v1::Skeleton* skeleton) const
+{
+	//The skeleton goes first : the entry is only considered present once its main file exists
+	if(skeleton) Ogre::v1::SkeletonSerializer().exportSkeleton(skeleton, getPath(key, skeletonExtension));
+
+	//Written under a temporary name, so another process can't read a partial entry
+	const auto path			 = getPath(key, entryExtension);
+	const auto temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios_base::binary | std::ios_base::trunc);
+		if(!file) throw FileIOError("Could not open " + temporaryPath + " for writing");
+		entryWriter output(file);
+
+		for(auto c : magicNumber) output.value(c);
+		output.value(formatVersion);
+
+		output.vector3(transform.position);
+		output.vector3(transform.scale);
+		output.value(float(transform.orientation.w));
+		output.value(float(transform.orientation.x));
+		output.value(float(transform.orientation.y));
+		output.value(float(transform.orientation.z));
+
+		output.string(mesh.name);
+		output.vector3(mesh.boundingBox.mCenter);
+		output.vector3(mesh.boundingBox.mHalfSize);
+
+		const auto& primitives = mesh.primitives;
+		output.value(uint32_t(primitives.size()));
+		for(auto primitive = std::begin(primitives); primitive != std::end(primitives); ++primitive)
+		{
+			//Primitives that share a vertex buffer share it again once read
+			const auto sameVertices
+				= std::find_if(std::begin(primitives), primitive, [&](const primitiveData& other) { return other.vertices == primitive->vertices; });
+			writePrimitive(output, *primitive, sameVertices != primitive ? uint32_t(sameVertices - std::begin(primitives)) : ownVertices);
+		}
+
+		output.value(uint32_t(materials.size()));
+		for(const auto& material : materials) writeMaterial(output, material);
+
+		output.value(uint32_t(textures.size()));
+		for(const auto& texture : textures)
+		{
+			output.value(int32_t(texture.imageIndex));
+			output.value(uint32_t(texture.variant));
+			output.value(uint32_t(texture.image.width));
+			output.value(uint32_t(texture.image.height));
+			output.value(uint32_t(texture.image.format));
+			output.value(uint32_t(texture.image.mipmaps));
+			output.bytes(texture.image.pixels.data(), texture.image.pixels.size());
+			output.value(uint64_t(texture.imageHash));
+		}
+
+		output.value(skeleton != nullptr);
+		if(!file) throw FileIOError("Could not write " + temporaryPath);
+	}
+
+	std::remove(path.c_str());
+	if(std::rename(temporaryPath.c_str(), path.c_str()) != 0) throw FileIOError("Could not rename " + temporaryPath + " to " + path);
+
+	OgreLog("Wrote cache entry " + path);
+}
+
+Ogre::v1::SkeletonPtr modelCache::loadSkeleton(const std::string& key, const std::string& name) const
+{
+	const auto path = getPath(key, skeletonExtension);
+	std::ifstream file(path, std::ios_base::binary);
+	if(!file) throw FileIOError("Could not open " + path);
+	std::vector<char> content { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+	Ogre::DataStreamPtr stream(OGRE_NEW Ogre::MemoryDataStream(content.data(), content.size(), false, true));
+	auto skeleton = Ogre::v1::OldSkeletonManager::getSingleton().create(name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true);
+	Ogre::v1::SkeletonSerializer().importSkeleton(stream, skeleton.get());
+
+	return skeleton;
+}
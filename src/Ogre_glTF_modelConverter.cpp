@@ -1,28 +1,328 @@
 #include "Ogre_glTF_modelConverter.hpp"
 #include "Ogre_glTF_common.hpp"
+#include "Ogre_glTF_indexConverter.hpp"
+#include "Ogre_glTF_indexOptimizer.hpp"
+#include "Ogre_glTF_meshSimplifier.hpp"
+#include "Ogre_glTF_shadowCaster.hpp"
+#include "Ogre_glTF_sharedVertexBuffers.hpp"
+#include "Ogre_glTF_skinCompactor.hpp"
+#include "Ogre_glTF_threadPool.hpp"
+#include "Ogre_glTF_vertexInterleaver.hpp"
+#include "Ogre_glTF_vertexPool.hpp"
+#include "Ogre_glTF_vertexQuantizer.hpp"
 #include <OgreMesh2.h>
 #include <OgreMeshManager2.h>
 #include <OgreSubMesh2.h>
 #include "Ogre_glTF_internal_utils.hpp"
+#include <OgreBitwise.h>
+#include <OgreLodStrategy.h>
+#include <OgreLodStrategyManager.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <sstream>
 
 using namespace Ogre_glTF;
 
-size_t vertexBufferPart::getPartStride() const { return buffer->elementSize() * perVertex; }
+namespace
+{
+	///Read integer or half float components, and convert them to float
+	/// \param address where the components are
+	/// \param count number of components
+	/// \param scale what to multiply the integer value by. 1 for integers that aren't normalized
+	/// \param minimum smallest value allowed after scaling, for signed normalized integers
+	/// \param output where to write the floats
+	template <typename T>
+	void convertComponents(const unsigned char* address, size_t count, float scale, float minimum, float* output)
+	{
+		std::array<T, 4> components {};
+		memcpy(components.data(), address, count * sizeof(T));
+		for(size_t i { 0 }; i < count; ++i) output[i] = std::max(minimum, float(components[i]) * scale);
+	}
+
+	///Get what a normalized integer component type is multiplied by to get its value
+	/// \param componentType glTF component type
+	float getNormalizationScale(int componentType)
+	{
+		switch(componentType)
+		{
+			case TINYGLTF_COMPONENT_TYPE_BYTE: return 1.0f / 127.0f;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: return 1.0f / 255.0f;
+			case TINYGLTF_COMPONENT_TYPE_SHORT: return 1.0f / 32767.0f;
+			case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: return 1.0f / 65535.0f;
+			default: return 1.0f;
+		}
+	}
+
+	///Copy an attribute into its own storage, with more components per vertex. Added components are 0, except the w of positions
+	///that is 1, so the vertex shader gets a valid homogeneous position
+	/// \param part the attribute to pad
+	/// \param componentSize size in bytes of a component
+	/// \param componentCount number of components per vertex after padding
+	/// \param one value of 1 for this component type
+	void padComponents(vertexBufferPart& part, size_t componentSize, size_t componentCount, Ogre::uint16 one)
+	{
+		const auto paddedSize = componentSize * componentCount;
+		auto storage		  = std::make_unique<geometryBuffer<unsigned char>>(part.vertexCount * paddedSize);
+		memset(storage->data(), 0, storage->size());
+
+		auto output = storage->data();
+		for(size_t vertexIndex { 0 }; vertexIndex < part.vertexCount; ++vertexIndex)
+		{
+			memcpy(output, part.source.address + vertexIndex * part.source.stride, part.source.size);
+			if(part.semantic == Ogre::VES_POSITION)
+			{
+				if(componentSize == 1)
+					output[3] = Ogre::uint8(one);
+				else
+					memcpy(output + 3 * componentSize, &one, componentSize);
+			}
+			output += paddedSize;
+		}
+
+		part.source	= { storage->dataAddress(), paddedSize, paddedSize };
+		part.storage = std::move(storage);
+	}
+
+	///Get the address of a buffer to create a GPU buffer from
+	/// \param buffer the CPU side buffer
+	/// \param keepShadowCopies if true, return a copy that Ogre keeps as the shadow copy of the GPU buffer
+	unsigned char* uploadSource(geometryBuffer_base& buffer, bool keepShadowCopies)
+	{
+		if(!keepShadowCopies) return buffer.dataAddress();
+
+		//A shadow copy is owned (and freed) by Ogre, so it has to be a SIMD allocation of its own
+		const auto bytes = buffer.dataSize() * buffer.elementSize();
+		auto copy		 = reinterpret_cast<unsigned char*>(OGRE_MALLOC_SIMD(bytes, Ogre::MEMCATEGORY_GEOMETRY));
+		memcpy(copy, buffer.dataAddress(), bytes);
+		return copy;
+	}
+
+	///Check if the material of a primitive discards pixels by their alpha
+	/// \param model the glTF model
+	/// \param primitive the glTF primitive
+	bool isAlphaTested(const tinygltf::Model& model, const tinygltf::Primitive& primitive)
+	{
+		if(primitive.material < 0 || size_t(primitive.material) >= model.materials.size()) return false;
+
+		const auto& values	= model.materials[primitive.material].additionalValues;
+		const auto alphaMode = values.find("alphaMode");
+		return alphaMode != values.end() && alphaMode->second.string_value == "MASK";
+	}
+
+	///Call a function with every index from 0 to count, in parallel on the workers if there are some. Every call is done before the
+	///first exception thrown is passed on : the calls share the data they work on. What the calls log is written by this thread once
+	///they are all done, in the order of the indices
+	/// \param workers thread pool to run the calls on, or nullptr to make them one after the other on this thread
+	/// \param count number of calls
+	/// \param task function taking the index
+	template <typename Function>
+	void forEachIndex(threadPool* workers, size_t count, const Function& task)
+	{
+		if(!workers || count < 2)
+		{
+			for(size_t i { 0 }; i < count; ++i) task(i);
+			return;
+		}
+
+		std::vector<std::vector<std::string>> reports(count);
+		std::vector<std::future<void>> tasks;
+		tasks.reserve(count);
+		for(size_t i { 0 }; i < count; ++i)
+			tasks.push_back(workers->submit([&task, &reports, i] {
+				logCapture capture(reports[i]);
+				task(i);
+			}));
+
+		std::exception_ptr failure;
+		for(auto& pending : tasks)
+		{
+			try
+			{
+				workers->get(pending);
+			}
+			catch(...)
+			{
+				if(!failure) failure = std::current_exception();
+			}
+		}
+
+		for(const auto& report : reports)
+			for(const auto& message : report) OgreLog(message);
+		if(failure) std::rethrow_exception(failure);
+	}
+
+	///Turn the joints and weights of every vertex into bone assignments, in one pass specialised for their component types
+	/// \param joints the JOINTS_0 attribute, 4 components per vertex
+	/// \param weights the WEIGHTS_0 attribute, 4 components per vertex
+	/// \param weightScale what the integer weights are multiplied by, 1 for float weights
+	/// \param output where to add the 4 assignments of each vertex
+	template <typename jointType, typename weightType>
+	void readSkin(const vertexBufferPart& joints, const vertexBufferPart& weights, float weightScale, std::vector<Ogre::VertexBoneAssignment>& output)
+	{
+		std::array<jointType, 4> vertexJoints;
+		std::array<weightType, 4> vertexWeights;
+		for(Ogre::uint32 vertexIndex { 0 }; vertexIndex < joints.vertexCount; ++vertexIndex)
+		{
+			memcpy(vertexJoints.data(), joints.source.address + vertexIndex * joints.source.stride, sizeof vertexJoints);
+			memcpy(vertexWeights.data(), weights.source.address + vertexIndex * weights.source.stride, sizeof vertexWeights);
+			for(size_t i { 0 }; i < 4; ++i) output.emplace_back(vertexIndex, Ogre::uint16(vertexJoints[i]), float(vertexWeights[i]) * weightScale);
+		}
+	}
+
+	///Map the blend indices of a skinned submesh to the bones of the skeleton. The vertex buffer already holds the compacted blend indices
+	///and weights Hlms skins with, and the bones are created in the order of the joints : blend index i is bone i. This is what Ogre's mesh
+	///serializer restores too, without building one bone assignment per influence and compiling them into the vertices again
+	/// \param subMesh the submesh
+	/// \param assignments bone assignments of its vertices, to find the largest joint
+	void mapBlendIndicesToBones(Ogre::SubMesh& subMesh, const std::vector<Ogre::VertexBoneAssignment>& assignments)
+	{
+		Ogre::uint16 largestJoint { 0 };
+		for(const auto& assignment : assignments) largestJoint = std::max(largestJoint, assignment.boneIndex);
+
+		subMesh.mBlendIndexToBoneIndexMap.resize(size_t(largestJoint) + 1);
+		for(size_t i { 0 }; i <= largestJoint; ++i) subMesh.mBlendIndexToBoneIndexMap[i] = Ogre::uint16(i);
+	}
+
+#if OGRE_VERSION_MAJOR == 2 && OGRE_VERSION_MINOR == 1
+	///Ogre 2.1 has no public setter for the level of detail values of a v2 mesh : only its serializer, a friend class, and importV1() write
+	///them, and an Item never switches levels without them. Going through a v1 mesh would convert the whole geometry again. These are the
+	///only protected members of Ogre the converter touches, on the version they are known to be filled this way
+	struct meshLodAccess : Ogre::Mesh
+	{
+		static Ogre::LodValueArray& values(Ogre::Mesh& mesh) { return mesh.*(&meshLodAccess::mLodValues); }
+		static const Ogre::String& strategyName(const Ogre::Mesh& mesh) { return mesh.*(&meshLodAccess::mLodStrategyName); }
+	};
+#endif
+
+	///Set the level of detail values of a mesh, the way its serializer does : the base value of the mesh's strategy for level 0, then each
+	///distance transformed to that strategy's values (squared distance for the distance strategies)
+	/// \param mesh the mesh, with as many levels in its submeshes as there are distances
+	/// \param distances distance at which each level starts to be used
+	void setLodValues(Ogre::Mesh& mesh, const std::vector<float>& distances)
+	{
+#if OGRE_VERSION_MAJOR == 2 && OGRE_VERSION_MINOR == 1
+		auto& strategies = Ogre::LodStrategyManager::getSingleton();
+		auto strategy	= strategies.getStrategy(meshLodAccess::strategyName(mesh));
+		if(!strategy) strategy = strategies.getDefaultStrategy();
+
+		auto& lodValues = meshLodAccess::values(mesh);
+		lodValues.assign(1, strategy->getBaseValue());
+		for(const auto distance : distances) lodValues.push_back(strategy->transformUserValue(distance));
+#else
+		(void)distances;
+		OgreLog("Levels of detail of mesh " + mesh.getName() + " not enabled : setting them is only supported on Ogre 2.1");
+#endif
+	}
+}
+
+size_t vertexBufferPart::getPartStride() const { return source.size; }
+
+std::vector<Ogre::uint32> primitiveData::readIndices(size_t level) const
+{
+	const auto& buffer = level == 0 ? indices : lodIndices.at(level - 1);
+	std::vector<Ogre::uint32> output(level == 0 ? indexCount : buffer->dataSize());
+	if(indexType == Ogre::IndexBufferPacked::IT_32BIT)
+		memcpy(output.data(), buffer->dataAddress(), output.size() * sizeof(Ogre::uint32));
+	else
+	{
+		const auto source = reinterpret_cast<const Ogre::uint16*>(buffer->dataAddress());
+		std::copy(source, source + output.size(), output.begin());
+	}
+	return output;
+}
+
+std::unique_ptr<geometryBuffer_base> primitiveData::makeIndexBuffer(const std::vector<Ogre::uint32>& source) const
+{
+	if(indexType == Ogre::IndexBufferPacked::IT_32BIT)
+	{
+		auto buffer = std::make_unique<geometryBuffer<Ogre::uint32>>(source.size());
+		std::copy(source.begin(), source.end(), buffer->data());
+		return buffer;
+	}
+
+	auto buffer = std::make_unique<geometryBuffer<Ogre::uint16>>(source.size());
+	narrowIndices(source.data(), buffer->data(), source.size());
+	return buffer;
+}
+
+std::vector<Ogre::Vector3> primitiveData::readPositions() const
+{
+	if(vertexCount == 0) return {};
+
+	const auto stride = vertices->size() / vertexCount;
+	size_t offset { 0 };
+	for(const auto& element : vertexElements)
+	{
+		const auto elementSize = Ogre::v1::VertexElement::getTypeSize(element.mType);
+		if(element.mSemantic != Ogre::VES_POSITION)
+		{
+			offset += elementSize;
+			continue;
+		}
+
+		const vertexBufferPart position { { vertices->data() + offset, stride, elementSize }, element.mType, Ogre::VES_POSITION, vertexCount, 3 };
+		std::vector<Ogre::Vector3> positions(vertexCount);
+		std::array<float, 4> components {};
+		for(size_t vertexIndex { 0 }; vertexIndex < positions.size(); ++vertexIndex)
+		{
+			position.readFloats(vertexIndex, components.data());
+			positions[vertexIndex] = Ogre::Vector3 { components.data() };
+		}
+		return positions;
+	}
+	return {};
+}
+
+void vertexBufferPart::readFloats(size_t vertexIndex, float* output) const
+{
+	const auto address = source.address + vertexIndex * source.stride;
+	switch(type)
+	{
+		case Ogre::VET_FLOAT2:
+		case Ogre::VET_FLOAT3:
+		case Ogre::VET_FLOAT4: memcpy(output, address, perVertex * sizeof(float)); return;
+		case Ogre::VET_BYTE4: convertComponents<Ogre::int8>(address, perVertex, 1, -128, output); return;
+		case Ogre::VET_BYTE4_SNORM: convertComponents<Ogre::int8>(address, perVertex, 1 / 127.0f, -1, output); return;
+		case Ogre::VET_UBYTE4: convertComponents<Ogre::uint8>(address, perVertex, 1, 0, output); return;
+		case Ogre::VET_UBYTE4_NORM: convertComponents<Ogre::uint8>(address, perVertex, 1 / 255.0f, 0, output); return;
+		case Ogre::VET_SHORT2:
+		case Ogre::VET_SHORT4: convertComponents<Ogre::int16>(address, perVertex, 1, -32768, output); return;
+		case Ogre::VET_SHORT2_SNORM:
+		case Ogre::VET_SHORT4_SNORM: convertComponents<Ogre::int16>(address, perVertex, 1 / 32767.0f, -1, output); return;
+		case Ogre::VET_USHORT2:
+		case Ogre::VET_USHORT4: convertComponents<Ogre::uint16>(address, perVertex, 1, 0, output); return;
+		case Ogre::VET_USHORT2_NORM:
+		case Ogre::VET_USHORT4_NORM: convertComponents<Ogre::uint16>(address, perVertex, 1 / 65535.0f, 0, output); return;
+		case Ogre::VET_HALF2:
+		case Ogre::VET_HALF4:
+		{
+			std::array<Ogre::uint16, 4> halves {};
+			memcpy(halves.data(), address, perVertex * sizeof(Ogre::uint16));
+			for(size_t i { 0 }; i < perVertex; ++i) output[i] = Ogre::Bitwise::halfToFloat(halves[i]);
+			return;
+		}
+		default: throw LoadingError("Can't read vertex element type " + std::to_string(int(type)) + " as floats");
+	}
+}
 
-modelConverter::modelConverter(tinygltf::Model& input) : model { input } {}
+modelConverter::modelConverter(tinygltf::Model& input, const bufferResolver& bufferAccess) : model { input }, buffers { bufferAccess } {}
 
-Ogre::VertexBufferPackedVec modelConverter::constructVertexBuffer(const std::vector<vertexBufferPart>& parts) const
+void modelConverter::constructVertexBuffer(const std::vector<vertexBufferPart>& parts, primitiveData& primitive) const
 {
 	Ogre::VertexElement2Vec vertexElements;
 
-	size_t stride { 0 }, strideInElements { 0 };
+	size_t stride { 0 };
 	size_t vertexCount { 0 }, previousVertexCount { 0 };
 
 	for(const auto& part : parts)
 	{
 		vertexElements.emplace_back(part.type, part.semantic);
-		strideInElements += part.perVertex;
-		stride += part.buffer->elementSize() * part.perVertex;
+		stride += part.getPartStride();
 		vertexCount = part.vertexCount;
 
 		//Sanity check
@@ -36,140 +336,456 @@ Ogre::VertexBufferPackedVec modelConverter::constructVertexBuffer(const std::vec
 
 	OgreLog("There will be " + std::to_string(vertexCount) + " vertices with a stride of " + std::to_string(stride) + " bytes");
 
-	geometryBuffer<float> finalBuffer(vertexCount * strideInElements);
-	size_t bytesWrittenInCurrentStride { 0 };
-	for(size_t vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+	std::vector<vertexSource> sources;
+	sources.reserve(parts.size());
+	for(const auto& part : parts) sources.push_back(part.source);
+
+	auto finalBuffer = std::make_unique<geometryBuffer<unsigned char>>(vertexCount * stride);
+	interleaveVertices(sources, finalBuffer->dataAddress(), vertexCount);
+
+	primitive.vertexElements = std::move(vertexElements);
+	primitive.vertices		 = std::move(finalBuffer);
+	primitive.vertexCount	= vertexCount;
+}
+
+const tinygltf::Mesh& modelConverter::getMainMesh() const
+{
+	//TODO make this method make the mesh id. Enumerate the meshes in the file before blindlessly loading the first one
+	OgreLog("Default scene" + std::to_string(model.defaultScene));
+	const auto mainMeshIndex = (model.defaultScene != 0 ? model.nodes[model.scenes[model.defaultScene].nodes.front()].mesh : 0);
+	return model.meshes[mainMeshIndex];
+}
+
+Ogre::OperationType modelConverter::getOperationType(int mode)
+{
+	switch(mode)
 	{
-		bytesWrittenInCurrentStride = 0;
-		for(const auto& part : parts)
+		case TINYGLTF_MODE_LINE: OgreLog("Line List"); return Ogre::OT_LINE_LIST;
+		case TINYGLTF_MODE_LINE_LOOP: OgreLog("Line Loop"); return Ogre::OT_LINE_STRIP;
+		case TINYGLTF_MODE_POINTS: OgreLog("Points"); return Ogre::OT_POINT_LIST;
+		case TINYGLTF_MODE_TRIANGLES: OgreLog("Triangle List"); return Ogre::OT_TRIANGLE_LIST;
+		case TINYGLTF_MODE_TRIANGLE_FAN: OgreLog("Trinagle Fan"); return Ogre::OT_TRIANGLE_FAN;
+		case TINYGLTF_MODE_TRIANGLE_STRIP: OgreLog("Triangle Strip"); return Ogre::OT_TRIANGLE_STRIP;
+		default: OgreLog("Unknown"); throw LoadingError("Can't understand primitive mode!");
+	};
+}
+
+void modelConverter::extractBoneAssignments(const vertexBufferPart& blendIndices, const vertexBufferPart& blendWeights, primitiveData& primitive)
+{
+	if(blendIndices.vertexCount != blendWeights.vertexCount) throw LoadingError("Joints and weights of a primitive have different vertex counts");
+
+	auto& output = primitive.boneAssignments;
+	output.reserve(blendIndices.vertexCount * blendIndices.perVertex);
+
+	//The usual layouts are read in a single pass without conversion calls. Joints and weights are always 4 components in glTF
+	if(blendIndices.perVertex == 4 && blendWeights.perVertex == 4)
+	{
+		const auto weightType = blendWeights.type;
+		switch(blendIndices.type)
 		{
-			memcpy(finalBuffer.dataAddress() + (bytesWrittenInCurrentStride + vertexIndex * stride),
-				   (part.buffer->dataAddress() + (vertexIndex * part.getPartStride())),
-				   part.getPartStride());
-			bytesWrittenInCurrentStride += part.getPartStride();
+			case Ogre::VET_UBYTE4:
+				if(weightType == Ogre::VET_FLOAT4) return readSkin<Ogre::uint8, float>(blendIndices, blendWeights, 1, output);
+				if(weightType == Ogre::VET_UBYTE4_NORM) return readSkin<Ogre::uint8, Ogre::uint8>(blendIndices, blendWeights, 1 / 255.0f, output);
+				if(weightType == Ogre::VET_USHORT4_NORM) return readSkin<Ogre::uint8, Ogre::uint16>(blendIndices, blendWeights, 1 / 65535.0f, output);
+				break;
+			case Ogre::VET_USHORT4:
+				if(weightType == Ogre::VET_FLOAT4) return readSkin<Ogre::uint16, float>(blendIndices, blendWeights, 1, output);
+				if(weightType == Ogre::VET_UBYTE4_NORM) return readSkin<Ogre::uint16, Ogre::uint8>(blendIndices, blendWeights, 1 / 255.0f, output);
+				if(weightType == Ogre::VET_USHORT4_NORM) return readSkin<Ogre::uint16, Ogre::uint16>(blendIndices, blendWeights, 1 / 65535.0f, output);
+				break;
+			default: break;
 		}
 	}
 
-	Ogre::VertexBufferPackedVec vec;
-	auto vertexBuffer = getVaoManager()->createVertexBuffer(vertexElements, vertexCount, Ogre::BT_IMMUTABLE, finalBuffer.data(), false);
+	//Anything else goes through the generic conversion, one vertex at a time
+	std::vector<float> vertexBoneIndex(blendIndices.perVertex);
+	std::vector<float> vertexBlend(blendWeights.perVertex);
+	const auto influences = std::min(blendIndices.perVertex, blendWeights.perVertex);
+	for(Ogre::uint32 vertexIndex = 0; vertexIndex < blendIndices.vertexCount; ++vertexIndex)
+	{
+		blendIndices.readFloats(vertexIndex, vertexBoneIndex.data());
+		blendWeights.readFloats(vertexIndex, vertexBlend.data());
+		for(size_t i = 0; i < blendIndices.perVertex; ++i)
+			output.emplace_back(vertexIndex, Ogre::ushort(vertexBoneIndex[i]), i < influences ? vertexBlend[i] : 0.0f);
+	}
+}
+
+primitiveData modelConverter::preparePrimitive(const tinygltf::Primitive& primitive, Ogre::Aabb& boundingBox, quantizationReport& quantization) const
+{
+	auto output = prepareVertices(primitive, boundingBox, quantization);
+	extractIndexBuffer(primitive.indices, output);
+	output.operationType = getOperationType(primitive.mode);
+	optimizeVertexOrder(output);
+	return output;
+}
 
-	vec.push_back(vertexBuffer);
-	return vec;
+void modelConverter::optimizeVertexOrder(primitiveData& primitive) const
+{
+	if(!optimizeIndices) return;
+
+	const auto report = indexOptimizer {}.optimize(primitive, primitive.readPositions());
+	if(!report.empty()) OgreLog("Optimized primitive of " + std::to_string(primitive.indexCount / 3) + " triangles : " + report);
 }
 
-//TODO make this method make the mesh id. Enumerate the meshes in the file before blindlessly loading the first one
-Ogre::MeshPtr modelConverter::getOgreMesh()
+primitiveData modelConverter::prepareVertices(const tinygltf::Primitive& primitive, Ogre::Aabb& boundingBox, quantizationReport& quantization) const
 {
-	OgreLog("Default scene" + std::to_string(model.defaultScene));
-	const auto mainMeshIndex = (model.defaultScene != 0 ? model.nodes[model.scenes[model.defaultScene].nodes.front()].mesh : 0);
-	const auto& mesh		 = model.meshes[mainMeshIndex];
-	Ogre::Aabb boundingBox;
-	OgreLog("Found mesh " + mesh.name + " in glTF file");
+	primitiveData output;
 
-	auto OgreMesh = Ogre::MeshManager::getSingleton().getByName(mesh.name);
-	if(OgreMesh)
+	//The second set of joints and weights is merged into the first one : Ogre skins with a single set
+	std::vector<vertexBufferPart> parts, extraInfluences;
+	//OgreLog("\tprimitive has : " + std::to_string(primitive.attributes.size()) + " atributes");
+	for(const auto& atribute : primitive.attributes)
 	{
-		OgreLog("Found mesh " + mesh.name + " in Ogre::MeshManager(v2)");
-		return OgreMesh;
+		//OgreLog("\t " + atribute.first);
+		auto part = extractVertexBuffer(atribute, boundingBox);
+		if(atribute.first == "JOINTS_1" || atribute.first == "WEIGHTS_1")
+			extraInfluences.push_back(std::move(part));
+		else
+			parts.push_back(std::move(part));
 	}
 
-	OgreLog("Loading mesh from glTF file");
+	//Get (if they exists) the blend weights and bone index parts of our vertex array object content
+	const auto blendIndicesIt = std::find_if(std::begin(parts), std::end(parts), [](const vertexBufferPart& vertexBufferPart) {
+		return (vertexBufferPart.semantic == Ogre::VertexElementSemantic::VES_BLEND_INDICES);
+	});
+
+	const auto blendWeightsIt = std::find_if(std::begin(parts), std::end(parts), [](const vertexBufferPart& vertexBufferPart) {
+		return (vertexBufferPart.semantic == Ogre::VertexElementSemantic::VES_BLEND_WEIGHTS);
+	});
+
+	if(blendIndicesIt != std::end(parts) && blendWeightsIt != std::end(parts))
+	{
+		//OgreLog("The vertex buffer contains blend weights and indices information!");
+		const auto extraJoints = std::find_if(std::begin(extraInfluences), std::end(extraInfluences), [](const vertexBufferPart& part) {
+			return part.semantic == Ogre::VES_BLEND_INDICES;
+		});
+		const auto extraWeights = std::find_if(std::begin(extraInfluences), std::end(extraInfluences), [](const vertexBufferPart& part) {
+			return part.semantic == Ogre::VES_BLEND_WEIGHTS;
+		});
+		const auto hasExtra = extraJoints != std::end(extraInfluences) && extraWeights != std::end(extraInfluences);
+
+		//Weights lose precision on 8 bits, they are only converted when quantizing. Joints are converted whenever they fit
+		const auto skin = compactSkin(*blendIndicesIt,
+									  *blendWeightsIt,
+									  hasExtra ? &*extraJoints : nullptr,
+									  hasExtra ? &*extraWeights : nullptr,
+									  maxBoneInfluences,
+									  quantizeVertices);
+		OgreLog("Skin stored in " + std::to_string(skin.compactBytes) + " bytes instead of " + std::to_string(skin.originalBytes));
+		if(skin.prunedVertices > 0)
+			OgreLog("Kept the " + std::to_string(maxBoneInfluences) + " largest bone weights of " + std::to_string(skin.prunedVertices)
+					+ " vertices, largest weight dropped : " + std::to_string(skin.largestPrunedWeight));
+
+		extractBoneAssignments(*blendIndicesIt, *blendWeightsIt, output);
+	}
+
+	//Hlms reads VET_SHORT4_SNORM normals as QTangents, and has no other integer normal or tangent : the 8 and 16 bit normals and tangents
+	//from KHR_mesh_quantization have to be encoded as one
+	const auto hasIntegerNormals = std::any_of(std::begin(parts), std::end(parts), [](const vertexBufferPart& part) {
+		const auto isSnorm = part.type == Ogre::VET_SHORT4_SNORM || part.type == Ogre::VET_BYTE4_SNORM;
+		return isSnorm && ((part.semantic == Ogre::VES_NORMAL && part.perVertex == 3) || part.semantic == Ogre::VES_TANGENT);
+	});
+
+	//Done after reading the bone assignments : the quantizer can remove and replace parts
+	if(quantizeVertices || hasIntegerNormals)
+	{
+		vertexQuantizer quantizer;
+		if(quantizeVertices)
+			quantizer.quantize(parts);
+		else
+			quantizer.encodeNormals(parts);
+		quantization.merge(quantizer.getReport());
+	}
+
+	constructVertexBuffer(parts, output);
+	return output;
+}
+
+void modelConverter::generateLods(primitiveData& primitive) const
+{
+	primitive.lodIndices.clear();
+	if(lodDistances.empty()) return;
+
+	auto indices			 = primitive.readIndices();
+	const auto triangleCount = indices.size() / 3;
+	const auto positions	 = primitive.operationType == Ogre::OT_TRIANGLE_LIST ? primitive.readPositions() : std::vector<Ogre::Vector3> {};
+	const auto simplifiable	 = triangleCount > 0 && indices.size() % 3 == 0 && positions.size() == primitive.vertexCount
+		&& std::none_of(indices.begin(), indices.end(), [&](Ogre::uint32 index) { return index >= primitive.vertexCount; });
+
+	//Every submesh needs the same number of levels : the ones that can't be simplified draw all their triangles at each level
+	if(!simplifiable)
+	{
+		for(size_t level { 0 }; level < lodDistances.size(); ++level) primitive.lodIndices.push_back(primitive.makeIndexBuffer(indices));
+		return;
+	}
+
+	meshSimplifier simplifier { positions, indices, primitive.boneAssignments };
+	std::stringstream report;
+	report << triangleCount;
+
+	//Each level carries on from the previous one, so the collapses are only computed once
+	auto target = double(triangleCount);
+	for(size_t level { 0 }; level < lodDistances.size(); ++level)
+	{
+		target *= lodReduction;
+		auto simplified = simplifier.simplify(size_t(target));
+		if(!simplified.empty()) indices = std::move(simplified);
+
+		report << " -> " << indices.size() / 3;
+		primitive.lodIndices.push_back(primitive.makeIndexBuffer(indices));
+	}
+
+	OgreLog("Generated levels of detail of a primitive : " + report.str() + " triangles");
+}
+
+void modelConverter::finishPrimitive(primitiveData& primitive, bool alphaTested) const
+{
+	generateLods(primitive);
+
+	if(shadowCasters)
+	{
+		primitive.shadowCaster = makeShadowCaster(primitive, alphaTested, shadowCasterReduction);
+		if(primitive.shadowCaster)
+			OgreLog("Shadow caster of " + std::to_string(primitive.shadowCaster->vertexCount) + " vertices and "
+					+ std::to_string(primitive.shadowCaster->indexCount) + " indices instead of " + std::to_string(primitive.vertexCount) + " and "
+					+ std::to_string(primitive.indexCount));
+	}
+}
+
+void modelConverter::prepareMesh(threadPool* workers)
+{
+	if(preparedMesh) return;
+
+	const auto& mesh = getMainMesh();
+	auto prepared	= std::make_unique<meshData>();
+	prepared->name   = mesh.name;
+
+	OgreLog("Preparing mesh " + mesh.name + " from glTF file");
 	OgreLog("mesh has " + std::to_string(mesh.primitives.size()) + " primitives");
-	OgreMesh = Ogre::MeshManager::getSingleton().createManual(mesh.name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
-	OgreLog("Created mesh on v2 MeshManager");
 
-	for(const auto& primitive : mesh.primitives)
+	//Each task only writes its own slot : they are gathered in the order of the primitives, whatever the order they finished in
+	struct preparedPrimitive
 	{
-		auto subMesh = OgreMesh->createSubMesh();
-		OgreLog("Created one submesh");
-		const auto indexBuffer = extractIndexBuffer(primitive.indices);
+		std::vector<primitiveData> submeshes;
+		Ogre::Aabb boundingBox;
+		quantizationReport quantization;
+	};
+	std::vector<preparedPrimitive> preparedPrimitives(mesh.primitives.size());
+	const auto addSubmeshes = [&](size_t primitiveIndex, primitiveData primitive) {
+		auto& output			  = preparedPrimitives[primitiveIndex];
+		primitive.sourcePrimitive = primitiveIndex;
 
-		std::vector<vertexBufferPart> parts;
-		//OgreLog("\tprimitive has : " + std::to_string(primitive.attributes.size()) + " atributes");
-		for(const auto& atribute : primitive.attributes)
+		if(splitLargeMeshes && primitive.vertexCount > largest16BitIndex + 1)
 		{
-			//OgreLog("\t " + atribute.first);
-			parts.push_back(std::move(extractVertexBuffer(atribute, boundingBox)));
+			output.submeshes = splitPrimitive(primitive);
+			if(!output.submeshes.empty())
+			{
+				OgreLog("Split primitive of " + std::to_string(primitive.vertexCount) + " vertices in " + std::to_string(output.submeshes.size())
+						+ " submeshes");
+				return;
+			}
 		}
 
-		//Get (if they exists) the blend weights and bone index parts of our vertex array object content
-		const auto blendIndicesIt = std::find_if(std::begin(parts), std::end(parts), [](const vertexBufferPart& vertexBufferPart) {
-			return (vertexBufferPart.semantic == Ogre::VertexElementSemantic::VES_BLEND_INDICES);
-		});
+		output.submeshes.push_back(std::move(primitive));
+	};
 
-		const auto blendWeightsIt = std::find_if(std::begin(parts), std::end(parts), [](const vertexBufferPart& vertexBufferPart) {
-			return (vertexBufferPart.semantic == Ogre::VertexElementSemantic::VES_BLEND_WEIGHTS);
-		});
+	//Exporters often cut a mesh by material into primitives that all point to the same attribute accessors. Their vertices are read
+	//once, and each primitive either keeps the ones its indices use, or draws from all of them in a vertex buffer uploaded once
+	std::vector<std::vector<size_t>> vertexSets;
+	for(size_t primitiveIndex { 0 }; primitiveIndex < mesh.primitives.size(); ++primitiveIndex)
+	{
+		const auto& attributes = mesh.primitives[primitiveIndex].attributes;
+		const auto sameAttributes
+			= std::find_if(vertexSets.begin(), vertexSets.end(), [&](const std::vector<size_t>& set) { return mesh.primitives[set.front()].attributes == attributes; });
+		if(sameAttributes == vertexSets.end())
+			vertexSets.push_back({ primitiveIndex });
+		else
+			sameAttributes->push_back(primitiveIndex);
+	}
 
-		const auto vertexBuffers = constructVertexBuffer(parts);
-		auto vao				 = getVaoManager()->createVertexArrayObject(vertexBuffers, indexBuffer, [&]() -> Ogre::OperationType {
-			switch(primitive.mode)
+	forEachIndex(workers, vertexSets.size(), [&](size_t setIndex) {
+		const auto& members = vertexSets[setIndex];
+		auto& first			= preparedPrimitives[members.front()];
+		if(members.size() == 1)
+		{
+			addSubmeshes(members.front(), preparePrimitive(mesh.primitives[members.front()], first.boundingBox, first.quantization));
+			return;
+		}
+
+		const auto shared = prepareVertices(mesh.primitives[members.front()], first.boundingBox, first.quantization);
+		forEachIndex(workers, members.size(), [&](size_t member) {
+			const auto& source = mesh.primitives[members[member]];
+			primitiveData primitive;
+			extractIndexBuffer(source.indices, primitive);
+			primitive.operationType = getOperationType(source.mode);
+
+			//Reordering the vertices for one primitive would give it a buffer of its own : only the shared indices are kept as they are
+			if(shareVertexBuffers)
+			{
+				primitive.vertexElements  = shared.vertexElements;
+				primitive.vertices		  = shared.vertices;
+				primitive.vertexCount	  = shared.vertexCount;
+				primitive.boneAssignments = shared.boneAssignments;
+			}
+			else
 			{
-				case TINYGLTF_MODE_LINE: OgreLog("Line List"); return Ogre::OT_LINE_LIST;
-				case TINYGLTF_MODE_LINE_LOOP: OgreLog("Line Loop"); return Ogre::OT_LINE_STRIP;
-				case TINYGLTF_MODE_POINTS: OgreLog("Points"); return Ogre::OT_POINT_LIST;
-				case TINYGLTF_MODE_TRIANGLES: OgreLog("Triangle List"); return Ogre::OT_TRIANGLE_LIST;
-				case TINYGLTF_MODE_TRIANGLE_FAN: OgreLog("Trinagle Fan"); return Ogre::OT_TRIANGLE_FAN;
-				case TINYGLTF_MODE_TRIANGLE_STRIP: OgreLog("Triangle Strip"); return Ogre::OT_TRIANGLE_STRIP;
-				default: OgreLog("Unknown"); throw LoadingError("Can't understand primitive mode!");
-			};
-		}());
+				copyUsedVertices(shared, primitive);
+				optimizeVertexOrder(primitive);
+			}
+			addSubmeshes(members[member], std::move(primitive));
+		});
+		OgreLog("Read the " + std::to_string(shared.vertexCount) + " vertices shared by " + std::to_string(members.size()) + " primitives once");
+	});
 
-		subMesh->mVao[Ogre::VpNormal].push_back(vao);
-		subMesh->mVao[Ogre::VpShadow].push_back(vao);
+	quantizationReport quantization;
+	for(auto& output : preparedPrimitives)
+	{
+		prepared->boundingBox.merge(output.boundingBox);
+		quantization.merge(output.quantization);
+		for(auto& submesh : output.submeshes) prepared->primitives.push_back(std::move(submesh));
+	}
+	preparedPrimitives.clear();
+	if(quantizeVertices) OgreLog("Quantized mesh " + mesh.name + " : " + quantization.toString());
+
+	//Split primitives are finished piece by piece, so one large primitive doesn't keep a single worker busy
+	std::vector<bool> alphaTested;
+	for(const auto& primitive : prepared->primitives) alphaTested.push_back(isAlphaTested(model, mesh.primitives[primitive.sourcePrimitive]));
+	forEachIndex(workers, prepared->primitives.size(), [&](size_t i) { finishPrimitive(prepared->primitives[i], alphaTested[i]); });
+
+	//Done once the levels of detail are made, they are simplified from the vertices of their own primitive only
+	if(poolVertexBuffers)
+	{
+		const auto pools = poolVertices(prepared->primitives);
+		if(pools > 0) OgreLog("Pooled the vertices of mesh " + mesh.name + " in " + std::to_string(pools) + " vertex buffers");
+	}
+
+	setPreparedMesh(std::move(prepared));
+}
+
+Ogre::VertexArrayObject* modelConverter::createVertexArrayObject(const primitiveData& primitive, bool keepShadowCopies, uploadedVertexBuffers& uploaded) const
+{
+	auto vaoManager = getVaoManager();
+
+	const auto indexBuffer
+		= vaoManager->createIndexBuffer(primitive.indexType, primitive.indexCount, Ogre::BT_IMMUTABLE, uploadSource(*primitive.indices, keepShadowCopies), keepShadowCopies);
+
+	auto& vertexBuffer = uploaded[primitive.vertices.get()];
+	if(!vertexBuffer)
+		vertexBuffer = vaoManager->createVertexBuffer(
+			primitive.vertexElements, primitive.vertexCount, Ogre::BT_IMMUTABLE, uploadSource(*primitive.vertices, keepShadowCopies), keepShadowCopies);
+
+	Ogre::VertexBufferPackedVec vertexBuffers;
+	vertexBuffers.push_back(vertexBuffer);
+	return vaoManager->createVertexArrayObject(vertexBuffers, indexBuffer, primitive.operationType);
+}
+
+Ogre::VertexArrayObject* modelConverter::createLodVertexArrayObject(const Ogre::VertexArrayObject* vao,
+																	 const primitiveData& primitive,
+																	 geometryBuffer_base& indices,
+																	 bool keepShadowCopies) const
+{
+	auto vaoManager = getVaoManager();
+	const auto indexBuffer
+		= vaoManager->createIndexBuffer(primitive.indexType, indices.dataSize(), Ogre::BT_IMMUTABLE, uploadSource(indices, keepShadowCopies), keepShadowCopies);
+	return vaoManager->createVertexArrayObject(vao->getVertexBuffers(), indexBuffer, primitive.operationType);
+}
 
-		if(blendIndicesIt != std::end(parts) && blendWeightsIt != std::end(parts))
+const meshData& modelConverter::getPreparedMesh()
+{
+	prepareMesh();
+	return *preparedMesh;
+}
+
+void modelConverter::setPreparedMesh(std::unique_ptr<meshData> mesh)
+{
+	submeshPrimitives.clear();
+	for(const auto& primitive : mesh->primitives) submeshPrimitives.push_back(primitive.sourcePrimitive);
+
+	preparedMeshName = mesh->name;
+	preparedMesh	 = std::move(mesh);
+}
+
+size_t modelConverter::getSubmeshPrimitive(size_t submeshIndex) const
+{
+	return submeshIndex < submeshPrimitives.size() ? submeshPrimitives[submeshIndex] : submeshIndex;
+}
+
+Ogre::MeshPtr modelConverter::getOgreMesh()
+{
+	const auto meshName = model.meshes.empty() ? preparedMeshName : getMainMesh().name;
+	OgreLog("Found mesh " + meshName + " in glTF file");
+
+	auto OgreMesh = Ogre::MeshManager::getSingleton().getByName(meshName);
+	if(OgreMesh)
+	{
+		OgreLog("Found mesh " + meshName + " in Ogre::MeshManager(v2)");
+
+		//Another loader made this mesh. Splitting primitives changes which one each submesh comes from : it's only known by preparing the
+		//primitives again
+		if(submeshPrimitives.empty() && splitLargeMeshes && !model.meshes.empty())
 		{
-			//subMesh->_buildBoneAssignmentsFromVertexData();
+			prepareMesh();
+			preparedMesh.reset();
+		}
+		return OgreMesh;
+	}
 
-			//Get the vertexBufferParts from the two iterators
-			//OgreLog("The vertex buffer contains blend weights and indices information!");
-			vertexBufferPart& blendIndices = *blendIndicesIt;
-			vertexBufferPart& blendWeights = *blendWeightsIt;
+	OgreMesh = createOgreMesh(meshName, false);
 
-			//Debug sanity check, both should be equals
-			//OgreLog("Vertex count blendIndex : " + std::to_string(blendIndices.vertexCount));
-			//OgreLog("Vertex count blendWeight: " + std::to_string(blendWeights.vertexCount));
-			//OgreLog("Vertex element count blendIndex : " + std::to_string(blendIndices.perVertex));
-			//OgreLog("Vertex element count blendWeight: " + std::to_string(blendWeights.perVertex));
+	//Everything is on the GPU now, the CPU side copy is not needed anymore
+	preparedMesh.reset();
 
-			//Allocate 2 small arrays to store the bone idexes. (They should be of lenght "4")
-			std::vector<Ogre::ushort> vertexBoneIndex(blendIndices.perVertex);
-			std::vector<Ogre::Real> vertexBlend(blendWeights.perVertex);
+	return OgreMesh;
+}
 
-			//Add the attahcments for each bones
-			for(Ogre::uint32 vertexIndex = 0; vertexIndex < blendIndices.vertexCount; ++vertexIndex)
-			{
-				//Fetch the for bone indexes from the buffer
-				memcpy(vertexBoneIndex.data(),
-					   blendIndices.buffer->dataAddress() + (blendIndices.getPartStride() * vertexIndex),
-					   blendIndices.perVertex * sizeof(Ogre::ushort));
-
-				//Fetch the for weights from the buffer
-				memcpy(vertexBlend.data(),
-					   blendWeights.buffer->dataAddress() + (blendWeights.getPartStride() * vertexIndex),
-					   blendWeights.perVertex * sizeof(Ogre::Real));
-
-				//Add the bone assignments to the submesh
-				for(size_t i = 0; i < blendIndices.perVertex; ++i)
-				{
-					auto vba = Ogre::VertexBoneAssignment(vertexIndex, vertexBoneIndex[i], vertexBlend[i]);
-
-					//OgreLog("VertexBoneAssignment: " + std::to_string(i) + " over " + std::to_string(blendIndices.perVertex));
-					//OgreLog(std::to_string(vba.vertexIndex));
-					//OgreLog(std::to_string(vba.boneIndex));
-					//OgreLog(std::to_string(vba.weight));
-
-					subMesh->addBoneAssignment(vba);
-				}
-			}
+Ogre::MeshPtr modelConverter::createOgreMesh(const std::string& name, bool keepShadowCopies)
+{
+	//If a worker thread already did this, this returns immediately
+	prepareMesh();
+
+	OgreLog("Loading mesh from glTF file");
+	auto OgreMesh = Ogre::MeshManager::getSingleton().createManual(name, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	OgreLog("Created mesh on v2 MeshManager");
+
+	//Primitives that point to the same vertices get the same vertex buffer
+	uploadedVertexBuffers uploaded;
+	for(const auto& primitive : preparedMesh->primitives)
+	{
+		auto subMesh = OgreMesh->createSubMesh();
+		OgreLog("Created one submesh");
 
-			//subMesh->_buildBoneIndexMap();
-			subMesh->_compileBoneAssignments();
+		//Levels of detail only have their own indices, the vertex buffer is shared
+		auto vao = createVertexArrayObject(primitive, keepShadowCopies, uploaded);
+		subMesh->mVao[Ogre::VpNormal].push_back(vao);
+		for(const auto& lod : primitive.lodIndices) subMesh->mVao[Ogre::VpNormal].push_back(createLodVertexArrayObject(vao, primitive, *lod, keepShadowCopies));
+
+		//Shadow map passes draw the shadow caster instead, with the same number of levels
+		if(primitive.shadowCaster)
+		{
+			const auto& caster = *primitive.shadowCaster;
+			auto shadowVao	 = createVertexArrayObject(caster, keepShadowCopies, uploaded);
+			subMesh->mVao[Ogre::VpShadow].push_back(shadowVao);
+			for(const auto& lod : caster.lodIndices) subMesh->mVao[Ogre::VpShadow].push_back(createLodVertexArrayObject(shadowVao, caster, *lod, keepShadowCopies));
 		}
+		else
+			subMesh->mVao[Ogre::VpShadow] = subMesh->mVao[Ogre::VpNormal];
+
+		if(!primitive.boneAssignments.empty()) mapBlendIndicesToBones(*subMesh, primitive.boneAssignments);
+	}
+
+	const auto lodCount = preparedMesh->primitives.empty() ? 0 : preparedMesh->primitives.front().lodIndices.size();
+	if(lodCount > 0 && lodCount == lodDistances.size()) setLodValues(*OgreMesh, lodDistances);
+
+	//Every submesh destroys the vertex buffers of its VAOs : a buffer used by several of them has to be given back to a single one first
+	size_t vaoCount { 0 };
+	for(const auto& primitive : preparedMesh->primitives) vaoCount += primitive.shadowCaster ? 2 : 1;
+	if(uploaded.size() < vaoCount)
+	{
+		OgreLog("Mesh " + name + " has " + std::to_string(vaoCount - uploaded.size()) + " submeshes that share their vertex buffer");
+		sharedVertexBuffers::add(OgreMesh);
 	}
 
-	OgreMesh->_setBounds(boundingBox, true);
+	OgreMesh->_setBounds(preparedMesh->boundingBox, true);
 	//OgreLog("Setting 'bounding sphere radius' from bounds : " + std::to_string(boundingBox.getRadius()));
 
 	return OgreMesh;
@@ -197,6 +813,32 @@ void modelConverter::debugDump() const
 	OgreLog(gltfContentDump);
 }
 
+void modelConverter::setVertexQuantization(bool enabled) { quantizeVertices = enabled; }
+
+void modelConverter::setIndexOptimization(bool enabled) { optimizeIndices = enabled; }
+
+void modelConverter::setLargeMeshSplitting(bool enabled) { splitLargeMeshes = enabled; }
+
+void modelConverter::setVertexBufferPooling(bool enabled) { poolVertexBuffers = enabled; }
+
+void modelConverter::setVertexBufferSharing(bool enabled) { shareVertexBuffers = enabled; }
+
+void modelConverter::setMaxBoneInfluences(size_t count) { maxBoneInfluences = std::max<size_t>(1, std::min<size_t>(4, count)); }
+
+void modelConverter::setShadowCasters(bool enabled, float reduction)
+{
+	shadowCasters		  = enabled;
+	shadowCasterReduction = Ogre::Math::Clamp(reduction, 0.0f, 1.0f);
+}
+
+void modelConverter::setLodGeneration(std::vector<float> distances, float reduction)
+{
+	//Ogre looks for the level to use in increasing order
+	std::sort(distances.begin(), distances.end());
+	lodDistances = std::move(distances);
+	lodReduction = Ogre::Math::Clamp(reduction, 0.0f, 1.0f);
+}
+
 bool modelConverter::hasSkins() const { return !model.skins.empty(); }
 
 ModelInformation::ModelTransform modelConverter::getTransform()
@@ -245,47 +887,84 @@ Ogre::VaoManager* modelConverter::getVaoManager()
 	return Ogre::Root::getSingletonPtr()->getRenderSystem()->getVaoManager();
 }
 
-Ogre::IndexBufferPacked* modelConverter::extractIndexBuffer(int accessorID) const
+void modelConverter::extractIndexBuffer(int accessorID, primitiveData& primitive) const
 {
 	OgreLog("Extracting index buffer");
 	const auto& accessor   = model.accessors[accessorID];
 	const auto& bufferView = model.bufferViews[accessor.bufferView];
-	auto& buffer		   = model.buffers[bufferView.buffer];
+	const auto bufferData  = buffers.data(bufferView.buffer);
 	const auto byteStride  = accessor.ByteStride(bufferView);
 	const auto indexCount  = accessor.count;
-	Ogre::IndexBufferPacked::IndexType type;
+	const auto offset	   = bufferView.byteOffset + accessor.byteOffset;
 
 	if(byteStride < 0) throw LoadingError("Can't get valid bytestride from accessor and bufferview. Loading data not possible");
+	if(offset + indexCount * byteStride > buffers.size(bufferView.buffer))
+		throw LoadingError("Index buffer goes past the end of its buffer");
 
-	auto convertTo16Bit { false };
+	primitive.indexCount = indexCount;
+
+	//Index buffers are tightly packed in any valid file, and are converted by the SIMD kernels. The strided loads are a fallback
+	const auto source = bufferData + offset;
 	switch(accessor.componentType)
 	{
 		default: throw LoadingError("Unrecognized index data format");
 		case TINYGLTF_COMPONENT_TYPE_BYTE:
-		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: convertTo16Bit = true;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+		{
+			primitive.indexType = Ogre::IndexBufferPacked::IT_16BIT;
+			auto geomBuffer		= std::make_unique<geometryBuffer<Ogre::uint16>>(indexCount);
+			if(byteStride == sizeof(Ogre::uint8))
+				widenIndices(source, geomBuffer->data(), indexCount);
+			else
+				loadIndexBuffer(geomBuffer->data(), bufferData, indexCount, offset, byteStride);
+			primitive.indices = std::move(geomBuffer);
+			return;
+		}
 		case TINYGLTF_COMPONENT_TYPE_SHORT:
 		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
 		{
-			type			= Ogre::IndexBufferPacked::IT_16BIT;
-			auto geomBuffer = geometryBuffer<Ogre::uint16>(indexCount);
-			if(convertTo16Bit)
-				loadIndexBuffer(geomBuffer.data(), buffer.data.data(), indexCount, bufferView.byteOffset + accessor.byteOffset, byteStride);
+			primitive.indexType = Ogre::IndexBufferPacked::IT_16BIT;
+			auto geomBuffer		= std::make_unique<geometryBuffer<Ogre::uint16>>(indexCount);
+			if(byteStride == sizeof(Ogre::uint16))
+				memcpy(geomBuffer->data(), source, indexCount * sizeof(Ogre::uint16));
 			else
-				loadIndexBuffer(geomBuffer.data(),
-								reinterpret_cast<Ogre::uint16*>(buffer.data.data()),
-								indexCount,
-								bufferView.byteOffset + accessor.byteOffset,
-								byteStride);
-			return getVaoManager()->createIndexBuffer(type, indexCount, Ogre::BT_IMMUTABLE, geomBuffer.dataAddress(), false);
+				loadIndexBuffer(geomBuffer->data(), reinterpret_cast<const Ogre::uint16*>(bufferData), indexCount, offset, byteStride);
+			primitive.indices = std::move(geomBuffer);
+			return;
 		}
 		case TINYGLTF_COMPONENT_TYPE_INT:;
 		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
 		{
-			type			= Ogre::IndexBufferPacked::IT_32BIT;
-			auto geomBuffer = geometryBuffer<Ogre::uint32>(indexCount);
-			loadIndexBuffer(
-				geomBuffer.data(), reinterpret_cast<Ogre::uint32*>(buffer.data.data()), indexCount, bufferView.byteOffset + accessor.byteOffset, byteStride);
-			return getVaoManager()->createIndexBuffer(type, indexCount, Ogre::BT_IMMUTABLE, geomBuffer.dataAddress(), false);
+			//Most 32 bit index buffers are used on primitives that don't need them. They take half the memory as 16 bit indices
+			std::unique_ptr<geometryBuffer<Ogre::uint32>> stridedIndices;
+			auto indices = reinterpret_cast<const Ogre::uint32*>(source);
+			if(byteStride != sizeof(Ogre::uint32))
+			{
+				stridedIndices = std::make_unique<geometryBuffer<Ogre::uint32>>(indexCount);
+				loadIndexBuffer(stridedIndices->data(), reinterpret_cast<const Ogre::uint32*>(bufferData), indexCount, offset, byteStride);
+				indices = stridedIndices->data();
+			}
+
+			if(indicesFitIn16Bits(indices, indexCount))
+			{
+				OgreLog("Storing 32 bit indices on 16 bits");
+				primitive.indexType = Ogre::IndexBufferPacked::IT_16BIT;
+				auto geomBuffer		= std::make_unique<geometryBuffer<Ogre::uint16>>(indexCount);
+				narrowIndices(indices, geomBuffer->data(), indexCount);
+				primitive.indices = std::move(geomBuffer);
+				return;
+			}
+
+			primitive.indexType = Ogre::IndexBufferPacked::IT_32BIT;
+			if(stridedIndices)
+			{
+				primitive.indices = std::move(stridedIndices);
+				return;
+			}
+			auto geomBuffer = std::make_unique<geometryBuffer<Ogre::uint32>>(indexCount);
+			memcpy(geomBuffer->data(), indices, indexCount * sizeof(Ogre::uint32));
+			primitive.indices = std::move(geomBuffer);
+			return;
 		}
 	}
 }
@@ -311,6 +990,8 @@ Ogre::VertexElementSemantic modelConverter::getVertexElementScemantic(const std:
 	if(type == "COLOR_0") return Ogre::VES_DIFFUSE;
 	if(type == "JOINTS_0") return Ogre::VES_BLEND_INDICES;
 	if(type == "WEIGHTS_0") return Ogre::VES_BLEND_WEIGHTS;
+	if(type == "JOINTS_1") return Ogre::VES_BLEND_INDICES;
+	if(type == "WEIGHTS_1") return Ogre::VES_BLEND_WEIGHTS;
 	return Ogre::VES_COUNT; //Returning this means returning "invalid" here
 }
 
@@ -319,30 +1000,55 @@ vertexBufferPart modelConverter::extractVertexBuffer(const std::pair<std::string
 	const auto elementScemantic			= getVertexElementScemantic(attribute.first);
 	const auto& accessor				= model.accessors[attribute.second];
 	const auto& bufferView				= model.bufferViews[accessor.bufferView];
-	const auto& buffer					= model.buffers[bufferView.buffer];
-	const auto vertexBufferByteLen		= bufferView.byteLength;
+	const auto bufferData				= buffers.data(bufferView.buffer);
 	const auto numberOfElementPerVertex = getVertexBufferElementsPerVertexCount(accessor.type);
 	const auto elementOffsetInBuffer	= bufferView.byteOffset + accessor.byteOffset;
-	size_t bufferLenghtInBufferBasicType { 0 };
 
-	std::unique_ptr<geometryBuffer_base> geomBuffer { nullptr };
+	const auto normalized				= accessor.normalized;
+	size_t componentSize { 0 };
 	Ogre::VertexElementType elementType {};
 
+	//Ogre doesn't have vertex elements made of 2 or 3 bytes, or 3 shorts : they are padded to 4 components
+	auto paddedCount = numberOfElementPerVertex;
+
 	switch(accessor.componentType)
 	{
 		case TINYGLTF_COMPONENT_TYPE_DOUBLE: throw LoadingError("Double precision not implemented!");
 		case TINYGLTF_COMPONENT_TYPE_FLOAT:
-			bufferLenghtInBufferBasicType = (vertexBufferByteLen / sizeof(float));
-			geomBuffer					  = std::make_unique<geometryBuffer<float>>(bufferLenghtInBufferBasicType);
+			componentSize = sizeof(float);
 			if(numberOfElementPerVertex == 2) elementType = Ogre::VET_FLOAT2;
 			if(numberOfElementPerVertex == 3) elementType = Ogre::VET_FLOAT3;
 			if(numberOfElementPerVertex == 4) elementType = Ogre::VET_FLOAT4;
 			break;
 		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-			bufferLenghtInBufferBasicType = (vertexBufferByteLen / sizeof(unsigned short));
-			geomBuffer					  = std::make_unique<geometryBuffer<unsigned short>>(bufferLenghtInBufferBasicType);
-			if(numberOfElementPerVertex == 2) elementType = Ogre::VET_USHORT2;
-			if(numberOfElementPerVertex == 4) elementType = Ogre::VET_USHORT4;
+			componentSize = sizeof(Ogre::uint16);
+			if(numberOfElementPerVertex == 2)
+				elementType = normalized ? Ogre::VET_USHORT2_NORM : Ogre::VET_USHORT2;
+			else
+			{
+				elementType = normalized ? Ogre::VET_USHORT4_NORM : Ogre::VET_USHORT4;
+				paddedCount = 4;
+			}
+			break;
+		case TINYGLTF_COMPONENT_TYPE_SHORT:
+			componentSize = sizeof(Ogre::int16);
+			if(numberOfElementPerVertex == 2)
+				elementType = normalized ? Ogre::VET_SHORT2_SNORM : Ogre::VET_SHORT2;
+			else
+			{
+				elementType = normalized ? Ogre::VET_SHORT4_SNORM : Ogre::VET_SHORT4;
+				paddedCount = 4;
+			}
+			break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+			componentSize = sizeof(Ogre::uint8);
+			elementType	= normalized ? Ogre::VET_UBYTE4_NORM : Ogre::VET_UBYTE4;
+			paddedCount	= 4;
+			break;
+		case TINYGLTF_COMPONENT_TYPE_BYTE:
+			componentSize = sizeof(Ogre::int8);
+			elementType	= normalized ? Ogre::VET_BYTE4_SNORM : Ogre::VET_BYTE4;
+			paddedCount	= 4;
 			break;
 		default: throw LoadingError("Unrecognized vertex buffer coponent type");
 	}
@@ -352,18 +1058,13 @@ vertexBufferPart modelConverter::extractVertexBuffer(const std::pair<std::string
 
 	const auto byteStride				  = accessor.ByteStride(bufferView);
 	const auto vertexCount				  = accessor.count;
-	const auto vertexElementLenghtInBytes = numberOfElementPerVertex * geomBuffer->elementSize();
+	const auto vertexElementLenghtInBytes = numberOfElementPerVertex * componentSize;
 
 	if(byteStride < 0) throw LoadingError("Can't get valid bytestride from accessor and bufferview. Loading data not possible");
 
-	//OgreLog("A vertex element on this buffer is " + std::to_string(vertexElementLenghtInBytes) + " bytes long");
-	for(size_t vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
-	{
-		const auto destOffset   = vertexIndex * vertexElementLenghtInBytes;
-		const auto sourceOffset = elementOffsetInBuffer + vertexIndex * byteStride;
-
-		memcpy((geomBuffer->dataAddress() + destOffset), (buffer.data.data() + sourceOffset), vertexElementLenghtInBytes);
-	}
+	//The attribute is read in place when interleaving, all of it has to be inside the buffer
+	if(vertexCount > 0 && elementOffsetInBuffer + (vertexCount - 1) * byteStride + vertexElementLenghtInBytes > buffers.size(bufferView.buffer))
+		throw LoadingError("Vertex attribute " + attribute.first + " goes past the end of its buffer");
 
 	//Update the bounding sizes once, when vertex positions has been read.
 	if(elementScemantic == Ogre::VES_POSITION)
@@ -371,9 +1072,20 @@ vertexBufferPart modelConverter::extractVertexBuffer(const std::pair<std::string
 		//Convert to float and load into Ogre::Vector3 objects
 		std::array<float, 3> floatVector {};
 		internal_utils::container_double_to_float(accessor.minValues, floatVector);
-		const Ogre::Vector3 minBounds { floatVector.data() };
+		Ogre::Vector3 minBounds { floatVector.data() };
 		internal_utils::container_double_to_float(accessor.maxValues, floatVector);
-		const Ogre::Vector3 maxBounds { floatVector.data() };
+		Ogre::Vector3 maxBounds { floatVector.data() };
+
+		//The bounds of quantized positions are the integer values. The GPU sees them normalized. Any scale and offset needed to
+		//dequantize them is in the node transform (KHR_mesh_quantization), that is given with the model transform
+		if(normalized)
+		{
+			const auto scale = getNormalizationScale(accessor.componentType);
+			minBounds *= scale;
+			maxBounds *= scale;
+			minBounds.makeCeil(Ogre::Vector3 { -1.0f });
+			maxBounds.makeCeil(Ogre::Vector3 { -1.0f });
+		}
 
 		OgreLog("Updating bounding box size: ");
 		OgreLog("Setting Min size: " + std::to_string(minBounds.x) + " " + std::to_string(minBounds.y) + " " + std::to_string(minBounds.z));
@@ -381,6 +1093,17 @@ vertexBufferPart modelConverter::extractVertexBuffer(const std::pair<std::string
 		boundingBox.merge(Ogre::Aabb::newFromExtents(minBounds, maxBounds));
 	}
 
-	//geometryBuffer->_debugContentToLog();
-	return { std::move(geomBuffer), elementType, elementScemantic, vertexCount, numberOfElementPerVertex };
+	vertexBufferPart part { { bufferData + elementOffsetInBuffer, size_t(byteStride), vertexElementLenghtInBytes },
+							elementType,
+							elementScemantic,
+							vertexCount,
+							numberOfElementPerVertex };
+
+	if(paddedCount != numberOfElementPerVertex)
+	{
+		const auto one = normalized ? Ogre::uint16(std::lround(1 / getNormalizationScale(accessor.componentType))) : Ogre::uint16(1);
+		padComponents(part, componentSize, paddedCount, one);
+	}
+
+	return part;
 }
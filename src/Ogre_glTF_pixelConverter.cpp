@@ -0,0 +1,188 @@
+#include "Ogre_glTF_pixelConverter.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OGRE_GLTF_PIXELS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define OGRE_GLTF_PIXELS_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Convert an unsigned normalized byte to a signed normalized one : round((2 * value / 255 - 1) * 127), on integers
+	/// \param value the unsigned byte
+	Ogre::int8 toSNORM(Ogre::uint8 value)
+	{
+		const auto scaled	 = (2 * int(value) - 255) * 127;
+		const auto magnitude = ((scaled < 0 ? -scaled : scaled) + 127) / 255;
+		return Ogre::int8(scaled < 0 ? -magnitude : magnitude);
+	}
+
+#if defined(OGRE_GLTF_PIXELS_SSE2)
+	///toSNORM on 8 values held in the 16 bit lanes
+	__m128i toSNORM(__m128i values)
+	{
+		const auto scaled = _mm_mullo_epi16(_mm_sub_epi16(_mm_slli_epi16(values, 1), _mm_set1_epi16(255)), _mm_set1_epi16(127));
+		const auto sign	  = _mm_srai_epi16(scaled, 15);
+
+		//The magnitude is at most 32512 : (x + 1 + (x >> 8)) >> 8 divides it by 255 exactly
+		const auto rounded	 = _mm_add_epi16(_mm_max_epi16(scaled, _mm_sub_epi16(_mm_setzero_si128(), scaled)), _mm_set1_epi16(127));
+		const auto magnitude = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(rounded, _mm_set1_epi16(1)), _mm_srli_epi16(rounded, 8)), 8);
+		return _mm_sub_epi16(_mm_xor_si128(magnitude, sign), sign);
+	}
+
+	///toSNORM on 16 bytes
+	__m128i bytesToSNORM(__m128i bytes)
+	{
+		const auto zero = _mm_setzero_si128();
+		return _mm_packs_epi16(toSNORM(_mm_unpacklo_epi8(bytes, zero)), toSNORM(_mm_unpackhi_epi8(bytes, zero)));
+	}
+#elif defined(OGRE_GLTF_PIXELS_NEON)
+	///toSNORM on 8 values
+	int8x8_t toSNORM(uint8x8_t values)
+	{
+		const auto scaled = vmulq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vshll_n_u8(values, 1)), vdupq_n_s16(255)), 127);
+
+		//The magnitude is at most 32512 : (x + 1 + (x >> 8)) >> 8 divides it by 255 exactly
+		const auto rounded	 = vreinterpretq_u16_s16(vaddq_s16(vabsq_s16(scaled), vdupq_n_s16(127)));
+		const auto magnitude = vreinterpretq_s16_u16(vshrq_n_u16(vaddq_u16(vaddq_u16(rounded, vdupq_n_u16(1)), vshrq_n_u16(rounded, 8)), 8));
+		return vqmovn_s16(vbslq_s16(vcltq_s16(scaled, vdupq_n_s16(0)), vnegq_s16(magnitude), magnitude));
+	}
+
+	///toSNORM on 16 bytes
+	int8x16_t bytesToSNORM(uint8x16_t bytes) { return vcombine_s8(toSNORM(vget_low_u8(bytes)), toSNORM(vget_high_u8(bytes))); }
+#endif
+}
+
+void Ogre_glTF::splitChannels(const Ogre::uint8* source,
+							  size_t pixelCount,
+							  size_t components,
+							  size_t firstChannel,
+							  size_t secondChannel,
+							  Ogre::uint8* first,
+							  Ogre::uint8* second)
+{
+	size_t i { 0 };
+
+#if defined(OGRE_GLTF_PIXELS_SSE2)
+	if(components == 4)
+	{
+		//Each 32 bit lane is a pixel : shifting the channel down and masking it leaves one value per lane, packed back to bytes
+		const auto firstShift  = _mm_cvtsi32_si128(int(8 * firstChannel));
+		const auto secondShift = _mm_cvtsi32_si128(int(8 * secondChannel));
+		const auto mask		   = _mm_set1_epi32(0xFF);
+		for(; i + 16 <= pixelCount; i += 16)
+		{
+			__m128i pixels[4];
+			for(size_t j { 0 }; j < 4; ++j) pixels[j] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * (i + 4 * j)));
+
+			const auto extract = [&](__m128i shift) {
+				__m128i values[4];
+				for(size_t j { 0 }; j < 4; ++j) values[j] = _mm_and_si128(_mm_srl_epi32(pixels[j], shift), mask);
+				return _mm_packus_epi16(_mm_packs_epi32(values[0], values[1]), _mm_packs_epi32(values[2], values[3]));
+			};
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(first + i), extract(firstShift));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(second + i), extract(secondShift));
+		}
+	}
+#elif defined(OGRE_GLTF_PIXELS_NEON)
+	if(components == 4)
+	{
+		for(; i + 16 <= pixelCount; i += 16)
+		{
+			const auto pixels = vld4q_u8(source + 4 * i);
+			vst1q_u8(first + i, pixels.val[firstChannel]);
+			vst1q_u8(second + i, pixels.val[secondChannel]);
+		}
+	}
+	else if(components == 3)
+	{
+		for(; i + 16 <= pixelCount; i += 16)
+		{
+			const auto pixels = vld3q_u8(source + 3 * i);
+			vst1q_u8(first + i, pixels.val[firstChannel]);
+			vst1q_u8(second + i, pixels.val[secondChannel]);
+		}
+	}
+#endif
+
+	for(; i < pixelCount; ++i)
+	{
+		first[i]  = source[components * i + firstChannel];
+		second[i] = source[components * i + secondChannel];
+	}
+}
+
+void Ogre_glTF::convertNormalsToSNORM(const Ogre::uint8* source, size_t pixelCount, size_t components, bool twoChannels, Ogre::int8* destination)
+{
+	const auto outputComponents = twoChannels ? 2 : components;
+	size_t i { 0 };
+
+#if defined(OGRE_GLTF_PIXELS_SSE2)
+	//Each channel is converted on its own : the bytes are converted in place, then alpha is overwritten or x and y are kept
+	if(components == 4 && !twoChannels)
+	{
+		const auto alpha = _mm_set1_epi32(int(0xFF000000));
+		const auto one	 = _mm_set1_epi32(0x7F000000);
+		for(; i + 4 <= pixelCount; i += 4)
+		{
+			const auto converted = bytesToSNORM(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * i)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 4 * i), _mm_or_si128(_mm_andnot_si128(alpha, converted), one));
+		}
+	}
+	else if(components == 4)
+	{
+		//Sign extending the low half of each pixel makes the saturating pack exact
+		const auto lowHalves = [](__m128i pixels) { return _mm_srai_epi32(_mm_slli_epi32(pixels, 16), 16); };
+		for(; i + 8 <= pixelCount; i += 8)
+		{
+			const auto first  = bytesToSNORM(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * i)));
+			const auto second = bytesToSNORM(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * i + 16)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 2 * i), _mm_packs_epi32(lowHalves(first), lowHalves(second)));
+		}
+	}
+	else if(components == 3 && !twoChannels)
+	{
+		//Without alpha, every byte is a channel to convert
+		for(; i + 16 <= pixelCount; i += 16)
+			for(size_t j { 0 }; j < 3; ++j)
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 3 * i + 16 * j),
+								 bytesToSNORM(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 3 * i + 16 * j))));
+	}
+#elif defined(OGRE_GLTF_PIXELS_NEON)
+	if(components == 4)
+	{
+		for(; i + 16 <= pixelCount; i += 16)
+		{
+			const auto pixels = vld4q_u8(source + 4 * i);
+			if(twoChannels)
+			{
+				vst2q_s8(destination + 2 * i, { { bytesToSNORM(pixels.val[0]), bytesToSNORM(pixels.val[1]) } });
+				continue;
+			}
+			vst4q_s8(destination + 4 * i, { { bytesToSNORM(pixels.val[0]), bytesToSNORM(pixels.val[1]), bytesToSNORM(pixels.val[2]), vdupq_n_s8(127) } });
+		}
+	}
+	else if(components == 3)
+	{
+		for(; i + 16 <= pixelCount; i += 16)
+		{
+			const auto pixels = vld3q_u8(source + 3 * i);
+			if(twoChannels)
+			{
+				vst2q_s8(destination + 2 * i, { { bytesToSNORM(pixels.val[0]), bytesToSNORM(pixels.val[1]) } });
+				continue;
+			}
+			vst3q_s8(destination + 3 * i, { { bytesToSNORM(pixels.val[0]), bytesToSNORM(pixels.val[1]), bytesToSNORM(pixels.val[2]) } });
+		}
+	}
+#endif
+
+	for(; i < pixelCount; ++i)
+	{
+		for(size_t c { 0 }; c < outputComponents; ++c) destination[outputComponents * i + c] = c < 3 ? toSNORM(source[components * i + c]) : 127;
+	}
+}
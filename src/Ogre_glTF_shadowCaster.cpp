@@ -0,0 +1,135 @@
+#include "Ogre_glTF_shadowCaster.hpp"
+#include "Ogre_glTF_meshSimplifier.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Check if a vertex element is read by the shadow map passes
+	/// \param semantic semantic of the element
+	/// \param keepTextureCoordinates true if the shadow pass reads the texture coordinates
+	bool isReadByShadowPass(Ogre::VertexElementSemantic semantic, bool keepTextureCoordinates)
+	{
+		switch(semantic)
+		{
+			case Ogre::VES_POSITION:
+			case Ogre::VES_BLEND_INDICES:
+			case Ogre::VES_BLEND_WEIGHTS: return true;
+			case Ogre::VES_TEXTURE_COORDINATES: return keepTextureCoordinates;
+			default: return false;
+		}
+	}
+}
+
+std::unique_ptr<primitiveData> Ogre_glTF::makeShadowCaster(const primitiveData& primitive, bool keepTextureCoordinates, float reduction)
+{
+	const auto vertexCount = primitive.vertexCount;
+	if(vertexCount == 0 || primitive.indexCount == 0) return nullptr;
+
+	//Where the elements that are kept are in a vertex of the primitive. Only the first texture coordinates are used for alpha testing
+	struct keptElement
+	{
+		size_t offset, size;
+	};
+	std::vector<keptElement> kept;
+	Ogre::VertexElement2Vec shadowElements;
+	size_t stride { 0 }, shadowStride { 0 };
+	bool hasPosition { false }, hasTextureCoordinates { false };
+	for(const auto& element : primitive.vertexElements)
+	{
+		const auto size = Ogre::v1::VertexElement::getTypeSize(element.mType);
+		const auto keep = isReadByShadowPass(element.mSemantic, keepTextureCoordinates && !hasTextureCoordinates);
+		if(keep)
+		{
+			kept.push_back({ stride, size });
+			shadowElements.push_back(element);
+			shadowStride += size;
+			hasPosition |= element.mSemantic == Ogre::VES_POSITION;
+			hasTextureCoordinates |= element.mSemantic == Ogre::VES_TEXTURE_COORDINATES;
+		}
+		stride += size;
+	}
+	if(!hasPosition || stride * vertexCount != primitive.vertices->size()) return nullptr;
+
+	//Welding changes every index : all the levels are read first, so the ones that point out of the vertices can be left alone
+	std::vector<std::vector<Ogre::uint32>> levels;
+	for(size_t level { 0 }; level <= primitive.lodIndices.size(); ++level) levels.push_back(primitive.readIndices(level));
+	for(const auto& level : levels)
+		if(std::any_of(level.begin(), level.end(), [&](Ogre::uint32 index) { return index >= vertexCount; })) return nullptr;
+
+	std::vector<unsigned char> packed(vertexCount * shadowStride);
+	for(size_t vertex { 0 }; vertex < vertexCount; ++vertex)
+	{
+		auto output = packed.data() + vertex * shadowStride;
+		for(const auto& element : kept)
+		{
+			memcpy(output, primitive.vertices->data() + vertex * stride + element.offset, element.size);
+			output += element.size;
+		}
+	}
+
+	//Sort the vertices by content, so equal ones follow each other. Each vertex is welded onto the first vertex equal to it
+	const auto packedVertex = [&](Ogre::uint32 vertex) { return packed.data() + vertex * shadowStride; };
+	std::vector<Ogre::uint32> order(vertexCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](Ogre::uint32 a, Ogre::uint32 b) {
+		const auto comparison = memcmp(packedVertex(a), packedVertex(b), shadowStride);
+		return comparison != 0 ? comparison < 0 : a < b;
+	});
+
+	std::vector<Ogre::uint32> weldedOnto(vertexCount);
+	for(size_t i { 0 }; i < vertexCount; ++i)
+	{
+		const auto sameAsPrevious = i > 0 && memcmp(packedVertex(order[i - 1]), packedVertex(order[i]), shadowStride) == 0;
+		weldedOnto[order[i]]	  = sameAsPrevious ? weldedOnto[order[i - 1]] : order[i];
+	}
+
+	//The vertices that are kept stay in the order of the primitive, that may have been optimized for vertex fetch
+	std::vector<Ogre::uint32> remap(vertexCount);
+	Ogre::uint32 shadowVertexCount { 0 };
+	for(size_t vertex { 0 }; vertex < vertexCount; ++vertex)
+		remap[vertex] = weldedOnto[vertex] == vertex ? shadowVertexCount++ : remap[weldedOnto[vertex]];
+
+	if(shadowVertexCount == vertexCount && shadowStride == stride && reduction >= 1) return nullptr;
+
+	auto caster				= std::make_unique<primitiveData>();
+	caster->vertexElements	= std::move(shadowElements);
+	caster->vertexCount		= shadowVertexCount;
+	caster->vertices		= std::make_unique<geometryBuffer<unsigned char>>(shadowVertexCount * shadowStride);
+	caster->indexType		= primitive.indexType;
+	caster->operationType	= primitive.operationType;
+	caster->sourcePrimitive = primitive.sourcePrimitive;
+	for(Ogre::uint32 vertex { 0 }; vertex < vertexCount; ++vertex)
+		if(weldedOnto[vertex] == vertex) memcpy(caster->vertices->data() + remap[vertex] * shadowStride, packedVertex(vertex), shadowStride);
+
+	for(const auto& assignment : primitive.boneAssignments)
+		if(assignment.vertexIndex < vertexCount && weldedOnto[assignment.vertexIndex] == assignment.vertexIndex)
+			caster->boneAssignments.emplace_back(remap[assignment.vertexIndex], assignment.boneIndex, assignment.weight);
+
+	for(auto& level : levels)
+		for(auto& index : level) index = remap[index];
+
+	//Shadows are blurry and seen from afar : they can do with fewer triangles than the surface that casts them. Without the seams,
+	//the simplifier can also collapse edges the primitive had to keep
+	const auto& triangles = levels.front();
+	if(reduction < 1 && primitive.operationType == Ogre::OT_TRIANGLE_LIST && !triangles.empty() && triangles.size() % 3 == 0)
+	{
+		const auto positions = caster->readPositions();
+		meshSimplifier simplifier { positions, triangles, caster->boneAssignments };
+		for(auto& level : levels)
+		{
+			auto simplified = simplifier.simplify(size_t(double(level.size() / 3) * reduction));
+			if(!simplified.empty() && simplified.size() < level.size()) level = std::move(simplified);
+		}
+	}
+
+	caster->indexCount = levels.front().size();
+	caster->indices	= caster->makeIndexBuffer(levels.front());
+	for(auto level = levels.begin() + 1; level != levels.end(); ++level) caster->lodIndices.push_back(caster->makeIndexBuffer(*level));
+
+	return caster;
+}
@@ -0,0 +1,99 @@
+#include "Ogre_glTF_sharedTextures.hpp"
+#include "Ogre_glTF_common.hpp"
+
+#include <OgreTextureManager.h>
+
+#include <cstdio>
+#include <mutex>
+#include <unordered_map>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///A texture created under a shared name
+	struct sharedTexture
+	{
+		///contentHash() of the encoded image file it's made from
+		uint64_t imageHash;
+
+		///Number of references the TextureManager holds to a texture
+		unsigned int managerReferences;
+	};
+
+	///Protects everything below
+	std::mutex registryMutex;
+
+	///The textures, by name. Holding TexturePtr here would keep them alive past the destruction of the render system
+	std::unordered_map<std::string, sharedTexture> registry;
+
+	///Number of textures in the registry made from each image
+	std::unordered_map<uint64_t, size_t> texturesPerImage;
+
+	///Remove an entry from the registry. The mutex must be locked
+	std::unordered_map<std::string, sharedTexture>::iterator erase(std::unordered_map<std::string, sharedTexture>::iterator entry)
+	{
+		auto count = texturesPerImage.find(entry->second.imageHash);
+		if(count != std::end(texturesPerImage) && --count->second == 0) texturesPerImage.erase(count);
+		return registry.erase(entry);
+	}
+}
+
+std::string sharedTextures::getName(uint64_t imageHash, const std::string& suffix)
+{
+	char hash[17];
+	snprintf(hash, sizeof hash, "%016llx", static_cast<unsigned long long>(imageHash));
+	return "glTF_shared_texture_" + std::string(hash) + suffix;
+}
+
+void sharedTextures::add(const Ogre::TexturePtr& texture, uint64_t imageHash)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	if(!registry.emplace(texture->getName(), sharedTexture { imageHash, texture.useCount() - 1 }).second) return;
+	++texturesPerImage[imageHash];
+}
+
+bool sharedTextures::contains(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	return registry.find(name) != std::end(registry);
+}
+
+bool sharedTextures::containsImage(uint64_t imageHash)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	return texturesPerImage.find(imageHash) != std::end(texturesPerImage);
+}
+
+size_t sharedTextures::releaseUnused()
+{
+	auto& textureManager = Ogre::TextureManager::getSingleton();
+	size_t released { 0 };
+
+	std::lock_guard<std::mutex> lock(registryMutex);
+	for(auto entry = std::begin(registry); entry != std::end(registry);)
+	{
+		auto texture = textureManager.getByName(entry->first);
+
+		//Removed by someone else
+		if(!texture)
+		{
+			entry = erase(entry);
+			continue;
+		}
+
+		//Besides the TextureManager, only this function holds it : no datablock, no adapter uses it anymore
+		if(texture.useCount() > entry->second.managerReferences + 1)
+		{
+			++entry;
+			continue;
+		}
+
+		textureManager.remove(texture->getHandle());
+		entry = erase(entry);
+		++released;
+	}
+
+	OgreLog("Released " + std::to_string(released) + " unused shared textures, " + std::to_string(registry.size()) + " still in use");
+	return released;
+}
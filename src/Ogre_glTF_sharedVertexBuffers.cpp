@@ -0,0 +1,127 @@
+#include "Ogre_glTF_sharedVertexBuffers.hpp"
+#include "Ogre_glTF_common.hpp"
+
+#include <OgreMeshManager2.h>
+#include <OgrePlugin.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreRoot.h>
+#include <OgreSubMesh2.h>
+#include <Vao/OgreVaoManager.h>
+#include <Vao/OgreVertexArrayObject.h>
+
+#include <algorithm>
+#include <cassert>
+#include <unordered_set>
+#include <vector>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///The meshes with submeshes that share vertex buffers. Holding them keeps Ogre from destroying them before their buffers are given to
+	///a single submesh
+	std::vector<Ogre::MeshPtr> registry;
+
+	///Get the number of references to a registered mesh held by the resource system while it's in the MeshManager, and by the registry
+	long managedReferences() { return Ogre::ResourceGroupManager::RESOURCE_SYSTEM_NUM_REFERENCE_COUNTS + 1; }
+
+	///Installed in Ogre::Root when the first mesh is added. Root shuts the plugins down after the scene managers, and in the reverse order
+	///they were installed : the render system, that owns the buffers, is still there
+	class shutdownListener final : public Ogre::Plugin
+	{
+		///Name of the plugin
+		const Ogre::String name { "Ogre glTF shared vertex buffers" };
+
+	public:
+		///True while it's installed in Ogre::Root
+		bool installed { false };
+
+		const Ogre::String& getName() const override { return name; }
+		void install() override { installed = true; }
+		void initialise() override {}
+		void shutdown() override { sharedVertexBuffers::releaseAll(); }
+		void uninstall() override { installed = false; }
+	} shutdownHook;
+
+	///Destroy the VAOs of the submeshes that use a vertex buffer a previous submesh also uses, and the buffers only they use. Ogre
+	///destroys the submeshes in order : what is left is destroyed once, by the first submesh that has it
+	/// \param mesh the mesh, about to be destroyed
+	void giveBuffersToFirstUser(Ogre::Mesh& mesh)
+	{
+		auto vaoManager = mesh._getVaoManager();
+		std::unordered_set<Ogre::VertexBufferPacked*> owned;
+
+		for(unsigned i { 0 }; i < mesh.getNumSubMeshes(); ++i)
+		{
+			auto subMesh = mesh.getSubMesh(i);
+
+			//Without a shadow caster, the shadow VAOs are the normal ones
+			std::unordered_set<Ogre::VertexArrayObject*> vaos;
+			for(const auto& pass : subMesh->mVao) vaos.insert(std::begin(pass), std::end(pass));
+
+			std::vector<Ogre::VertexBufferPacked*> buffers;
+			for(const auto vao : vaos) buffers.insert(std::end(buffers), std::begin(vao->getVertexBuffers()), std::end(vao->getVertexBuffers()));
+
+			const auto usesOwnedBuffer = std::any_of(std::begin(buffers), std::end(buffers), [&](Ogre::VertexBufferPacked* buffer) {
+				return owned.find(buffer) != std::end(owned);
+			});
+			if(!usesOwnedBuffer)
+			{
+				owned.insert(std::begin(buffers), std::end(buffers));
+				continue;
+			}
+
+			for(const auto buffer : buffers)
+				if(owned.insert(buffer).second) vaoManager->destroyVertexBuffer(buffer);
+			for(const auto vao : vaos)
+			{
+				if(vao->getIndexBuffer()) vaoManager->destroyIndexBuffer(vao->getIndexBuffer());
+				vaoManager->destroyVertexArrayObject(vao);
+			}
+			for(auto& pass : subMesh->mVao) pass.clear();
+		}
+	}
+}
+
+void sharedVertexBuffers::add(const Ogre::MeshPtr& mesh)
+{
+	if(!shutdownHook.installed) Ogre::Root::getSingleton().installPlugin(&shutdownHook);
+
+	//Only the resource system and the caller hold the new mesh. releaseUnused() relies on the registry's reference being the only one
+	//left beside the resource system's once nothing uses the mesh
+	assert(long(mesh.useCount()) == managedReferences() && "a mesh with shared vertex buffers is referenced before being registered");
+	registry.push_back(mesh);
+}
+
+size_t sharedVertexBuffers::releaseUnused()
+{
+	auto& meshManager = Ogre::MeshManager::getSingleton();
+	size_t released { 0 };
+
+	for(auto entry = std::begin(registry); entry != std::end(registry);)
+	{
+		auto& mesh			 = *entry;
+		const auto inManager = meshManager.getByName(mesh->getName(), mesh->getGroup()).get() == mesh.get();
+
+		//Besides the resource system, only the registry holds it : no item, no ModelInformation uses it anymore
+		if(long(mesh.useCount()) > (inManager ? managedReferences() : 1))
+		{
+			++entry;
+			continue;
+		}
+
+		giveBuffersToFirstUser(*mesh);
+		if(inManager) meshManager.remove(mesh->getHandle());
+		entry = registry.erase(entry);
+		++released;
+	}
+
+	OgreLog("Released " + std::to_string(released) + " unused meshes with shared vertex buffers, " + std::to_string(registry.size()) + " still in use");
+	return released;
+}
+
+void sharedVertexBuffers::releaseAll()
+{
+	for(auto& mesh : registry) giveBuffersToFirstUser(*mesh);
+	registry.clear();
+}
@@ -68,23 +68,22 @@ void skeletonImporter::loadBoneHierarchy(const tinygltf::Skin& skin, Ogre::v1::O
 	addChidren(name, node.children, rootBone, skin.joints);
 }
 
-skeletonImporter::skeletonImporter(tinygltf::Model& input) : model { input } {}
+skeletonImporter::skeletonImporter(tinygltf::Model& input, const bufferResolver& bufferAccess) : model { input }, buffers { bufferAccess } {}
 
 void skeletonImporter::loadTimepointFromSamplerToKeyFrame(int bone, int frameID, int& count, keyFrame& animationFrame, tinygltf::AnimationSampler& sampler)
 {
 	auto& input				 = model.accessors[sampler.input];
 	count					 = static_cast<int>(input.count);
 	auto& bufferView		 = model.bufferViews[input.bufferView];
-	auto& buffer			 = model.buffers[bufferView.buffer];
-	unsigned char* dataStart = buffer.data.data() + bufferView.byteOffset + input.byteOffset;
+	const auto* dataStart	= buffers.data(bufferView.buffer) + bufferView.byteOffset + input.byteOffset;
 	const size_t byteStride  = input.ByteStride(bufferView);
 
 	assert(input.type == TINYGLTF_TYPE_SCALAR); //Need to be a scalar, since it's a timepoint
 	float data;
-	if(input.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) { data = *reinterpret_cast<float*>(dataStart + frameID * byteStride); }
+	if(input.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) { data = *reinterpret_cast<const float*>(dataStart + frameID * byteStride); }
 	else if(input.componentType == TINYGLTF_COMPONENT_TYPE_DOUBLE)
 	{
-		data = static_cast<float>(*reinterpret_cast<double*>(dataStart + frameID * byteStride));
+		data = static_cast<float>(*reinterpret_cast<const double*>(dataStart + frameID * byteStride));
 	}
 
 	if(animationFrame.timePoint < 0)
@@ -103,19 +102,18 @@ void skeletonImporter::loadVector3FromSampler(int frameID, int& count, tinygltf:
 	auto& output			 = model.accessors[sampler.output];
 	count					 = static_cast<int>(output.count);
 	auto& bufferView		 = model.bufferViews[output.bufferView];
-	auto& buffer			 = model.buffers[bufferView.buffer];
-	unsigned char* dataStart = buffer.data.data() + bufferView.byteOffset + output.byteOffset;
+	const auto* dataStart	= buffers.data(bufferView.buffer) + bufferView.byteOffset + output.byteOffset;
 	const size_t byteStride  = output.ByteStride(bufferView);
 
 	assert(output.type == TINYGLTF_TYPE_VEC3); //Need to be a 3D vectorsince it's a translation vector
 
-	if(output.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) { vector = Ogre::Vector3(reinterpret_cast<float*>(dataStart + frameID * byteStride)); }
+	if(output.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) { vector = Ogre::Vector3(reinterpret_cast<const float*>(dataStart + frameID * byteStride)); }
 	else if(output.componentType == TINYGLTF_COMPONENT_TYPE_DOUBLE) //need double to float conversion
 	{
 		std::array<float, 3> vectFloat {};
 		std::array<double, 3> vectDouble {};
 
-		memcpy(vectDouble.data(), reinterpret_cast<double*>(dataStart + frameID * byteStride), 3 * sizeof(double));
+		memcpy(vectDouble.data(), reinterpret_cast<const double*>(dataStart + frameID * byteStride), 3 * sizeof(double));
 		internal_utils::container_double_to_float(vectDouble, vectFloat);
 
 		vector = Ogre::Vector3(vectFloat.data());
@@ -127,15 +125,14 @@ void skeletonImporter::loadQuatFromSampler(int frameID, int& count, tinygltf::An
 	auto& output			 = model.accessors[sampler.output];
 	count					 = static_cast<int>(output.count);
 	auto& bufferView		 = model.bufferViews[output.bufferView];
-	auto& buffer			 = model.buffers[bufferView.buffer];
-	unsigned char* dataStart = buffer.data.data() + bufferView.byteOffset + output.byteOffset;
+	const auto* dataStart	= buffers.data(bufferView.buffer) + bufferView.byteOffset + output.byteOffset;
 	const size_t byteStride  = output.ByteStride(bufferView);
 
 	assert(output.type == TINYGLTF_TYPE_VEC4); //Need to be a 4D vectorsince it's a translation vector
 
 	if(output.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
 	{
-		float* quat_data = reinterpret_cast<float*>(dataStart + frameID * byteStride);
+		const float* quat_data = reinterpret_cast<const float*>(dataStart + frameID * byteStride);
 		quat			 = Ogre::Quaternion(quat_data[3], quat_data[0], quat_data[1], quat_data[2]);
 	}
 	else if(output.componentType == TINYGLTF_COMPONENT_TYPE_DOUBLE) //need double to float conversion
@@ -143,7 +140,7 @@ void skeletonImporter::loadQuatFromSampler(int frameID, int& count, tinygltf::An
 		std::array<float, 4> vectFloat {};
 		std::array<double, 4> vectDouble {};
 
-		memcpy(vectDouble.data(), reinterpret_cast<double*>(dataStart + frameID * byteStride), 3 * sizeof(double));
+		memcpy(vectDouble.data(), reinterpret_cast<const double*>(dataStart + frameID * byteStride), 3 * sizeof(double));
 		internal_utils::container_double_to_float(vectDouble, vectFloat);
 
 		quat = Ogre::Quaternion(vectFloat[3], vectFloat[0], vectFloat[1], vectFloat[2]);
@@ -347,6 +344,9 @@ std::vector<int> traversal(const tinygltf::Model& m, int node)
 
 Ogre::v1::SkeletonPtr skeletonImporter::getSkeleton(const std::string& name)
 {
+	//Unnamed skins get a new name each time, don't create a second skeleton if this one is still around
+	if(skeleton && Ogre::v1::OldSkeletonManager::getSingleton().getByName(skeleton->getName())) return skeleton;
+
 	const auto& skins = model.skins;
 	assert(!skins.empty());
 
@@ -364,6 +364,17 @@ Ogre::v1::SkeletonPtr skeletonImporter::getSkeleton(const std::string& name)
 		return skeleton;
 	}
 
+	return createSkeleton(skeletonName);
+}
+
+Ogre::v1::SkeletonPtr skeletonImporter::createSkeleton(const std::string& skeletonName)
+{
+	const auto& firstSkin = model.skins.front();
+
+	//Start from scratch if a skeleton has already been created from this model
+	bindMatrices.clear();
+	nodeToJointMap.clear();
+
 	//Create new skeleton
 	skeleton = Ogre::v1::OldSkeletonManager::getSingleton().create(skeletonName, Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true);
 
@@ -376,8 +387,7 @@ Ogre::v1::SkeletonPtr skeletonImporter::getSkeleton(const std::string& name)
 		const auto& inverseBindMatricesAccessor = model.accessors[inverseBindMatricesID];
 		const auto& bufferView					= model.bufferViews[inverseBindMatricesAccessor.bufferView];
 		const auto byteStride					= inverseBindMatricesAccessor.ByteStride(bufferView);
-		const auto& buffer						= model.buffers[bufferView.buffer];
-		const unsigned char* dataStart			= buffer.data.data() + bufferView.byteOffset + inverseBindMatricesAccessor.byteOffset;
+		const unsigned char* dataStart			= buffers.data(bufferView.buffer) + bufferView.byteOffset + inverseBindMatricesAccessor.byteOffset;
 
 		assert(inverseBindMatricesAccessor.count == firstSkin.joints.size());
 		assert(inverseBindMatricesAccessor.type == TINYGLTF_TYPE_MAT4);
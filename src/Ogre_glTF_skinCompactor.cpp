@@ -0,0 +1,122 @@
+#include "Ogre_glTF_skinCompactor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Influence of a bone on a vertex
+	struct influence
+	{
+		float weight;
+		Ogre::uint16 joint;
+	};
+
+	///Replace the content of a part with 4 components per vertex stored in its own buffer
+	/// \param part the part to replace
+	/// \param type new vertex element type
+	/// \param components the components of every vertex, one after the other
+	template <typename T>
+	void replacePart(vertexBufferPart& part, Ogre::VertexElementType type, const std::vector<T>& components)
+	{
+		const auto vertexSize = 4 * sizeof(T);
+		auto storage		  = std::make_unique<geometryBuffer<unsigned char>>(components.size() * sizeof(T));
+		memcpy(storage->data(), components.data(), storage->size());
+
+		part.type	  = type;
+		part.perVertex = 4;
+		part.source	= { storage->dataAddress(), vertexSize, vertexSize };
+		part.storage   = std::move(storage);
+	}
+}
+
+skinReport Ogre_glTF::compactSkin(vertexBufferPart& joints,
+								  vertexBufferPart& weights,
+								  const vertexBufferPart* extraJoints,
+								  const vertexBufferPart* extraWeights,
+								  size_t maxInfluences,
+								  bool quantizeWeights)
+{
+	const auto vertexCount = joints.vertexCount;
+	if(weights.vertexCount != vertexCount || (extraJoints && extraJoints->vertexCount != vertexCount)
+	   || (extraWeights && extraWeights->vertexCount != vertexCount))
+		throw LoadingError("Joints and weights of a primitive have different vertex counts");
+	if(!extraJoints || !extraWeights) extraJoints = extraWeights = nullptr;
+	maxInfluences = std::max<size_t>(1, std::min<size_t>(4, maxInfluences));
+
+	skinReport report;
+	report.originalBytes = vertexCount * (joints.source.size + weights.source.size);
+	if(extraJoints) report.originalBytes += vertexCount * (extraJoints->source.size + extraWeights->source.size);
+
+	std::vector<Ogre::uint16> mergedJoints(4 * vertexCount, 0);
+	std::vector<float> mergedWeights(4 * vertexCount, 0);
+	Ogre::uint16 largestJoint { 0 };
+
+	std::array<influence, 8> influences;
+	std::array<float, 4> jointComponents, weightComponents;
+	for(size_t vertex { 0 }; vertex < vertexCount; ++vertex)
+	{
+		size_t count { 0 };
+		const auto gather = [&](const vertexBufferPart& jointPart, const vertexBufferPart& weightPart) {
+			jointPart.readFloats(vertex, jointComponents.data());
+			weightPart.readFloats(vertex, weightComponents.data());
+			for(size_t i { 0 }; i < std::min<size_t>(4, std::min(jointPart.perVertex, weightPart.perVertex)); ++i)
+				if(weightComponents[i] > 0) influences[count++] = { weightComponents[i], Ogre::uint16(jointComponents[i]) };
+		};
+		gather(joints, weights);
+		if(extraJoints) gather(*extraJoints, *extraWeights);
+
+		//Largest weights first. The order of equal weights is kept, so vertices with few enough influences only lose their empty slots
+		std::stable_sort(influences.begin(), influences.begin() + count, [](const influence& a, const influence& b) { return a.weight > b.weight; });
+
+		const auto kept = std::min(count, maxInfluences);
+		float keptWeight { 1 };
+		if(count > kept)
+		{
+			++report.prunedVertices;
+			report.largestPrunedWeight = std::max(report.largestPrunedWeight, influences[kept].weight);
+
+			//What's left has to add up to 1 again, or the vertex shrinks towards the origin of the skeleton
+			keptWeight = 0;
+			for(size_t i { 0 }; i < kept; ++i) keptWeight += influences[i].weight;
+		}
+
+		for(size_t i { 0 }; i < kept; ++i)
+		{
+			mergedJoints[4 * vertex + i]  = influences[i].joint;
+			mergedWeights[4 * vertex + i] = influences[i].weight / keptWeight;
+			largestJoint				  = std::max(largestJoint, influences[i].joint);
+		}
+	}
+
+	if(largestJoint <= 0xFF)
+		replacePart(joints, Ogre::VET_UBYTE4, std::vector<Ogre::uint8>(mergedJoints.begin(), mergedJoints.end()));
+	else
+		replacePart(joints, Ogre::VET_USHORT4, mergedJoints);
+
+	if(quantizeWeights)
+	{
+		std::vector<Ogre::uint8> bytes(mergedWeights.size());
+		for(size_t vertex { 0 }; vertex < vertexCount; ++vertex)
+		{
+			//Rounding each weight can make the sum 1 off in either direction : the largest weight, the first one, takes the difference
+			int sum { 0 };
+			for(size_t i { 0 }; i < 4; ++i)
+			{
+				bytes[4 * vertex + i] = Ogre::uint8(std::lround(mergedWeights[4 * vertex + i] * 255.0f));
+				sum += bytes[4 * vertex + i];
+			}
+			if(sum > 0) bytes[4 * vertex] = Ogre::uint8(std::max(0, std::min(255, int(bytes[4 * vertex]) + 255 - sum)));
+		}
+		replacePart(weights, Ogre::VET_UBYTE4_NORM, bytes);
+	}
+	else
+		replacePart(weights, Ogre::VET_FLOAT4, mergedWeights);
+
+	report.compactBytes = vertexCount * (joints.source.size + weights.source.size);
+	return report;
+}
@@ -0,0 +1,80 @@
+#include "Ogre_glTF_stagedImageFile.hpp"
+#include "Ogre_glTF.hpp"
+
+#include <cstring>
+#include <fstream>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Header at the start of the file
+	struct fileHeader
+	{
+		///Identify the file format
+		char magic[4];
+
+		///Version of the format
+		uint32_t version;
+
+		///Width of the image
+		uint32_t width;
+
+		///Height of the image
+		uint32_t height;
+
+		///Ogre::PixelFormat of the pixels
+		uint32_t format;
+
+		///Number of mipmaps after the full size image
+		uint32_t mipmaps;
+
+		///Number of bytes of pixel data following the header
+		uint64_t pixelBytes;
+	};
+
+	constexpr char magicNumber[4] { 'O', 'G', 'T', 'X' };
+	constexpr uint32_t currentVersion { 2 };
+}
+
+void stagedImageFile::write(const std::string& path, const stagedImage& image)
+{
+	std::ofstream file(path, std::ios_base::binary | std::ios_base::trunc);
+	if(!file) throw FileIOError("Could not open " + path + " for writing");
+
+	fileHeader header {};
+	memcpy(header.magic, magicNumber, sizeof magicNumber);
+	header.version	= currentVersion;
+	header.width	  = image.width;
+	header.height	 = image.height;
+	header.format	 = uint32_t(image.format);
+	header.mipmaps	 = image.mipmaps;
+	header.pixelBytes = image.pixels.size();
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof header);
+	file.write(reinterpret_cast<const char*>(image.pixels.data()), std::streamsize(image.pixels.size()));
+	if(!file) throw FileIOError("Could not write " + path);
+}
+
+stagedImage stagedImageFile::read(const std::string& path)
+{
+	std::ifstream file(path, std::ios_base::binary);
+	if(!file) throw FileIOError("Could not open " + path);
+
+	fileHeader header {};
+	file.read(reinterpret_cast<char*>(&header), sizeof header);
+	if(!file || memcmp(header.magic, magicNumber, sizeof magicNumber) != 0 || header.version != currentVersion)
+		throw FileIOError(path + " is not a staged image file, or has been written by another version");
+
+	stagedImage image;
+	image.width	  = header.width;
+	image.height  = header.height;
+	image.format  = Ogre::PixelFormat(header.format);
+	image.mipmaps = Ogre::uint8(header.mipmaps);
+	image.pixels.resize(size_t(header.pixelBytes));
+
+	file.read(reinterpret_cast<char*>(image.pixels.data()), std::streamsize(image.pixels.size()));
+	if(!file) throw FileIOError("Could not read the pixels of " + path);
+
+	return image;
+}
@@ -1,13 +1,19 @@
 #include "Ogre_glTF_textureImporter.hpp"
 #include "Ogre_glTF_common.hpp"
+#include "Ogre_glTF_imageDecoder.hpp"
+#include "Ogre_glTF_pixelConverter.hpp"
+#include "Ogre_glTF_sharedTextures.hpp"
+#include "Ogre_glTF_mipmapGenerator.hpp"
+#include "Ogre_glTF_threadPool.hpp"
 #include <OgreLogManager.h>
 #include <OgreTextureManager.h>
 #include <OgreTexture.h>
 #include <OgreImage.h>
 #include <OgreHardwarePixelBuffer.h>
-#include <OgreColourValue.h>
 #include <OgreRoot.h>
 #include <OgreRenderTarget.h>
+#include <algorithm>
+#include <exception>
 #include "Ogre_glTF.hpp"
 
 using namespace Ogre_glTF;
@@ -18,12 +24,96 @@ using namespace Ogre_glTF;
 //TODO planned refactoring : Loading of texture via OgreImage needs to be put into it's own method
 //TODO investigate if HardwarePixelBuffer is going to be deprecated. Why is it in the Ogre::v1 namespace? What will happen in Ogre 2.2's "texture refactor"?
 
-size_t textureImporter::id { 0 };
+std::atomic<size_t> textureImporter::id { 0 };
+
+int textureImporter::getImageIndex(int glTFTextureIndex) const { return model.textures[glTFTextureIndex].source; }
+
+bool textureImporter::isShared(int imageIndex) const { return shareTextures && imageHashes.find(imageIndex) != std::end(imageHashes); }
+
+std::string textureImporter::getTextureName(int imageIndex, const std::string& suffix) const
+{
+	if(isShared(imageIndex)) return sharedTextures::getName(imageHashes.at(imageIndex), suffix);
+
+	//The images are not there when everything comes from the cache
+	const auto& imageName = size_t(imageIndex) < model.images.size() ? model.images[imageIndex].name : std::string {};
+	return "glTF_texture_" + imageName + std::to_string(importerId) + std::to_string(imageIndex) + suffix;
+}
+
+std::string textureImporter::getGreyScaleTextureName(int imageIndex, int channel) const
+{
+	return getTextureName(imageIndex, "_greyscale_channel" + std::to_string(channel));
+}
+
+std::string textureImporter::getNormalSNORMTextureName(int imageIndex) const { return getTextureName(imageIndex, "_NormalFixed"); }
+
+std::string textureImporter::getVariantSuffix(textureVariant variant)
+{
+	//Same suffixes as getGreyScaleTextureName and getNormalSNORMTextureName
+	switch(variant)
+	{
+		default:
+		case textureVariant::plain: return "";
+		case textureVariant::metalness: return "_greyscale_channel" + std::to_string(metalnessChannel);
+		case textureVariant::roughness: return "_greyscale_channel" + std::to_string(roughnessChannel);
+		case textureVariant::normalSNORM: return "_NormalFixed";
+	}
+}
+
+std::string textureImporter::getVariantName(int imageIndex, textureVariant variant) const
+{
+	//A shared texture may have been made by an importer that converts images differently
+	auto suffix = getVariantSuffix(variant);
+	if(legacyMetalRough && (variant == textureVariant::metalness || variant == textureVariant::roughness)) suffix += "_legacy";
+	if(twoChannelNormals && variant == textureVariant::normalSNORM) suffix += "_xy";
+	if(generateMipmapChains) suffix += "_mipmaps";
+	return getTextureName(imageIndex, suffix);
+}
+
+template <typename textureUse>
+void textureImporter::forEachMaterialTexture(textureUse use) const
+{
+	for(const auto& material : model.materials)
+	{
+		for(const auto& content : material.values)
+		{
+			const auto textureIndex = content.second.TextureIndex();
+			if(textureIndex < 0) continue;
+			const auto imageIndex = getImageIndex(textureIndex);
+
+			if(content.first == "baseColorTexture") use(imageIndex, textureVariant::plain);
+			if(content.first == "metallicRoughnessTexture")
+			{
+				use(imageIndex, textureVariant::metalness);
+				use(imageIndex, textureVariant::roughness);
+			}
+		}
+
+		for(const auto& content : material.additionalValues)
+		{
+			const auto textureIndex = content.second.TextureIndex();
+			if(textureIndex < 0) continue;
+			const auto imageIndex = getImageIndex(textureIndex);
+
+			if(content.first == "normalTexture") use(imageIndex, textureVariant::normalSNORM);
+			if(content.first == "emissiveTexture") use(imageIndex, textureVariant::plain);
+		}
+	}
+}
+
+Ogre::PixelFormat textureImporter::getPixelFormat(const tinygltf::Image& image, const std::string& name)
+{
+	if(image.component == 3) return Ogre::PF_BYTE_RGB;
+	if(image.component == 4) return Ogre::PF_BYTE_RGBA;
+
+	OgreLog("unrecognized pixel format from tinygltf image");
+	throw InitError("Can get " + name + "pixel format");
+}
+
 void textureImporter::loadTexture(const tinygltf::Texture& texture)
 {
 	auto textureManager = Ogre::TextureManager::getSingletonPtr();
 	const auto& image   = model.images[texture.source];
-	const auto name		= "glTF_texture_" + image.name + std::to_string(id) + std::to_string(texture.source);
+	const auto name		= getVariantName(texture.source, textureVariant::plain);
 
 	auto OgreTexture = textureManager->getByName(name);
 	if(OgreTexture)
@@ -32,16 +122,19 @@ void textureImporter::loadTexture(const tinygltf::Texture& texture)
 		return;
 	}
 
-	OgreLog("Loading texture image " + name);
+	//The chain is built from a staged copy of the image, that is uploaded with its mipmaps like the other textures
+	if(generateMipmapChains)
+	{
+		loadedTextures.insert({ texture.source, getVariantTexture(texture.source, textureVariant::plain) });
+		return;
+	}
 
-	const auto pixelFormat = [&] {
-		if(image.component == 3) return Ogre::PF_BYTE_RGB;
-		if(image.component == 4) return Ogre::PF_BYTE_RGBA;
+	OgreLog("Loading texture image " + name);
 
-		throw InitError("Can get " + name + "pixel format");
-	}();
+	decodeImage(texture.source);
+	const auto pixelFormat = getPixelFormat(image, name);
 
-	if(image.image.size() / image.component == image.width * image.height) { OgreLog("It looks like the image.component field and the image size does match"); }
+	if(getPixels(texture.source).size() / image.component == image.width * image.height) { OgreLog("It looks like the image.component field and the image size does match"); }
 	else
 	{
 		OgreLog("I have no idea what is going on with the image format");
@@ -51,10 +144,10 @@ void textureImporter::loadTexture(const tinygltf::Texture& texture)
 
 	//The OgreImage class *can* take ownership of the pointer to the data and automatically delete it.
 	//We *don't* want that. 6th argument needs to be set to false to prevent that.
-	//The rest of the funciton is not modifying the model.images[x].image object. We get the image as a const ref.
+	//The rest of the funciton is not modifying the pixels of the image. We get them as a const ref.
 	//In order to keep the rest of this code const correct, and knowing that the "autoDelete" is specifically
 	//set to `false`, we're casting away const on the pointer to get the image data.
-	OgreImage.loadDynamicImage(const_cast<Ogre::uchar*>(image.image.data()), image.width, image.height, 1, pixelFormat, false);
+	OgreImage.loadDynamicImage(const_cast<Ogre::uchar*>(getPixels(texture.source).data()), image.width, image.height, 1, pixelFormat, false);
 
 	OgreTexture = textureManager->createManual(name,
 											   Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
@@ -70,9 +163,63 @@ void textureImporter::loadTexture(const tinygltf::Texture& texture)
 
 	OgreTexture->loadImage(OgreImage);
 
+	textureCreated(texture.source, OgreTexture);
 	loadedTextures.insert({ texture.source, OgreTexture });
 }
 
+void textureImporter::decodeImage(int imageIndex) const
+{
+	auto& image = model.images[imageIndex];
+	if(!image.image.empty() || sharedImagePixels.find(imageIndex) != std::end(sharedImagePixels)) return;
+
+	const auto encoded = encodedImages.find(imageIndex);
+	if(encoded == std::end(encodedImages)) return;
+
+	OgreLog("Decoding image " + std::to_string(imageIndex) + " on demand");
+	auto decoded = imageDecoder::decode(encoded->second);
+	if(!decoded.error.empty()) throw LoadingError("Could not decode image " + std::to_string(imageIndex) + " : " + decoded.error);
+
+	image.width		= decoded.width;
+	image.height	= decoded.height;
+	image.component = decoded.component;
+	image.image		= std::move(decoded.pixels);
+}
+
+const std::vector<unsigned char>& textureImporter::getPixels(int imageIndex) const
+{
+	const auto shared = sharedImagePixels.find(imageIndex);
+	return shared != std::end(sharedImagePixels) ? *shared->second : model.images[imageIndex].image;
+}
+
+void textureImporter::textureCreated(int imageIndex, const Ogre::TexturePtr& texture)
+{
+	const auto& name = texture->getName();
+	createdTextures.insert(name);
+	if(isShared(imageIndex)) sharedTextures::add(texture, imageHashes.at(imageIndex));
+
+	if(!decodeOnDemand) return;
+
+	//Actually give the memory back, clear() alone would keep the capacity
+	std::vector<unsigned char>().swap(model.images[imageIndex].image);
+
+	//Keep the encoded file of an image we didn't expect to be used, it may be asked again
+	auto pending = pendingTextures.find(imageIndex);
+	if(pending == std::end(pendingTextures)) return;
+
+	pending->second.erase(name);
+	if(!pending->second.empty()) return;
+
+	//Every texture made from this image is on the GPU now
+	OgreLog("Releasing image " + std::to_string(imageIndex));
+	pendingTextures.erase(pending);
+	encodedImages.erase(imageIndex);
+}
+
+bool textureImporter::isTextureCreated(const std::string& name) const
+{
+	return createdTextures.find(name) != std::end(createdTextures) || sharedTextures::contains(name);
+}
+
 bool textureImporter::isHardwareGammaEnabled() const
 {
 	const auto renderSystem = Ogre::Root::getSingleton().getRenderSystem();
@@ -90,59 +237,224 @@ bool textureImporter::isHardwareGammaEnabled() const
 				"anyway");
 	}
 
-	//Check if any render target has the option, and if so, return true
+	//Check if any render target has the option, and if so, return true. There may be no render target at all (e.g. NULL render system)
 	auto renderTargetIt = renderSystem->getRenderTargetIterator();
-	do
+	while(renderTargetIt.hasMoreElements())
 	{
-		if(renderTargetIt.current()->second->isHardwareGammaEnabled()) return true;
-
-		renderTargetIt.moveNext();
-	} while(renderTargetIt.current() != renderTargetIt.end());
+		if(renderTargetIt.getNext()->isHardwareGammaEnabled()) return true;
+	}
 
 	return false;
 }
 
-textureImporter::textureImporter(tinygltf::Model& input) : model { input } { id++; }
+textureImporter::textureImporter(tinygltf::Model& input) : importerId { id++ }, model { input } {}
+
+void textureImporter::prepareTextures(threadPool* workers)
+{
+	//Converting the pixels in advance would mean decoding everything now
+	if(decodeOnDemand) return;
+
+	//Do the conversions the materials are going to ask for. Plain textures are uploaded straight from the model, unless they need mipmaps
+	forEachMaterialTexture([this](int imageIndex, textureVariant variant) {
+		if(variant == textureVariant::plain && !generateMipmapChains) return;
+		const auto name = getVariantName(imageIndex, variant);
+		if(stagedImages.find(name) != std::end(stagedImages) || isTextureCreated(name)) return;
+
+		if(isStagedInPairs(variant))
+			stageMetalRoughPair(imageIndex);
+		else
+			stagedImages[name] = stageVariant(imageIndex, variant);
+	});
+
+	if(!generateMipmapChains) return;
+
+	//The textures don't depend on each other : each chain is a task of its own
+	std::vector<std::pair<stagedImage*, mipmapFilter>> chains;
+	std::unordered_set<const stagedImage*> listed;
+	forEachMaterialTexture([&](int imageIndex, textureVariant variant) {
+		auto staged = stagedImages.find(getVariantName(imageIndex, variant));
+		if(staged == std::end(stagedImages) || staged->second.mipmaps != 0 || !listed.insert(&staged->second).second) return;
+		chains.emplace_back(&staged->second, getMipmapFilter(variant));
+	});
+
+	if(!workers)
+	{
+		for(const auto& chain : chains) generateMipmaps(*chain.first, chain.second);
+		return;
+	}
+
+	std::vector<std::future<void>> tasks;
+	tasks.reserve(chains.size());
+	for(const auto& chain : chains) tasks.push_back(workers->submit([chain] { generateMipmaps(*chain.first, chain.second); }));
+
+	//Wait for all of them, even after a failure : the tasks write into the staged images
+	std::exception_ptr failure;
+	for(auto& task : tasks)
+	{
+		try
+		{
+			workers->get(task);
+		}
+		catch(...)
+		{
+			if(!failure) failure = std::current_exception();
+		}
+	}
+	if(failure) std::rethrow_exception(failure);
+}
+
+void textureImporter::setLegacyMetalRough(bool enabled) { legacyMetalRough = enabled; }
+
+void textureImporter::setTwoChannelNormals(bool enabled) { twoChannelNormals = enabled; }
+
+void textureImporter::setTextureSharing(bool enabled) { shareTextures = enabled; }
+
+void textureImporter::setMipmapGeneration(bool enabled) { generateMipmapChains = enabled; }
+
+void textureImporter::setImageHashes(std::unordered_map<int, uint64_t> hashes) { imageHashes = std::move(hashes); }
+
+void textureImporter::addSkippedImages(std::unordered_map<int, std::vector<unsigned char>> images)
+{
+	for(auto& image : images) encodedImages[image.first] = std::move(image.second);
+}
+
+void textureImporter::addSharedPixels(std::unordered_map<int, imageDecoder::sharedPixels> pixels)
+{
+	for(auto& image : pixels) sharedImagePixels[image.first] = std::move(image.second);
+}
+
+bool textureImporter::isStagedInPairs(textureVariant variant) const
+{
+	return !legacyMetalRough && (variant == textureVariant::metalness || variant == textureVariant::roughness);
+}
+
+void textureImporter::stageMetalRoughPair(int imageIndex)
+{
+	const auto metalnessName = getVariantName(imageIndex, textureVariant::metalness);
+	const auto roughnessName = getVariantName(imageIndex, textureVariant::roughness);
+	const auto needed		 = [&](const std::string& name) { return stagedImages.find(name) == std::end(stagedImages) && !isTextureCreated(name); };
+	const auto needMetalness = needed(metalnessName), needRoughness = needed(roughnessName);
+	if(!needMetalness && !needRoughness) return;
+
+	auto images = stageMetalRough(imageIndex);
+	if(needMetalness) stagedImages[metalnessName] = std::move(images.first);
+	if(needRoughness) stagedImages[roughnessName] = std::move(images.second);
+}
 
 void textureImporter::loadTextures()
 {
+	if(decodeOnDemand) return;
+
 	for(const auto& texture : model.textures) { loadTexture(texture); }
 }
 
-Ogre::TexturePtr textureImporter::getTexture(int glTFTextureSourceID)
+void textureImporter::setEncodedImages(std::unordered_map<int, std::vector<unsigned char>> images)
 {
-	auto texture = loadedTextures.find(glTFTextureSourceID);
-	if(texture == std::end(loadedTextures)) return {};
+	decodeOnDemand = true;
+	encodedImages  = std::move(images);
 
-	return texture->second;
+	//List the textures the materials are going to ask for
+	forEachMaterialTexture(
+		[this](int imageIndex, textureVariant variant) { pendingTextures[imageIndex].insert(getVariantName(imageIndex, variant)); });
 }
 
-Ogre::TexturePtr textureImporter::generateGreyScaleFromChannel(int gltfTextureSourceID, int channel)
+std::vector<stagedTexture> textureImporter::stageAll() const
 {
-	auto textureManager = Ogre::TextureManager::getSingletonPtr();
-	const auto& image   = model.images[gltfTextureSourceID];
+	std::vector<stagedTexture> output;
+	std::unordered_set<std::string> done;
+
+	forEachMaterialTexture([&](int imageIndex, textureVariant variant) {
+		if(!done.insert(getVariantName(imageIndex, variant)).second) return;
+		if(isStagedInPairs(variant))
+		{
+			done.insert(getVariantName(imageIndex, textureVariant::metalness));
+			done.insert(getVariantName(imageIndex, textureVariant::roughness));
+			auto images = stageMetalRough(imageIndex);
+			output.push_back({ imageIndex, textureVariant::metalness, std::move(images.first) });
+			output.push_back({ imageIndex, textureVariant::roughness, std::move(images.second) });
+			return;
+		}
+		output.push_back({ imageIndex, variant, stageVariant(imageIndex, variant) });
+	});
+
+	for(auto& texture : output)
+	{
+		const auto hash = imageHashes.find(texture.imageIndex);
+		if(hash != std::end(imageHashes)) texture.imageHash = hash->second;
+		if(generateMipmapChains) generateMipmaps(texture.image, getMipmapFilter(texture.variant));
+	}
 
-	assert(channel < 4 && channel >= 0 /*, "Channel needs to be between 0 and 3"*/);
-	const auto name = "glTF_texture_" + image.name + std::to_string(id) + std::to_string(gltfTextureSourceID) + "_greyscale_channel" + std::to_string(channel);
+	return output;
+}
 
-	auto texture = textureManager->getByName(name);
-	if(texture)
+void textureImporter::addStagedTextures(std::vector<stagedTexture> textures)
+{
+	for(auto& texture : textures)
 	{
-		//OgreLog("texture " + name + "Already loaded in Ogre::TextureManager");
-		return texture;
+		//Textures read from the cache are shared too, the model has no image to hash then
+		if(texture.imageHash != 0) imageHashes.emplace(texture.imageIndex, texture.imageHash);
+		stagedImages[getVariantName(texture.imageIndex, texture.variant)] = std::move(texture.image);
 	}
+}
 
-	OgreLog("Can't find texure " + name + ". Generating it from glTF");
+template <typename stagingFunction>
+stagedImage textureImporter::takeStagedImage(const std::string& name, stagingFunction stage)
+{
+	auto staged = stagedImages.find(name);
+	if(staged == std::end(stagedImages)) return stage();
 
+	//This is only uploaded once, no need to keep it around after that
+	auto image = std::move(staged->second);
+	stagedImages.erase(staged);
+	return image;
+}
+
+Ogre::TexturePtr textureImporter::createTexture(const std::string& name, const stagedImage& image) const
+{
+	//TU_DEFAULT includes TU_AUTOMIPMAP : a texture that comes with its chain is static, the render system has nothing to generate. A
+	//texture without a chain is still created with one mipmap, as it always has been, and only gets its full size image
+	auto OgreTexture = Ogre::TextureManager::getSingleton().createManual(name,
+																		 Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+																		 Ogre::TextureType::TEX_TYPE_2D_ARRAY,
+																		 image.width,
+																		 image.height,
+																		 1,
+																		 image.mipmaps > 0 ? image.mipmaps : 1,
+																		 image.format,
+																		 image.mipmaps > 0 ? Ogre::TU_STATIC_WRITE_ONLY : Ogre::TU_DEFAULT,
+																		 nullptr,
+																		 isHardwareGammaEnabled());
+
+	//Every level is uploaded by one call. Like in loadTexture, the image doesn't take ownership of the pixels, and is only read from
+	Ogre::Image OgreImage;
+	OgreImage.loadDynamicImage(const_cast<Ogre::uchar*>(image.pixels.data()), image.width, image.height, 1, image.format, false, 1, image.mipmaps);
+	OgreTexture->loadImage(OgreImage);
+
+	return OgreTexture;
+}
+
+stagedImage textureImporter::stageGreyScale(int imageIndex, int channel) const
+{
+	decodeImage(imageIndex);
+	const auto& image = model.images[imageIndex];
+
+	assert(channel < 4 && channel >= 0 /*, "Channel needs to be between 0 and 3"*/);
 	assert(channel < image.component);
 
+	stagedImage output;
+	output.width  = Ogre::uint32(image.width);
+	output.height = Ogre::uint32(image.height);
+	output.format = getPixelFormat(image, getGreyScaleTextureName(imageIndex, channel));
+
 	//Greyscale the image by putting all channel to the same value, ignoring alpha
-	std::vector<Ogre::uchar> imageData(image.image.size());
+	auto& imageData = output.pixels;
+	const auto& pixels = getPixels(imageIndex);
+	imageData.resize(pixels.size());
 	const auto pixelCount { imageData.size() / image.component };
 	for(size_t i { 0 }; i < pixelCount; i++) //for each pixel
 	{
 		//Get the channel that has the value
-		Ogre::uchar grey = image.image[(i * image.component) + channel];
+		Ogre::uchar grey = pixels[(i * image.component) + channel];
 
 		//Turn pixel at this specific shade of grey
 		for(size_t c { 0 }; c < 3; c++) imageData[i * image.component + c] = grey;
@@ -151,46 +463,101 @@ Ogre::TexturePtr textureImporter::generateGreyScaleFromChannel(int gltfTextureSo
 		if(image.component > 3) imageData[i * image.component + 3] = 255;
 	}
 
-	const auto pixelFormat = [&] {
-		if(image.component == 3) return Ogre::PF_BYTE_RGB;
-		if(image.component == 4) return Ogre::PF_BYTE_RGBA;
+	return output;
+}
+
+std::pair<stagedImage, stagedImage> textureImporter::stageMetalRough(int imageIndex) const
+{
+	decodeImage(imageIndex);
+	const auto& image = model.images[imageIndex];
+	if(image.component < 3) throw InitError("Can get " + getVariantName(imageIndex, textureVariant::metalness) + "pixel format");
+
+	//Hlms reads metalness and roughness from the first channel of their texture : a single channel texture is all it needs
+	std::pair<stagedImage, stagedImage> output;
+	for(auto single : { &output.first, &output.second })
+	{
+		single->width  = Ogre::uint32(image.width);
+		single->height = Ogre::uint32(image.height);
+		single->format = Ogre::PF_L8;
+		single->pixels.resize(size_t(image.width) * size_t(image.height));
+	}
+
+	splitChannels(getPixels(imageIndex).data(),
+				  output.first.pixels.size(),
+				  size_t(image.component),
+				  metalnessChannel,
+				  roughnessChannel,
+				  output.first.pixels.data(),
+				  output.second.pixels.data());
+	return output;
+}
 
-		OgreLog("unrecognized pixel format from tinygltf image");
+stagedImage textureImporter::stageNormalSNORM(int imageIndex) const
+{
+	decodeImage(imageIndex);
+	const auto& image = model.images[imageIndex];
+	const auto name   = getNormalSNORMTextureName(imageIndex);
+
+	stagedImage output;
+	output.width  = Ogre::uint32(image.width);
+	output.height = Ogre::uint32(image.height);
+	output.format = [&] {
+		if(twoChannelNormals && (image.component == 3 || image.component == 4)) return Ogre::PF_R8G8_SNORM;
+		if(image.component == 3) return Ogre::PF_R8G8B8_SNORM;
+		if(image.component == 4) return Ogre::PF_R8G8B8A8_SNORM;
 		throw InitError("Can get " + name + "pixel format");
 	}();
 
-	Ogre::Image OgreImage;
-	Ogre::TexturePtr OgreTexture;
+	//Each channel goes from [0, 255] to [-127, 127] in memory order. With two channels, Hlms computes z from x and y
+	const auto pixelCount = size_t(image.width) * size_t(image.height);
+	output.pixels.resize(Ogre::PixelUtil::getNumElemBytes(output.format) * pixelCount);
+	convertNormalsToSNORM(getPixels(imageIndex).data(), pixelCount, size_t(image.component), twoChannelNormals, reinterpret_cast<Ogre::int8*>(output.pixels.data()));
 
-	//TODO refactor this
+	return output;
+}
 
-	//The OgreImage class *can* take ownership of the pointer to the data and automatically delete it.
-	//We *don't* want that. 6th argument needs to be set to false to prevent that.
-	//The rest of the funciton is not modifying the model.images[x].image object. We get the image as a const ref.
-	//In order to keep the rest of this code const correct, and knowing that the "autoDelete" is specifically
-	//set to `false`, we're casting away const on the pointer to get the image data.
-	OgreImage.loadDynamicImage(imageData.data(), image.width, image.height, 1, pixelFormat, false);
+stagedImage textureImporter::stagePlain(int imageIndex) const
+{
+	decodeImage(imageIndex);
+	const auto& image = model.images[imageIndex];
 
-	OgreTexture = textureManager->createManual(name,
-											   Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-											   Ogre::TextureType::TEX_TYPE_2D_ARRAY,
-											   image.width,
-											   image.height,
-											   1,
-											   1,
-											   pixelFormat,
-											   Ogre::TU_DEFAULT,
-											   nullptr,
-											   isHardwareGammaEnabled());
-	OgreTexture->loadImage(OgreImage);
-	return OgreTexture;
+	stagedImage output;
+	output.width  = Ogre::uint32(image.width);
+	output.height = Ogre::uint32(image.height);
+	output.format = getPixelFormat(image, getTextureName(imageIndex));
+	output.pixels = getPixels(imageIndex);
+
+	return output;
 }
 
-Ogre::TexturePtr textureImporter::getNormalSNORM(int gltfTextureSourceID)
+mipmapFilter textureImporter::getMipmapFilter(textureVariant variant)
+{
+	switch(variant)
+	{
+		default:
+		case textureVariant::plain: return mipmapFilter::sRGB;
+		case textureVariant::metalness:
+		case textureVariant::roughness: return mipmapFilter::linear;
+		case textureVariant::normalSNORM: return mipmapFilter::normal;
+	}
+}
+
+stagedImage textureImporter::stageVariant(int imageIndex, textureVariant variant) const
+{
+	switch(variant)
+	{
+		default:
+		case textureVariant::plain: return stagePlain(imageIndex);
+		case textureVariant::metalness: return legacyMetalRough ? stageGreyScale(imageIndex, metalnessChannel) : stageMetalRough(imageIndex).first;
+		case textureVariant::roughness: return legacyMetalRough ? stageGreyScale(imageIndex, roughnessChannel) : stageMetalRough(imageIndex).second;
+		case textureVariant::normalSNORM: return stageNormalSNORM(imageIndex);
+	}
+}
+
+Ogre::TexturePtr textureImporter::getVariantTexture(int imageIndex, textureVariant variant)
 {
 	auto textureManager = Ogre::TextureManager::getSingletonPtr();
-	const auto& image   = model.images[gltfTextureSourceID];
-	const auto name		= "glTF_texture_" + image.name + std::to_string(id) + std::to_string(gltfTextureSourceID) + "_NormalFixed";
+	const auto name		= getVariantName(imageIndex, variant);
 
 	auto texture = textureManager->getByName(name);
 	if(texture)
@@ -201,46 +568,12 @@ Ogre::TexturePtr textureImporter::getNormalSNORM(int gltfTextureSourceID)
 
 	OgreLog("Can't find texure " + name + ". Generating it from glTF");
 
-	const auto pixelFormat = [&] {
-		if(image.component == 3) return Ogre::PF_BYTE_RGB;
-		if(image.component == 4) return Ogre::PF_BYTE_RGBA;
+	//The metalness and roughness textures are made together : the one that isn't asked for yet waits in the staged images
+	if(isStagedInPairs(variant)) stageMetalRoughPair(imageIndex);
 
-		OgreLog("unrecognized pixel format from tinygltf image");
-		throw InitError("Can get " + name + "pixel format");
-	}();
-
-	const auto pixelFormatSnorm = [&] {
-		if(image.component == 3) return Ogre::PF_R8G8B8_SNORM;
-		if(image.component == 4) return Ogre::PF_R8G8B8A8_SNORM;
-		throw InitError("Can get " + name + "pixel format");
-	}();
-
-	Ogre::TexturePtr OgreTexture = textureManager->createManual(name,
-																Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-																Ogre::TextureType::TEX_TYPE_2D_ARRAY,
-																image.width,
-																image.height,
-																1,
-																1,
-																pixelFormatSnorm,
-																Ogre::TU_DEFAULT,
-																nullptr,
-																isHardwareGammaEnabled());
-
-	auto pixels = OgreTexture->getBuffer()->lock({ 0, 0, unsigned(image.width), unsigned(image.height) }, //PixelBox that take the whole image
-												 Ogre::v1::HardwareBuffer::LockOptions::HBL_NORMAL);
-	//This loop convert BGR to RGB image data while also putting the value in the SNORM range [-1.0; +1.0]
-	for(size_t y { 0 }; y < image.height; y++)
-		for(size_t x { 0 }; x < image.width; x++)
-			pixels.setColourAt(Ogre::ColourValue(2.0f * (float(image.image[image.component * (y * image.width + x) + 2]) / 255.0f) - 1.0f, //R to B
-												 2.0f * (float(image.image[image.component * (y * image.width + x) + 1]) / 255.0f) - 1.0f, //G to G
-												 2.0f * (float(image.image[image.component * (y * image.width + x) + 0]) / 255.0f) - 1.0f, //B to R
-												 1.0f),
-							   x,
-							   y,
-							   0);
-
-	OgreTexture->getBuffer()->unlock();
-
-	return OgreTexture;
+	auto image = takeStagedImage(name, [&] { return stageVariant(imageIndex, variant); });
+	if(generateMipmapChains) generateMipmaps(image, getMipmapFilter(variant));
+	texture = createTexture(name, image);
+	textureCreated(imageIndex, texture);
+	return texture;
 }
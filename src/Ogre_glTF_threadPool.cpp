@@ -0,0 +1,118 @@
+#include "Ogre_glTF_threadPool.hpp"
+#include "Ogre_glTF_common.hpp"
+#include <algorithm>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Pool the calling thread is a worker of, if any
+	thread_local const threadPool* currentPool = nullptr;
+
+	///Index of the calling thread in its pool
+	thread_local size_t currentIndex = 0;
+}
+
+threadPool::threadPool(size_t threadCount)
+{
+	if(threadCount == 0) threadCount = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+	queues.reserve(threadCount);
+	for(size_t i { 0 }; i < threadCount; ++i) queues.emplace_back(std::make_unique<workQueue>());
+
+	workers.reserve(threadCount);
+	for(size_t i { 0 }; i < threadCount; ++i) workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+threadPool::~threadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	tasksAvailable.notify_all();
+
+	for(auto& worker : workers) worker.join();
+}
+
+size_t threadPool::size() const { return workers.size(); }
+
+size_t threadPool::currentQueue() const { return currentPool == this ? currentIndex : queues.size(); }
+
+void threadPool::push(std::function<void()> task)
+{
+	//Keep work spawned by a task on the same worker, spread the rest
+	auto index = currentQueue();
+	if(index == queues.size()) index = nextQueue++ % queues.size();
+
+	//Counted before being visible, so a thief can't take it before it's accounted for
+	pendingTasks++;
+	{
+		auto& queue = *queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+
+	//Taking the lock makes sure a worker can't miss the notification between checking the counter and going to sleep
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	tasksAvailable.notify_one();
+}
+
+bool threadPool::runPendingTask()
+{
+	std::function<void()> task;
+	const auto start = currentQueue();
+
+	//Own queue first, most recent task first as its data is probably still in cache
+	if(start != queues.size())
+	{
+		auto& queue = *queues[start];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+	}
+
+	//Then steal the oldest task of the other queues
+	for(size_t i { 1 }; !task && i <= queues.size(); ++i)
+	{
+		auto& queue = *queues[(start + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(!queue.tasks.empty())
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+	}
+
+	if(!task) return false;
+
+	pendingTasks--;
+
+	//The calling thread can be waiting in get() from a task that captures its messages : this one is unrelated to it, and doesn't log
+	//into that capture. Exceptions are caught by the packaged task and forwarded to the future
+	logCaptureSuspension suspension;
+	task();
+	return true;
+}
+
+void threadPool::workerLoop(size_t index)
+{
+	currentPool  = this;
+	currentIndex = index;
+
+	for(;;)
+	{
+		if(runPendingTask()) continue;
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		tasksAvailable.wait(lock, [this] { return stopping || pendingTasks > 0; });
+
+		//Finish what has been queued before quitting
+		if(stopping && pendingTasks == 0) return;
+	}
+}
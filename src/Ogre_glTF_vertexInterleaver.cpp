@@ -0,0 +1,114 @@
+#include "Ogre_glTF_vertexInterleaver.hpp"
+
+#include <array>
+#include <cstring>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Copy an attribute with fixed size copies of 8 or 16 bytes, that compilers turn into a single load and store of a register. This
+	///reads and writes up to 4 bytes past the attribute : the reads stay inside the next vertex of the source, and the writes are
+	///overwritten by the next attribute (or the next vertex)
+	template <size_t size, bool moreThanOneRegister = (size > 16)>
+	struct wideCopy
+	{
+		static void copy(unsigned char* destination, const unsigned char* source)
+		{
+			memcpy(destination, source, 16);
+			wideCopy<size - 16>::copy(destination + 16, source + 16);
+		}
+	};
+
+	template <size_t size>
+	struct wideCopy<size, false>
+	{
+		static void copy(unsigned char* destination, const unsigned char* source)
+		{
+			if(size > 8)
+				memcpy(destination, source, 16);
+			else if(size > 0)
+				memcpy(destination, source, 8);
+		}
+	};
+
+	///Used to expand a function call over a parameter pack
+	using expand = int[];
+
+	///Interleave vertices whose attribute sizes are known at compile time
+	template <size_t... sizes>
+	void interleaveLayout(const std::vector<vertexSource>& sources, unsigned char* destination, size_t vertexCount)
+	{
+		constexpr size_t attributeCount = sizeof...(sizes);
+		std::array<const unsigned char*, attributeCount> read {};
+		std::array<size_t, attributeCount> strides {};
+		for(size_t i { 0 }; i < attributeCount; ++i)
+		{
+			read[i]	= sources[i].address;
+			strides[i] = sources[i].stride;
+		}
+
+		if(vertexCount == 0) return;
+
+		for(size_t vertexIndex { 0 }; vertexIndex + 1 < vertexCount; ++vertexIndex)
+		{
+			size_t i { 0 };
+			(void)expand { 0, (wideCopy<sizes>::copy(destination, read[i]), destination += sizes, read[i] += strides[i], ++i, 0)... };
+		}
+
+		//The wide copies would go past the end of the buffers on the last vertex
+		size_t i { 0 };
+		(void)expand { 0, (memcpy(destination, read[i], sizes), destination += sizes, ++i, 0)... };
+	}
+
+	///Use the kernel for a layout if the attribute sizes match it
+	/// \return false if the sources have another layout
+	template <size_t... sizes>
+	bool tryLayout(const std::vector<vertexSource>& sources, unsigned char* destination, size_t vertexCount)
+	{
+		const size_t layout[] { sizes... };
+		if(sources.size() != sizeof...(sizes)) return false;
+		for(size_t i { 0 }; i < sources.size(); ++i)
+			if(sources[i].size != layout[i]) return false;
+
+		interleaveLayout<sizes...>(sources, destination, vertexCount);
+		return true;
+	}
+
+	///Interleave vertices of any layout
+	void interleaveGeneric(const std::vector<vertexSource>& sources, unsigned char* destination, size_t vertexCount)
+	{
+		for(size_t vertexIndex { 0 }; vertexIndex < vertexCount; ++vertexIndex)
+		{
+			for(const auto& source : sources)
+			{
+				memcpy(destination, source.address + vertexIndex * source.stride, source.size);
+				destination += source.size;
+			}
+		}
+	}
+}
+
+void Ogre_glTF::interleaveVertices(const std::vector<vertexSource>& sources, unsigned char* destination, size_t vertexCount)
+{
+	//A single tightly packed attribute is already interleaved
+	if(sources.size() == 1 && sources.front().stride == sources.front().size)
+	{
+		memcpy(destination, sources.front().address, vertexCount * sources.front().size);
+		return;
+	}
+
+	//glTF attributes are sorted by name : JOINTS_0, NORMAL, POSITION, TANGENT, TEXCOORD_0, WEIGHTS_0. Skins are compacted first :
+	//joints are on bytes for skeletons of 256 bones or less, and weights are floats, or bytes once quantized
+	if(tryLayout<12, 12, 8>(sources, destination, vertexCount)) return;				  //normal, position, uv
+	if(tryLayout<12, 12, 16, 8>(sources, destination, vertexCount)) return;			  //normal, position, tangent, uv
+	if(tryLayout<4, 12, 12, 8, 16>(sources, destination, vertexCount)) return;		  //joints, normal, position, uv, weights
+	if(tryLayout<4, 12, 12, 16, 8, 16>(sources, destination, vertexCount)) return;	//joints, normal, position, tangent, uv, weights
+	if(tryLayout<12, 12>(sources, destination, vertexCount)) return;				  //normal, position
+
+	//Same layouts once quantized : QTangent, half float position and texture coordinates
+	if(tryLayout<8, 8, 4>(sources, destination, vertexCount)) return;		//qtangent, position, uv
+	if(tryLayout<4, 8, 8, 4, 4>(sources, destination, vertexCount)) return; //joints, qtangent, position, uv, weights
+
+	interleaveGeneric(sources, destination, vertexCount);
+}
@@ -0,0 +1,117 @@
+#include "Ogre_glTF_vertexPool.hpp"
+#include "Ogre_glTF_indexConverter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Check if the vertices of two primitives have the same layout
+	bool sameVertexFormat(const primitiveData& a, const primitiveData& b)
+	{
+		return std::equal(a.vertexElements.begin(),
+						  a.vertexElements.end(),
+						  b.vertexElements.begin(),
+						  b.vertexElements.end(),
+						  [](const Ogre::VertexElement2& x, const Ogre::VertexElement2& y) { return x.mType == y.mType && x.mSemantic == y.mSemantic; });
+	}
+
+	///Check if the vertices of a primitive can be moved to a pool
+	/// \param primitive the primitive, with all the indices of its levels inside its vertices
+	bool canBePooled(const primitiveData& primitive)
+	{
+		if(primitive.vertexCount == 0 || primitive.indexCount == 0) return false;
+
+		for(size_t level { 0 }; level <= primitive.lodIndices.size(); ++level)
+		{
+			const auto indices = primitive.readIndices(level);
+			if(std::any_of(indices.begin(), indices.end(), [&](Ogre::uint32 index) { return index >= primitive.vertexCount; })) return false;
+		}
+		return true;
+	}
+
+	///Put the vertices of several primitives one after the other in a buffer they all draw from
+	/// \param members the primitives, that all have the same vertex format and index type
+	void pool(const std::vector<primitiveData*>& members)
+	{
+		size_t bytes { 0 }, vertexCount { 0 };
+		for(const auto member : members)
+		{
+			bytes += member->vertices->size();
+			vertexCount += member->vertexCount;
+		}
+
+		auto vertices = std::make_shared<geometryBuffer<unsigned char>>(bytes);
+		size_t byteOffset { 0 };
+		Ogre::uint32 vertexOffset { 0 };
+		for(const auto member : members)
+		{
+			memcpy(vertices->data() + byteOffset, member->vertices->data(), member->vertices->size());
+			byteOffset += member->vertices->size();
+
+			const auto moveIndices = [&](size_t level) {
+				auto indices = member->readIndices(level);
+				for(auto& index : indices) index += vertexOffset;
+				return member->makeIndexBuffer(indices);
+			};
+			for(size_t level { 1 }; level <= member->lodIndices.size(); ++level) member->lodIndices[level - 1] = moveIndices(level);
+			member->indices = moveIndices(0);
+			for(auto& assignment : member->boneAssignments) assignment.vertexIndex += vertexOffset;
+
+			vertexOffset += Ogre::uint32(member->vertexCount);
+		}
+
+		for(const auto member : members)
+		{
+			member->vertices	= vertices;
+			member->vertexCount = vertexCount;
+		}
+	}
+}
+
+size_t Ogre_glTF::poolVertices(std::vector<primitiveData>& primitives)
+{
+	//Primitives that already share their vertices are uploaded once : copying them to a pool would only duplicate them
+	std::unordered_map<const geometryBuffer<unsigned char>*, size_t> users;
+	for(const auto& primitive : primitives) ++users[primitive.vertices.get()];
+
+	//Primitives of each pool, and the number of vertices they add up to
+	struct group
+	{
+		std::vector<primitiveData*> members;
+		size_t vertexCount;
+	};
+	std::vector<group> groups;
+
+	const auto accepts = [&](const group& candidate, const primitiveData& primitive) {
+		const auto& first = *candidate.members.front();
+		const auto fits	  = first.indexType == Ogre::IndexBufferPacked::IT_32BIT || candidate.vertexCount + primitive.vertexCount <= size_t(largest16BitIndex) + 1;
+		return fits && first.indexType == primitive.indexType && sameVertexFormat(first, primitive);
+	};
+
+	for(auto& primitive : primitives)
+	{
+		if(users[primitive.vertices.get()] > 1 || !canBePooled(primitive)) continue;
+
+		const auto found = std::find_if(groups.begin(), groups.end(), [&](const group& candidate) { return accepts(candidate, primitive); });
+		if(found != groups.end())
+		{
+			found->members.push_back(&primitive);
+			found->vertexCount += primitive.vertexCount;
+		}
+		else
+			groups.push_back({ { &primitive }, primitive.vertexCount });
+	}
+
+	size_t pools { 0 };
+	for(const auto& candidate : groups)
+	{
+		if(candidate.members.size() < 2) continue;
+		pool(candidate.members);
+		++pools;
+	}
+	return pools;
+}
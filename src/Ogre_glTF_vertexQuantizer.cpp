@@ -0,0 +1,204 @@
+#include "Ogre_glTF_vertexQuantizer.hpp"
+#include "Ogre_glTF_common.hpp"
+
+#include <OgreBitwise.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+using namespace Ogre_glTF;
+
+namespace
+{
+	///Make a part that reads from its own, tightly packed, storage
+	template <typename T>
+	vertexBufferPart makePart(const vertexBufferPart& original, Ogre::VertexElementType type, size_t perVertex, std::unique_ptr<geometryBuffer<T>> storage)
+	{
+		const auto size = perVertex * sizeof(T);
+		vertexBufferPart part { { storage->dataAddress(), size, size }, type, original.semantic, original.vertexCount, perVertex };
+		part.storage = std::move(storage);
+		return part;
+	}
+
+	///Convert a float in [-1, 1] to a 16 bit signed normalized integer
+	Ogre::int16 toSnorm16(float value) { return Ogre::int16(std::round(Ogre::Math::Clamp(value, -1.0f, 1.0f) * 32767.0f)); }
+}
+
+constexpr float vertexQuantizer::positionTolerance;
+constexpr float vertexQuantizer::texCoordTolerance;
+
+void quantizationReport::merge(const quantizationReport& other)
+{
+	originalBytes += other.originalBytes;
+	quantizedBytes += other.quantizedBytes;
+	maxPositionError = std::max(maxPositionError, other.maxPositionError);
+	maxNormalAngle	 = std::max(maxNormalAngle, other.maxNormalAngle);
+	maxTexCoordError = std::max(maxTexCoordError, other.maxTexCoordError);
+}
+
+std::string quantizationReport::toString() const
+{
+	std::stringstream output;
+	output << "vertices went from " << originalBytes << " to " << quantizedBytes << " bytes";
+	if(originalBytes > 0) output << " (-" << 100 * (originalBytes - quantizedBytes) / originalBytes << "%)";
+	output << ", max position error " << maxPositionError << ", max normal error " << maxNormalAngle << " degrees, max texture coordinate error "
+		   << maxTexCoordError;
+	return output.str();
+}
+
+void vertexQuantizer::encodeNormals(std::vector<vertexBufferPart>& parts)
+{
+	//Normals and tangents can be floats, or normalized integers from KHR_mesh_quantization. A normal already encoded has 4 components
+	const auto find = [&](Ogre::VertexElementSemantic semantic, size_t perVertex) {
+		return std::find_if(std::begin(parts), std::end(parts), [&](const vertexBufferPart& part) { return part.semantic == semantic && part.perVertex == perVertex; });
+	};
+
+	const auto normal = find(Ogre::VES_NORMAL, 3);
+	if(normal == std::end(parts)) return;
+	const auto tangent	= find(Ogre::VES_TANGENT, 4);
+	const auto hasTangent = tangent != std::end(parts);
+
+	//The sign of a 16 bit integer can't hold a reflection if the value is 0
+	const auto bias = 1.0f / 32767.0f;
+
+	auto storage = std::make_unique<geometryBuffer<Ogre::int16>>(normal->vertexCount * 4);
+	auto output  = storage->data();
+	for(size_t vertexIndex { 0 }; vertexIndex < normal->vertexCount; ++vertexIndex)
+	{
+		Ogre::Vector3 n;
+		normal->readFloats(vertexIndex, n.ptr());
+		if(n.normalise() < 1e-6f) n = Ogre::Vector3::UNIT_Z;
+
+		std::array<float, 4> t { 1, 0, 0, 1 };
+		if(hasTangent) tangent->readFloats(vertexIndex, t.data());
+
+		//Make the tangent orthogonal to the normal, or make one up if there's none
+		auto vTangent = Ogre::Vector3 { t.data() };
+		vTangent	  = vTangent - n * n.dotProduct(vTangent);
+		if(!hasTangent || vTangent.normalise() < 1e-6f) vTangent = n.perpendicular();
+
+		Ogre::Matrix3 tbn;
+		tbn.FromAxes(n, vTangent, n.crossProduct(vTangent));
+		Ogre::Quaternion q { tbn };
+		q.normalise();
+
+		if(q.w < 0) q = -q;
+		if(q.w < bias)
+		{
+			const auto scale = std::sqrt(1 - bias * bias);
+			q.w				 = bias;
+			q.x *= scale;
+			q.y *= scale;
+			q.z *= scale;
+		}
+
+		//Hlms rebuilds the bitangent as cross(tangent, normal) * sign(w), glTF defines it as cross(normal, tangent) * tangent.w
+		if(t[3] > 0) q = -q;
+
+		output[0] = toSnorm16(q.x);
+		output[1] = toSnorm16(q.y);
+		output[2] = toSnorm16(q.z);
+		output[3] = toSnorm16(q.w);
+
+		Ogre::Quaternion decoded { output[3] / 32767.0f, output[0] / 32767.0f, output[1] / 32767.0f, output[2] / 32767.0f };
+		decoded.normalise();
+		const auto cosine	= Ogre::Math::Clamp(decoded.xAxis().dotProduct(n), -1.0f, 1.0f);
+		report.maxNormalAngle = std::max(report.maxNormalAngle, Ogre::Radian(std::acos(cosine)).valueDegrees());
+
+		output += 4;
+	}
+
+	*normal = makePart(*normal, Ogre::VET_SHORT4_SNORM, 4, std::move(storage));
+	if(hasTangent) parts.erase(tangent);
+}
+
+void vertexQuantizer::quantizePositions(vertexBufferPart& position)
+{
+	auto storage	 = std::make_unique<geometryBuffer<Ogre::uint16>>(position.vertexCount * 4);
+	auto output		 = storage->data();
+	auto minimum	 = Ogre::Vector3 { std::numeric_limits<float>::max() };
+	auto maximum	 = Ogre::Vector3 { -std::numeric_limits<float>::max() };
+	float worstError = 0;
+
+	for(size_t vertexIndex { 0 }; vertexIndex < position.vertexCount; ++vertexIndex)
+	{
+		Ogre::Vector3 p;
+		position.readFloats(vertexIndex, p.ptr());
+		minimum.makeFloor(p);
+		maximum.makeCeil(p);
+
+		for(size_t i { 0 }; i < 3; ++i)
+		{
+			output[i]  = Ogre::Bitwise::floatToHalf(p[i]);
+			worstError = std::max(worstError, std::abs(Ogre::Bitwise::halfToFloat(output[i]) - p[i]));
+		}
+		output[3] = Ogre::Bitwise::floatToHalf(1.0f);
+		output += 4;
+	}
+
+	//Half floats are precise around the origin only, a model far from it would be damaged
+	const auto diagonal = position.vertexCount > 0 ? (maximum - minimum).length() : 0.0f;
+	if(worstError > positionTolerance * diagonal)
+	{
+		OgreLog("Keeping float positions, half floats would be off by " + std::to_string(worstError));
+		return;
+	}
+
+	report.maxPositionError = std::max(report.maxPositionError, worstError);
+	position				= makePart(position, Ogre::VET_HALF4, 4, std::move(storage));
+}
+
+void vertexQuantizer::quantizeTexCoords(vertexBufferPart& texCoords)
+{
+	auto storage	 = std::make_unique<geometryBuffer<Ogre::uint16>>(texCoords.vertexCount * 2);
+	auto output		 = storage->data();
+	float worstError = 0;
+
+	for(size_t vertexIndex { 0 }; vertexIndex < texCoords.vertexCount; ++vertexIndex)
+	{
+		std::array<float, 2> uv {};
+		texCoords.readFloats(vertexIndex, uv.data());
+		for(size_t i { 0 }; i < 2; ++i)
+		{
+			output[i]  = Ogre::Bitwise::floatToHalf(uv[i]);
+			worstError = std::max(worstError, std::abs(Ogre::Bitwise::halfToFloat(output[i]) - uv[i]));
+		}
+		output += 2;
+	}
+
+	//Heavily tiled texture coordinates are too large for half floats
+	if(worstError > texCoordTolerance)
+	{
+		OgreLog("Keeping float texture coordinates, half floats would be off by " + std::to_string(worstError));
+		return;
+	}
+
+	report.maxTexCoordError = std::max(report.maxTexCoordError, worstError);
+	texCoords				= makePart(texCoords, Ogre::VET_HALF2, 2, std::move(storage));
+}
+
+void vertexQuantizer::quantize(std::vector<vertexBufferPart>& parts)
+{
+	const auto vertexBytes = [&] {
+		size_t total { 0 };
+		for(const auto& part : parts) total += part.getPartStride() * part.vertexCount;
+		return total;
+	};
+
+	report.originalBytes += vertexBytes();
+
+	encodeNormals(parts);
+	for(auto& part : parts)
+	{
+		if(part.semantic == Ogre::VES_POSITION && part.type == Ogre::VET_FLOAT3) quantizePositions(part);
+		if(part.semantic == Ogre::VES_TEXTURE_COORDINATES && part.type == Ogre::VET_FLOAT2) quantizeTexCoords(part);
+	}
+
+	report.quantizedBytes += vertexBytes();
+}
+
+const quantizationReport& vertexQuantizer::getReport() const { return report; }
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Ogre_glTF_imageDecoder.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	class threadPool;
+
+	///Content shared between the files loaded by the same batch. Buffers and images are looked up by a hash of their content : when
+	///several files contain the same bytes, they are stored once, and images are decoded once.
+	///Buffers are only weakly referenced, they are shared as long as a file of the batch still uses them. Images are kept, with their
+	///pixels, until the batch is over : a file that comes long after the first one to use an image doesn't decode it again
+	class batchContent
+	{
+	public:
+		///Bytes shared by multiple files
+		using sharedBytes = std::shared_ptr<const std::vector<unsigned char>>;
+
+		///An image being decoded for one or more files
+		struct sharedImage
+		{
+			///The encoded image file
+			sharedBytes encoded;
+
+			///Size the image is expected to have
+			int requiredWidth, requiredHeight;
+
+			///The decoding, running on the worker threads. Every file that uses the image gets the same pixels
+			std::shared_future<std::shared_ptr<const imageDecoder::decodedImage>> decoded;
+		};
+
+	private:
+		///Protect the lookup tables
+		std::mutex mutex;
+
+		///Buffers by content hash
+		std::unordered_multimap<uint64_t, std::weak_ptr<const std::vector<unsigned char>>> buffers;
+
+		///Images by content hash
+		std::unordered_multimap<uint64_t, std::shared_ptr<sharedImage>> images;
+
+		///Number of bytes that didn't have to be stored again
+		std::atomic<size_t> sharedBufferBytes { 0 };
+
+		///Number of images that didn't have to be decoded again
+		std::atomic<size_t> sharedImageCount { 0 };
+
+	public:
+		///Get the shared copy of a buffer. If it's the first time this content is seen, the buffer becomes the shared copy
+		/// \param data content of the buffer. Moved from
+		sharedBytes shareBuffer(std::vector<unsigned char>&& data);
+
+		///Get the decoding of an image. If it's the first time this content is seen, the decoding is started
+		/// \param encoded content of the image file. Moved from
+		/// \param requiredWidth width the image is expected to have, or 0
+		/// \param requiredHeight height the image is expected to have, or 0
+		/// \param workers pool that decodes the image
+		std::shared_ptr<sharedImage> decode(std::vector<unsigned char>&& encoded, int requiredWidth, int requiredHeight, threadPool& workers);
+
+		///Print to the log how much has been shared
+		void logStatistics() const;
+	};
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <tiny_gltf.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///Give access to the bytes of the buffers of a glTF model. Buffers are normally stored inside the tinygltf::Model, but they can be
+	///redirected to memory that is owned by something else (a memory mapped file, a resource...) to avoid having a copy of them around
+	class bufferResolver
+	{
+		///A buffer that isn't stored inside the model
+		struct externalBuffer
+		{
+			///Start of the buffer
+			const unsigned char* address;
+
+			///Size of the buffer in bytes
+			size_t size;
+		};
+
+		///Reference to the model
+		tinygltf::Model& model;
+
+		///Buffers that have been redirected, by index in the model's buffer list
+		std::unordered_map<int, externalBuffer> externalBuffers;
+
+		///Objects that own the memory of the external buffers. They are kept alive as long as this object is
+		std::vector<std::shared_ptr<const void>> owners;
+
+	public:
+		///Construct a buffer resolver for a model
+		/// \param input model that owns the buffers
+		bufferResolver(tinygltf::Model& input);
+
+		///Get the address of the start of a buffer
+		/// \param bufferIndex index of the buffer in the glTF file
+		const unsigned char* data(int bufferIndex) const;
+
+		///Get the size of a buffer in bytes
+		/// \param bufferIndex index of the buffer in the glTF file
+		size_t size(int bufferIndex) const;
+
+		///Serve the content of a buffer from somewhere else, and release the copy stored in the model
+		/// \param bufferIndex index of the buffer in the glTF file
+		/// \param address start of the memory that contains the buffer
+		/// \param size number of bytes available at this address
+		/// \param owner object that keeps the memory alive
+		void redirect(int bufferIndex, const unsigned char* address, size_t size, std::shared_ptr<const void> owner);
+
+		///Serve the buffer stored in the binary chunk of a GLB file directly from the memory that contains that file
+		/// \param glb address of the start of the whole GLB file
+		/// \param length size of the GLB file in bytes
+		/// \param owner object that keeps the memory alive
+		/// \return false if the GLB file doesn't have a usable binary chunk
+		bool redirectGlbBinaryChunk(const unsigned char* glb, size_t length, std::shared_ptr<const void> owner);
+	};
+}
@@ -1,9 +1,79 @@
 #pragma once
 #include "Ogre_glTF_DLL.hpp"
 #include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
 
 ///Easilly print a stringto the ogre log
 void OgreLog(const std::string& message);
 
 ///Overload that takes a stringstream
-void OgreLog(const std::stringstream& message);
\ No newline at end of file
+void OgreLog(const std::stringstream& message);
+
+///While an object of this class exists, OgreLog keeps the messages of the thread that created it instead of writing them to the log.
+///Work done in parallel is reported this way, so the thread that waits for it writes the messages, in the order of the work
+class logCapture
+{
+	///Where the messages are kept
+	std::vector<std::string>& messages;
+
+	///Capture this one replaced on this thread, restored by the destructor
+	logCapture* const previous;
+
+public:
+	///Start keeping the messages of this thread
+	/// \param output where to append them
+	explicit logCapture(std::vector<std::string>& output);
+
+	///Stop keeping the messages. The ones kept stay in the output
+	~logCapture();
+
+	///Deleted copy constructor
+	logCapture(const logCapture&) = delete;
+
+	///Deleted assignment operator
+	logCapture& operator=(const logCapture&) = delete;
+
+	///Get the capture of this thread, or nullptr if its messages go to the log
+	static logCapture* current();
+
+	///Keep a message
+	/// \param message the message
+	void add(const std::string& message) { messages.push_back(message); }
+};
+
+///While an object of this class exists, OgreLog writes the messages of the thread that created it to the log, even if a capture is
+///active. A thread that waits for a task runs other tasks meanwhile : they run under one of these, so their messages don't end up in
+///the capture of the task that waits
+class logCaptureSuspension
+{
+	///Capture that was active on this thread, restored by the destructor
+	logCapture* const suspended;
+
+public:
+	///Stop the capture of this thread, if any
+	logCaptureSuspension();
+
+	///Restore the capture of this thread
+	~logCaptureSuspension();
+
+	///Deleted copy constructor
+	logCaptureSuspension(const logCaptureSuspension&) = delete;
+
+	///Deleted assignment operator
+	logCaptureSuspension& operator=(const logCaptureSuspension&) = delete;
+};
+
+///Get the peak resident memory (in bytes) used by this process so far. Returns 0 if the platform can't tell
+size_t getPeakResidentMemory();
+
+///Print to the Ogre log the peak resident memory of the process
+/// \param context what has just been done, to prefix the message with
+void OgreLogPeakMemory(const std::string& context);
+
+///Fast non cryptographic 64 bit hash of a block of memory. Gives the same result from one run to another
+/// \param data start of the memory to hash
+/// \param size number of bytes to hash
+/// \param seed starting value, to chain multiple blocks
+uint64_t contentHash(const void* data, size_t size, uint64_t seed = 0);
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <tiny_gltf.h>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	class threadPool;
+	class batchContent;
+
+	///Image loading callback for tinygltf that doesn't decode anything while the file is parsed. The encoded bytes are copied,
+	///the decoding is pushed to the worker threads, and the pixels are put back into the model by finish(). The pixels of images shared
+	///with other files of a batch are not copied into the model, finish() only gives a reference to them.
+	///The decoding can also be deferred completely : the encoded bytes are then kept for textureImporter to decode on demand
+	class imageDecoder
+	{
+	public:
+		///Pixels of an image decoded by a worker
+		struct decodedImage
+		{
+			///Pixels, tightly packed
+			std::vector<unsigned char> pixels;
+
+			///Width of the image
+			int width = 0;
+
+			///Height of the image
+			int height = 0;
+
+			///Number of 8 bit channels per pixel
+			int component = 0;
+
+			///Filled if the decoding failed
+			std::string error;
+		};
+
+		///Pixels of an image decoded once for several files
+		using sharedPixels = std::shared_ptr<const std::vector<unsigned char>>;
+
+		///Decode an image with stb_image
+		/// \param encoded content of the PNG/JPEG/... file
+		/// \param requiredWidth width the image is expected to have, or 0
+		/// \param requiredHeight height the image is expected to have, or 0
+		static decodedImage decode(const std::vector<unsigned char>& encoded, int requiredWidth = 0, int requiredHeight = 0);
+
+	private:
+		///Pool that does the decoding
+		threadPool& workers;
+
+		///If true, images are not decoded at all, their encoded bytes are kept instead
+		const bool deferDecoding;
+
+		///If true, images that shared textures have already been made from are not decoded, their encoded bytes are kept instead
+		const bool skipSharedImages;
+
+		///Images shared with the other files of a batch, or nullptr
+		batchContent* const batch;
+
+		///Decoding in progress, with the index of the image they are for
+		std::vector<std::pair<int, std::future<decodedImage>>> pending;
+
+		///Decoding in progress of images that can also be used by other files of the batch, with the index of the image they are for
+		std::vector<std::pair<int, std::shared_future<std::shared_ptr<const decodedImage>>>> pendingShared;
+
+		///Pixels of the decoded images shared with the other files of a batch, by image index
+		std::unordered_map<int, sharedPixels> sharedImages;
+
+		///Encoded bytes of the images that haven't been decoded, by image index
+		std::unordered_map<int, std::vector<unsigned char>> encodedImages;
+
+		///contentHash() of the encoded bytes of every image, by image index
+		std::unordered_map<int, uint64_t> imageHashes;
+
+	public:
+		///Create a decoder that works on the given pool
+		/// \param pool thread pool the images will be decoded on
+		/// \param deferred if true, don't decode the images, only keep their encoded bytes
+		/// \param shared if not nullptr, identical images are only decoded once for all the files that use this object
+		/// \param skipShared if true, don't decode the images shared textures have already been made from, only keep their encoded bytes
+		imageDecoder(threadPool& pool, bool deferred = false, batchContent* shared = nullptr, bool skipShared = false);
+
+		///Callback given to tinygltf::TinyGLTF::SetImageLoader. The user data is a pointer to an imageDecoder
+		static bool loadImageData(tinygltf::Image* image,
+								  const int imageIndex,
+								  std::string* error,
+								  std::string* warning,
+								  int requiredWidth,
+								  int requiredHeight,
+								  const unsigned char* bytes,
+								  int size,
+								  void* userData);
+
+		///Install this decoder as the image loader of a TinyGLTF object
+		/// \param loader the object that will parse the file
+		void install(tinygltf::TinyGLTF& loader);
+
+		///Wait for all the images to be decoded, and store their pixels into the model. The size of the shared images is stored too,
+		///their pixels are kept apart, see takeSharedPixels()
+		/// \param model the model that has been parsed with this decoder installed
+		/// \param error where to append the decoding errors
+		/// \return false if an image couldn't be decoded
+		bool finish(tinygltf::Model& model, std::string& error);
+
+		///Get the encoded bytes of the images that have not been decoded, by image index
+		std::unordered_map<int, std::vector<unsigned char>> takeEncodedImages();
+
+		///Get the pixels of the images shared with the other files of a batch, by image index. They aren't in the model
+		std::unordered_map<int, sharedPixels> takeSharedPixels();
+
+		///Get the hash of the encoded bytes of every image, by image index
+		std::unordered_map<int, uint64_t> takeImageHashes();
+	};
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Ogre_glTF_modelConverter.hpp"
+
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///Largest index a 16 bit index buffer can hold. 0xFFFF is left out : the render system uses it to restart strips
+	constexpr Ogre::uint32 largest16BitIndex = 0xFFFE;
+
+	///Check if 32 bit indices can be stored on 16 bits
+	/// \param indices the indices, with no alignment requirement
+	/// \param count number of indices
+	bool indicesFitIn16Bits(const Ogre::uint32* indices, size_t count);
+
+	///Convert 32 bit indices to 16 bit ones. They all have to fit, see indicesFitIn16Bits()
+	/// \param source the 32 bit indices, with no alignment requirement
+	/// \param destination where to write the 16 bit indices
+	/// \param count number of indices
+	void narrowIndices(const Ogre::uint32* source, Ogre::uint16* destination, size_t count);
+
+	///Convert 8 bit indices to 16 bit ones. Ogre has no 8 bit index buffer
+	/// \param source the 8 bit indices
+	/// \param destination where to write the 16 bit indices
+	/// \param count number of indices
+	void widenIndices(const Ogre::uint8* source, Ogre::uint16* destination, size_t count);
+
+	///Give a primitive a copy of the vertices (and bone assignments) of a vertex set its indices use, in the order they are in the set.
+	///Its indices are renumbered, and stored on 16 bits if they fit
+	/// \param vertexSet vertices shared by several primitives
+	/// \param primitive a primitive that only has its indices, that point in the vertex set
+	void copyUsedVertices(const primitiveData& vertexSet, primitiveData& primitive);
+
+	///Cut a primitive in several ones with few enough vertices to use 16 bit indices. Each one gets a copy of the vertices (and bone
+	///assignments) its points, lines or triangles use, in the order they use them
+	/// \param primitive a point, line or triangle list
+	/// \param maxVertices largest number of vertices of a piece
+	/// \return the pieces, in the order of the original indices. Empty if the primitive is a strip or a fan, that can't be cut
+	std::vector<primitiveData> splitPrimitive(const primitiveData& primitive, size_t maxVertices = largest16BitIndex + 1);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Ogre_glTF_modelConverter.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///How well a triangle list uses the post transform vertex cache, simulated as a FIFO
+	struct vertexCacheStatistics
+	{
+		///Average cache miss ratio : vertices transformed per triangle. 3 is the worst, around 0.5 is the best a regular grid can get
+		float acmr = 0;
+
+		///Average transformed vertex ratio : vertices transformed per vertex of the primitive. 1 is the best possible
+		float atvr = 0;
+
+		///Simulate the vertex cache on a triangle list
+		/// \param indices the triangle list
+		/// \param vertexCount number of vertices the indices refer to
+		/// \param cacheSize number of entries of the simulated cache
+		static vertexCacheStatistics compute(const std::vector<Ogre::uint32>& indices, size_t vertexCount, size_t cacheSize);
+	};
+
+	///Reorder the triangles and the vertices of a triangle list primitive so the GPU does less work drawing it. Triangles are first sorted
+	///for the post transform vertex cache (Tom Forsyth's linear-speed algorithm), then clusters of them are sorted to draw the ones facing
+	///outward first and reduce overdraw, and finally vertices are renumbered in the order they are used so they are fetched sequentially.
+	///The image is unchanged : only the order of triangles and vertices is
+	class indexOptimizer
+	{
+		///Indices of the primitive, widened to 32 bits
+		std::vector<Ogre::uint32> indices;
+
+		///Number of vertices of the primitive
+		size_t vertexCount = 0;
+
+		///Sort the triangles for the vertex cache
+		void optimizeVertexCache();
+
+		///Sort groups of triangles that share vertices in the cache, so the ones on the outside of the primitive are drawn first
+		/// \param positions position of each vertex
+		void optimizeOverdraw(const std::vector<Ogre::Vector3>& positions);
+
+		///Renumber the vertices in the order the triangles use them, and reorder the vertex buffer and the bone assignments to match
+		/// \param primitive the primitive the indices come from
+		void optimizeVertexFetch(primitiveData& primitive) const;
+
+	public:
+		///Size of the FIFO vertex cache used for the statistics
+		static constexpr size_t simulatedCacheSize = 16;
+
+		///Optimize a triangle list primitive. Other kinds of primitives are left untouched
+		/// \param primitive the prepared primitive to optimize, its indices and vertices are replaced
+		/// \param positions position of each vertex of the primitive
+		/// \return the cache statistics before and after, for the log. Empty if nothing was done
+		std::string optimize(primitiveData& primitive, const std::vector<Ogre::Vector3>& positions);
+	};
+}
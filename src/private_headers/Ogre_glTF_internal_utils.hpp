@@ -1,6 +1,10 @@
 #pragma once
 
+#include "Ogre_glTF.hpp"
+
 #include <algorithm>
+#include <limits>
+#include <string>
 
 namespace Ogre_glTF
 {
@@ -16,5 +20,16 @@ namespace Ogre_glTF
 							   return static_cast<float>(n);
 						   });
 		}
+
+		///Get the size of a file in the unsigned int tinygltf takes to parse a file from memory
+		/// \param size size of the file in bytes
+		/// \param name name of the file, for the error message
+		/// \return the size
+		/// \throw LoadingError if the file is 4 GiB or more : tinygltf can't parse it, and a GLB file can't be that large
+		inline unsigned int parseableSize(size_t size, const std::string& name)
+		{
+			if(size > std::numeric_limits<unsigned int>::max()) throw LoadingError(name + " is too large to be parsed, glTF and GLB files are limited to 4 GiB");
+			return static_cast<unsigned int>(size);
+		}
 	}
-}
\ No newline at end of file
+}
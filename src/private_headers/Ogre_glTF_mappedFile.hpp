@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Ogre_glTF
+{
+	///Read only memory mapping of a whole file. The OS page in the content of the file when it's accessed, nothing is read into a heap allocated buffer
+	class mappedFile
+	{
+		///Start of the mapped view of the file
+		const unsigned char* address = nullptr;
+
+		///Size in bytes of the file
+		size_t length = 0;
+
+#ifdef _WIN32
+		///Handle of the opened file
+		void* fileHandle = nullptr;
+
+		///Handle of the file mapping object
+		void* mappingHandle = nullptr;
+#else
+		///Descriptor of the opened file
+		int fileDescriptor = -1;
+#endif
+
+		///Unmap the view and close the file, if they are open
+		void close();
+
+	public:
+		///Open and map the file. Throws FileIOError if it cannot be done
+		/// \param path path to the file to map
+		mappedFile(const std::string& path);
+
+		///Unmap the file
+		~mappedFile();
+
+		///Deleted copy constructor : non copyable class
+		mappedFile(const mappedFile&) = delete;
+
+		///Deleted assignment operator : non copyable class
+		mappedFile& operator=(const mappedFile&) = delete;
+
+		///Get the address of the start of the file content
+		const unsigned char* data() const;
+
+		///Get the size of the file in bytes
+		size_t size() const;
+	};
+}
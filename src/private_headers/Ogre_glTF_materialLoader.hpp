@@ -9,6 +9,62 @@ namespace Ogre_glTF
 	///Foward declare the textureImporter
 	class textureImporter;
 
+	///What a datablock is made from : everything read from a glTF material, without any reference to the glTF file itself.
+	///Textures are referenced by the index of the image they are made from, -1 if the material doesn't have them
+	struct materialDescription
+	{
+		///Name of the material, and of the datablock
+		std::string name;
+
+		///Image used by the baseColorTexture
+		int baseColorImage = -1;
+
+		///Image used by the metallicRoughnessTexture
+		int metalRoughImage = -1;
+
+		///Image used by the normalTexture
+		int normalImage = -1;
+
+		///Image used by the emissiveTexture
+		int emissiveImage = -1;
+
+		///True if the material defines a baseColorFactor
+		bool hasBaseColor = false;
+
+		///RGB part of the baseColorFactor
+		Ogre::Vector3 baseColor = Ogre::Vector3::UNIT_SCALE;
+
+		///Alpha part of the baseColorFactor
+		float alpha = 1;
+
+		///True if the material defines a metallicFactor
+		bool hasMetallic = false;
+
+		///The metallicFactor
+		float metallic = 1;
+
+		///True if the material defines a roughnessFactor
+		bool hasRoughness = false;
+
+		///The roughnessFactor
+		float roughness = 1;
+
+		///True if the material defines an emissiveFactor
+		bool hasEmissive = false;
+
+		///The emissiveFactor
+		Ogre::Vector3 emissive = Ogre::Vector3::ZERO;
+
+		///The alphaMode. Empty if not defined
+		std::string alphaMode;
+
+		///True if the material defines an alphaCutoff
+		bool hasAlphaCutoff = false;
+
+		///The alphaCutoff
+		float alphaCutoff = 0.5f;
+	};
+
 	///Load material information from a model inside Ogre, provide you a datablock to set to an Ogre::Item object
 	class materialLoader
 	{
@@ -17,6 +73,9 @@ namespace Ogre_glTF
 		///The model
 		tinygltf::Model& model;
 
+		///Materials given directly instead of read from the model, by primitive index. Used when the model comes from the cache
+		std::vector<materialDescription> descriptions;
+
 		static Ogre::Vector3 convertColor(const tinygltf::ColorValue& color);
 
 		///Set the diffuse color of the material
@@ -37,32 +96,31 @@ namespace Ogre_glTF
 		/// \param color floating point value that represent metalness of the surface
 		void setEmissiveColor(Ogre::HlmsPbsDatablock* block, Ogre::Vector3 color) const;
 
-		///Return true if the texture index is valid
-		bool isTextureIndexValid(int textureIndex) const;
+		///Return true if the image index is valid
+		bool isImageIndexValid(int imageIndex) const;
+
+		///Get the index of the image a texture uses, or -1 if the texture index is invalid
+		/// \param textureIndex gltf texture index
+		int getImageIndex(int textureIndex) const;
 
 		///Set the diffuse texture (baseColorTexture)
 		/// \param block datablock to set
-		/// \param value gltf texture index
+		/// \param value gltf image index
 		void setBaseColorTexture(Ogre::HlmsPbsDatablock* block, int value) const;
 
 		///Set the metalness and roughness textures (metalRoughTexture)
 		/// \param block datablock to set
-		/// \param value gltf texture index
+		/// \param value gltf image index
 		void setMetalRoughTexture(Ogre::HlmsPbsDatablock* block, int value) const;
 
 		///Set the normal texture
 		/// \param block datablock to set
-		/// \param value gltf texture index
+		/// \param value gltf image index
 		void setNormalTexture(Ogre::HlmsPbsDatablock* block, int value) const;
 
-		///Set the occlusion texure (AFAIK, Ogre don't use them, so this does nothing)
-		/// \param block datablock to set
-		/// \param value gltf texture index
-		void setOcclusionTexture(Ogre::HlmsPbsDatablock* block, int value) const;
-
 		///Set the emissive texture
 		/// \param block datablock to set
-		/// \param value gltf texture index
+		/// \param value gltf image index
 		void setEmissiveTexture(Ogre::HlmsPbsDatablock* block, int value) const;
 
 		///Set the alpha mode
@@ -83,5 +141,20 @@ namespace Ogre_glTF
 		///Get the material (the HlmsDatablock)
 		Ogre::HlmsDatablock* getDatablock(size_t index = 0) const;
 		size_t getDatablockCount() const;
+
+		///Read the material of a primitive of the main mesh
+		/// \param index index of the primitive
+		materialDescription describe(size_t index) const;
+
+		///Read the materials of all the primitives of the main mesh
+		std::vector<materialDescription> describeAll() const;
+
+		///Create (or get, if it already exists) the datablock for a material
+		/// \param description the material
+		Ogre::HlmsDatablock* createDatablock(const materialDescription& description) const;
+
+		///Use these materials instead of the ones of the model
+		/// \param materials one material per primitive of the main mesh
+		void setDescriptions(std::vector<materialDescription> materials);
 	};
 }
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <Ogre.h>
+
+#include <array>
+#include <queue>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///Reduce the number of triangles of a triangle list by collapsing edges, picking the ones that change the surface the least according
+	///to quadric error metrics (Garland & Heckbert). Only the indices change : an edge is collapsed by moving one of its vertices onto the
+	///other, so the vertex buffer can be shared by every level of detail.
+	///Vertices on a UV or normal seam (several vertices at the same position) and on the border of the surface never move, and moving a
+	///vertex onto one with different bone weights is penalized, so seams don't open, borders don't shrink and skinning doesn't tear
+	class meshSimplifier
+	{
+		///Symmetric 4x4 matrix giving the sum of the squared distances of a point to a set of planes
+		struct quadric
+		{
+			///Upper triangle of the matrix, row by row
+			std::array<double, 10> coefficients {};
+
+			///Add the quadric of a plane
+			/// \param normal unit normal of the plane
+			/// \param distance signed distance of the plane to the origin
+			/// \param weight how much the plane counts
+			void addPlane(const Ogre::Vector3& normal, double distance, double weight);
+
+			///Add another quadric to this one
+			quadric& operator+=(const quadric& other);
+
+			///Get the weighted sum of the squared distances of a point to the planes
+			double evaluate(const Ogre::Vector3& point) const;
+		};
+
+		///An edge collapse waiting in the queue. It's outdated if one of its vertices changed since it was pushed
+		struct collapse
+		{
+			///Error the collapse adds to the surface
+			double cost;
+
+			///Vertex that is removed
+			Ogre::uint32 from;
+
+			///Vertex it's moved onto
+			Ogre::uint32 to;
+
+			///Versions of the vertices when the collapse was pushed
+			Ogre::uint32 fromVersion, toVersion;
+
+			///Order the priority queue with the cheapest collapse on top
+			bool operator<(const collapse& other) const { return cost > other.cost; }
+		};
+
+		///Position of each vertex
+		const std::vector<Ogre::Vector3>& positions;
+
+		///Current triangles. Vertices of collapsed edges are replaced in place
+		std::vector<Ogre::uint32> indices;
+
+		///False for triangles that have been removed by a collapse
+		std::vector<bool> aliveTriangles;
+
+		///Number of triangles that are still alive
+		size_t triangleCount = 0;
+
+		///Triangles using each vertex. May list dead triangles
+		std::vector<std::vector<Ogre::uint32>> vertexTriangles;
+
+		///Error quadric of each vertex
+		std::vector<quadric> quadrics;
+
+		///True for vertices that can be moved : not on a seam nor on a border
+		std::vector<bool> movable;
+
+		///True for vertices other vertices can be moved onto : not on a seam
+		std::vector<bool> anchor;
+
+		///Bone weights of each vertex, by bone index. Empty if the primitive isn't skinned
+		std::vector<std::vector<std::pair<Ogre::uint16, float>>> boneWeights;
+
+		///Incremented each time the neighborhood of a vertex changes, to detect outdated collapses
+		std::vector<Ogre::uint32> versions;
+
+		///Possible collapses, cheapest on top
+		std::priority_queue<collapse> queue;
+
+		///Compute the cost of moving a vertex onto another one and push it in the queue, if it's allowed
+		void pushCollapse(Ogre::uint32 from, Ogre::uint32 to);
+
+		///Push the collapses of every edge that has a vertex
+		/// \param vertex the vertex
+		/// \param both true to push the collapses onto the vertex too, false to only push the ones that move it
+		void pushCollapses(Ogre::uint32 vertex, bool both);
+
+		///Get the vertices that share a triangle with a vertex, sorted
+		std::vector<Ogre::uint32> getNeighbors(Ogre::uint32 vertex) const;
+
+		///Check if moving a vertex onto another one would make the surface non manifold
+		bool breaksManifold(Ogre::uint32 from, Ogre::uint32 to) const;
+
+		///Check if moving a vertex onto another one would flip one of the triangles around it
+		bool flipsTriangles(Ogre::uint32 from, Ogre::uint32 to) const;
+
+		///Get how different the bone weights of two vertices are. 0 when they are the same, 2 when they share no bone
+		float boneWeightDifference(Ogre::uint32 a, Ogre::uint32 b) const;
+
+		///Move a vertex onto another one, removing the triangles between them
+		void applyCollapse(Ogre::uint32 from, Ogre::uint32 to);
+
+	public:
+		///Prepare the simplification of a triangle list
+		/// \param vertexPositions position of each vertex. Has to outlive the simplifier
+		/// \param triangles the triangle list
+		/// \param boneAssignments bone assignments of the vertices, empty if the primitive isn't skinned
+		meshSimplifier(const std::vector<Ogre::Vector3>& vertexPositions,
+					   std::vector<Ogre::uint32> triangles,
+					   const std::vector<Ogre::VertexBoneAssignment>& boneAssignments);
+
+		///Collapse edges until there are at most the given number of triangles left, or nothing can be collapsed anymore. Can be called
+		///again with a smaller target to get the next level of detail
+		/// \param targetTriangleCount number of triangles to go down to
+		/// \return the triangle list of the simplified mesh
+		std::vector<Ogre::uint32> simplify(size_t targetTriangleCount);
+	};
+}
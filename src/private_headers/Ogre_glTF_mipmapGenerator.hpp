@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Ogre_glTF_textureImporter.hpp"
+
+namespace Ogre_glTF
+{
+	///How the pixels of an image are averaged to make its mipmaps
+	enum class mipmapFilter {
+		///Average every channel as it is. For data textures, like metalness and roughness
+		linear,
+
+		///The colour channels are sRGB encoded : they are averaged in linear space, then encoded again. Alpha is averaged as it is
+		sRGB,
+
+		///The image is a normal map in a SNORM format : the vectors are averaged and normalized again. With two channels, z is
+		///reconstructed the way Hlms does it before averaging
+		normal
+	};
+
+	///Get the number of mipmaps that follow the full size image, halving the size down to 1x1
+	/// \param width width of the full size image
+	/// \param height height of the full size image
+	Ogre::uint8 getMipmapCount(Ogre::uint32 width, Ogre::uint32 height);
+
+	///Build the whole mipmap chain of an image on the CPU, each level from the previous one with a box filter. Every pixel of a level
+	///averages the pixels of the previous level it covers : 2x2 of them, 3 wide or high when that size is odd. Doesn't touch the
+	///render system, can be called from a worker thread. Does nothing if the image already has mipmaps
+	/// \param image the image. Its levels are appended to its pixels, and its mipmap count set
+	/// \param filter how the pixels are averaged
+	void generateMipmaps(stagedImage& image, mipmapFilter filter);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Ogre_glTF.hpp"
+#include "Ogre_glTF_modelConverter.hpp"
+#include "Ogre_glTF_materialLoader.hpp"
+#include "Ogre_glTF_textureImporter.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///Everything needed to create a model, as read from the cache. Nothing from the glTF file is needed anymore
+	struct cachedModel
+	{
+		///Transform of the node the mesh is attached to
+		ModelInformation::ModelTransform transform;
+
+		///Interleaved vertices, indices and bone assignments of every primitive
+		std::unique_ptr<meshData> mesh;
+
+		///Material of each primitive
+		std::vector<materialDescription> materials;
+
+		///Every texture the materials use, already converted
+		std::vector<stagedTexture> textures;
+
+		///True if there's a skeleton stored alongside the model
+		bool skinned = false;
+	};
+
+	///On disk cache of converted models. Each entry is keyed by a hash of the content of the source file, of the buffers and images it
+	///references, and of the loader options that change the output, so an entry never has to be invalidated : a modified file or
+	///different options give a different key.
+	///An entry is a binary file with the mesh, materials and textures, plus a .skeleton file written by Ogre for skinned models
+	class modelCache
+	{
+		///Directory the entries are stored in, ending with a separator
+		std::string directory;
+
+		///Get the path of a file of an entry
+		/// \param key key of the entry
+		/// \param extension which file of the entry
+		std::string getPath(const std::string& key, const std::string& extension) const;
+
+	public:
+		///Use the given directory as cache. It's created if needed
+		/// \param cacheDirectory where to store the entries
+		modelCache(const std::string& cacheDirectory);
+
+		///Compute the key of a file. Throws FileIOError if it can't be read
+		/// \param path path to the glTF or GLB file
+		/// \param options the options the file is loaded with
+		static std::string getKey(const std::string& path, const LoaderOptions& options);
+
+		///Read an entry
+		/// \param key key of the entry
+		/// \return nullptr if there's no such entry, or if it's not readable
+		std::unique_ptr<cachedModel> read(const std::string& key) const;
+
+		///Write an entry. Throws FileIOError on failure
+		/// \param key key of the entry
+		/// \param transform transform of the node the mesh is attached to
+		/// \param mesh the prepared mesh
+		/// \param materials material of each primitive
+		/// \param textures every texture the materials use
+		/// \param skeleton skeleton of the mesh, or nullptr
+		void write(const std::string& key,
+				   const ModelInformation::ModelTransform& transform,
+				   const meshData& mesh,
+				   const std::vector<materialDescription>& materials,
+				   const std::vector<stagedTexture>& textures,
+				   Ogre::v1::Skeleton* skeleton) const;
+
+		///Create a skeleton from the one stored in an entry. Throws FileIOError if it can't be read
+		/// \param key key of the entry
+		/// \param name name of the skeleton in the OldSkeletonManager
+		Ogre::v1::SkeletonPtr loadSkeleton(const std::string& key, const std::string& name) const;
+	};
+}
@@ -1,7 +1,12 @@
 #pragma once
 #include <Ogre.h>
+#include <OgreSubMesh2.h>
 #include <tiny_gltf.h>
+#include <memory>
+#include <unordered_map>
 #include "Ogre_glTF.hpp"
+#include "Ogre_glTF_bufferResolver.hpp"
+#include "Ogre_glTF_vertexInterleaver.hpp"
 
 namespace Ogre_glTF
 {
@@ -115,12 +120,12 @@ namespace Ogre_glTF
 		}
 	};
 
-	///Part of the vertex buffer, containing a geometry buffer and the information about the type and number of vertex elements;
-	///We cache these informations because we need to reorder the data into one single interleaved buffer for Ogre loading vertices into a single Vao
+	///Part of the vertex buffer : where an attribute is in the glTF buffers, and the information about the type and number of vertex elements;
+	///The attribute is read in place when the data is reordered into one single interleaved buffer for Ogre loading vertices into a single Vao
 	struct vertexBufferPart
 	{
-		///Buffer that contain vertices
-		std::unique_ptr<geometryBuffer_base> buffer;
+		///Where the attribute of each vertex is, inside the glTF buffer
+		vertexSource source;
 
 		///The type of vertex data (2 floats, 3 floats...)
 		Ogre::VertexElementType type;
@@ -131,11 +136,83 @@ namespace Ogre_glTF
 		///Number of vertices on this buffer
 		size_t vertexCount;
 
-		///Number of "basic elements" that constitute a vertex (2x for a 2D vector, 3x for a 3D vector...)
+		///Number of "basic elements" that constitute a vertex (2x for a 2D vector, 3x for a 3D vector...). Components added to match an Ogre
+		///vertex element type are not counted
 		size_t perVertex;
 
-		///Get the number of bytes for the data stride
+		///Storage of the attribute when it had to be converted. Empty when it's read in place from the glTF buffer
+		std::unique_ptr<geometryBuffer_base> storage;
+
+		///Get the number of bytes the attribute takes in a vertex
 		size_t getPartStride() const;
+
+		///Read the components of the attribute of a vertex as floats. Normalized integers are mapped to [0, 1] or [-1, 1]
+		/// \param vertexIndex index of the vertex
+		/// \param output where to write the perVertex floats
+		void readFloats(size_t vertexIndex, float* output) const;
+	};
+
+	///CPU side content of a primitive, ready to be turned into an Ogre VAO. Building it doesn't touch the render system, so it can be done on any thread
+	struct primitiveData
+	{
+		///Description of the content of the vertex buffer
+		Ogre::VertexElement2Vec vertexElements;
+
+		///Interleaved vertex data. Primitives that read the same attribute accessors can point to the same buffer, it's then uploaded once.
+		///It's never modified in place : the steps that reorder or cut the vertices make a new buffer
+		std::shared_ptr<geometryBuffer<unsigned char>> vertices;
+
+		///Number of vertices in the vertex buffer
+		size_t vertexCount = 0;
+
+		///Index data. Either 16 or 32 bit indices
+		std::unique_ptr<geometryBuffer_base> indices;
+
+		///Type of the indices
+		Ogre::IndexBufferPacked::IndexType indexType = Ogre::IndexBufferPacked::IT_16BIT;
+
+		///Number of indices
+		size_t indexCount = 0;
+
+		///The kind of primitive this is (triangle list, line strip...)
+		Ogre::OperationType operationType = Ogre::OT_TRIANGLE_LIST;
+
+		///Bone assignments of skinned primitives. Empty otherwise
+		std::vector<Ogre::VertexBoneAssignment> boneAssignments;
+
+		///Index of the glTF primitive this comes from. Several primitiveData have the same one when a large primitive is split
+		size_t sourcePrimitive = 0;
+
+		///Indices of each generated level of detail, from the most detailed to the least. They use the same vertices and index type
+		std::vector<std::unique_ptr<geometryBuffer_base>> lodIndices;
+
+		///Position only copy of this primitive, drawn by the shadow map passes instead of it. Null to draw the primitive itself
+		std::unique_ptr<primitiveData> shadowCaster;
+
+		///Read the indices of a level of detail as 32 bit integers, whatever their type is
+		/// \param level 0 for the indices of the primitive, 1 for the first of the lodIndices...
+		std::vector<Ogre::uint32> readIndices(size_t level = 0) const;
+
+		///Store 32 bit indices in a buffer of the index type of this primitive
+		/// \param source the indices. They have to fit in the index type
+		std::unique_ptr<geometryBuffer_base> makeIndexBuffer(const std::vector<Ogre::uint32>& source) const;
+
+		///Read the position of every vertex from the interleaved vertices
+		/// \return an empty vector if there's no position in the vertices
+		std::vector<Ogre::Vector3> readPositions() const;
+	};
+
+	///CPU side content of a mesh, made of one primitiveData per submesh
+	struct meshData
+	{
+		///Name of the mesh in the glTF file
+		std::string name;
+
+		///Bounds of the whole mesh
+		Ogre::Aabb boundingBox;
+
+		///Content of each submesh, in the order of the glTF primitives they come from
+		std::vector<primitiveData> primitives;
 	};
 
 	///Index loader that will also convert between integer types.
@@ -145,22 +222,85 @@ namespace Ogre_glTF
 	/// \param offset where the indexes starts in the buffer
 	/// \param stride number of bytes between elements
 	template <typename bufferType, typename sourceType>
-	void loadIndexBuffer(bufferType* dest, sourceType* source, size_t indexCount, size_t offset, size_t stride)
+	void loadIndexBuffer(bufferType* dest, const sourceType* source, size_t indexCount, size_t offset, size_t stride)
 	{
-		for(size_t i = 0; i < indexCount; ++i) { dest[i] = *(reinterpret_cast<sourceType*>(reinterpret_cast<unsigned char*>(source) + (offset + i * stride))); }
+		for(size_t i = 0; i < indexCount; ++i)
+		{ dest[i] = *(reinterpret_cast<const sourceType*>(reinterpret_cast<const unsigned char*>(source) + (offset + i * stride))); }
 	}
 
+	struct quantizationReport;
+	class threadPool;
+
 	///Converter object : take a tinygltf model and encapsulate all the code necessary to extract mesh information
 	class modelConverter
 	{
 	public:
 		///Construct a modelConverter from a model
 		/// \param input model we are converting into an Ogre model
-		modelConverter(tinygltf::Model& input);
+		/// \param bufferAccess where to read the content of the model's buffers from
+		modelConverter(tinygltf::Model& input, const bufferResolver& bufferAccess);
+
+		///Do all the CPU work needed to build the mesh : read indices and vertices, interleave them, compute bone assignments.
+		///This doesn't touch the render system and can be called from a worker thread. getOgreMesh() calls it if it hasn't been done yet
+		/// \param workers if not null, the primitives are read, interleaved and simplified in parallel on them. The submeshes are in the
+		///same order either way
+		void prepareMesh(threadPool* workers = nullptr);
+
+		///Get the prepared content of the mesh, preparing it if needed
+		const meshData& getPreparedMesh();
+
+		///Use an already prepared mesh instead of reading the model. Used when the model comes from the cache
+		/// \param mesh the content of the mesh
+		void setPreparedMesh(std::unique_ptr<meshData> mesh);
 
 		///Return a mesh generated from the data inside the gltf model. Currently look for the mesh attached on the first node of the default scene
 		Ogre::MeshPtr getOgreMesh();
 
+		///Create a new mesh from the data inside the gltf model, even if one with the same name already exists
+		/// \param name name of the mesh in the MeshManager. Needs to be unique
+		/// \param keepShadowCopies keep a CPU copy of the buffers, needed to serialize the mesh
+		Ogre::MeshPtr createOgreMesh(const std::string& name, bool keepShadowCopies);
+
+		///Convert vertex attributes to smaller formats when preparing the mesh
+		/// \param enabled true to quantize the vertices
+		void setVertexQuantization(bool enabled);
+
+		///Reorder the triangles and vertices of triangle lists for the vertex cache, overdraw and vertex fetch when preparing the mesh
+		/// \param enabled true to optimize the indices
+		void setIndexOptimization(bool enabled);
+
+		///Split primitives that have too many vertices for 16 bit indices into several submeshes when preparing the mesh
+		/// \param enabled true to split large primitives
+		void setLargeMeshSplitting(bool enabled);
+
+		///Generate levels of detail of the triangle lists by collapsing edges when preparing the mesh
+		/// \param distances distance at which each level starts to be used. Empty to not generate any
+		/// \param reduction fraction of the triangles of the previous level each level keeps
+		void setLodGeneration(std::vector<float> distances, float reduction);
+
+		///Put the vertices of the primitives that have the same vertex format in a single vertex buffer when preparing the mesh. Each
+		///primitive keeps its submesh, that draws from its range of the buffer
+		/// \param enabled true to pool the vertices
+		void setVertexBufferPooling(bool enabled);
+
+		///Let the primitives that read the same attribute accessors draw from one vertex buffer when preparing the mesh, instead of each
+		///keeping the vertices its indices use
+		/// \param enabled true to share the vertex buffers
+		void setVertexBufferSharing(bool enabled);
+
+		///Set how many bones a vertex can be influenced by. Vertices with more keep the ones with the largest weights
+		/// \param count between 1 and 4, the most Ogre skins with
+		void setMaxBoneInfluences(size_t count);
+
+		///Give the shadow map passes their own vertex buffer when preparing the mesh, with only what they read from a vertex
+		/// \param enabled true to make shadow casters
+		/// \param reduction fraction of the triangles of each level of detail its shadow caster keeps. 1 to not simplify them
+		void setShadowCasters(bool enabled, float reduction);
+
+		///Get the glTF primitive a submesh of the mesh comes from. It's the submesh index unless large primitives were split
+		/// \param submeshIndex index of the submesh in the Ogre mesh
+		size_t getSubmeshPrimitive(size_t submeshIndex) const;
+
 		///Print out debug information on the model structure
 		// nodes contain transformation and scale information
 		void debugDump() const;
@@ -183,19 +323,120 @@ namespace Ogre_glTF
 		/// \param type the string that represent the type of the buffer
 		static Ogre::VertexElementSemantic getVertexElementScemantic(const std::string& type);
 
-		///Get a IntexBufferPacked object from the VaoManager for the current accessor. Accessor is found on the mesh object, and point to the buffer alongside some metadata
+		///Get the mesh that is going to be loaded from the file
+		const tinygltf::Mesh& getMainMesh() const;
+
+		///Convert a glTF primitive mode to an Ogre operation type
+		/// \param mode glTF primitive mode
+		static Ogre::OperationType getOperationType(int mode);
+
+		///Read everything that is needed to create a primitive. Only reads the model : primitives can be prepared on several threads at once
+		/// \param primitive the glTF primitive to read
+		/// \param boundingBox bounds that will be extended with this primitive's positions
+		/// \param quantization where to add what quantizing the vertices did, if it's enabled
+		primitiveData preparePrimitive(const tinygltf::Primitive& primitive, Ogre::Aabb& boundingBox, quantizationReport& quantization) const;
+
+		///Read and interleave the vertices of a primitive, with its bone assignments, but not its indices
+		/// \param primitive the glTF primitive to read the attributes of
+		/// \param boundingBox bounds that will be extended with this primitive's positions
+		/// \param quantization where to add what quantizing the vertices did, if it's enabled
+		primitiveData prepareVertices(const tinygltf::Primitive& primitive, Ogre::Aabb& boundingBox, quantizationReport& quantization) const;
+
+		///Reorder the triangles and vertices of a primitive for the GPU, if index optimization is enabled
+		/// \param primitive the primitive, with its final vertices and indices
+		void optimizeVertexOrder(primitiveData& primitive) const;
+
+		///Do the work on a primitive that only needs its final vertices and indices : levels of detail and shadow caster
+		/// \param primitive the prepared primitive
+		/// \param alphaTested true if its material discards pixels by their alpha
+		void finishPrimitive(primitiveData& primitive, bool alphaTested) const;
+
+		///Simplify a prepared primitive into its levels of detail. Primitives that aren't triangle lists keep all their triangles at every level
+		/// \param primitive the prepared primitive, its lodIndices are replaced
+		void generateLods(primitiveData& primitive) const;
+
+		///GPU vertex buffers already created for the mesh, by the CPU side buffer they were uploaded from
+		using uploadedVertexBuffers = std::unordered_map<const geometryBuffer<unsigned char>*, Ogre::VertexBufferPacked*>;
+
+		///Create the vertex array object (and the buffers that it uses) for a prepared primitive. Need to be called from the thread that owns the render system
+		/// \param primitive the prepared primitive
+		/// \param keepShadowCopies keep a CPU copy of the buffers
+		/// \param uploaded vertex buffers already created for the mesh. The vertices of the primitive are only uploaded if they aren't in it
+		Ogre::VertexArrayObject* createVertexArrayObject(const primitiveData& primitive, bool keepShadowCopies, uploadedVertexBuffers& uploaded) const;
+
+		///Create a vertex array object that uses the vertices of another one with other indices. Need to be called from the thread that owns the render system
+		/// \param vao the vertex array object with the vertices
+		/// \param primitive the prepared primitive
+		/// \param indices the indices, of the index type of the primitive
+		/// \param keepShadowCopies keep a CPU copy of the index buffer
+		Ogre::VertexArrayObject* createLodVertexArrayObject(const Ogre::VertexArrayObject* vao,
+															const primitiveData& primitive,
+															geometryBuffer_base& indices,
+															bool keepShadowCopies) const;
+
+		///Read the indices of a primitive. Accessor is found on the mesh object, and point to the buffer alongside some metadata
 		/// \param accessor index of the accessor to the index buffer
-		Ogre::IndexBufferPacked* extractIndexBuffer(int accessor) const;
+		/// \param primitive where to store the indices
+		void extractIndexBuffer(int accessor, primitiveData& primitive) const;
 
-		///Extract the buffer content from the attribute of a primitive of a mesh
+		///Find the buffer content of an attribute of a primitive of a mesh. Nothing is copied, the part points into the glTF buffer
 		/// \param attribute the attribute of the mesh primitive we are loading
 		vertexBufferPart extractVertexBuffer(const std::pair<std::string, int>& attribute, Ogre::Aabb& boundingBox) const;
 
-		///Construct an actual vertex buffer from a list of vertex buffer parts
+		///Construct the interleaved vertices from a list of vertex buffer parts, reading the glTF buffers in a single pass
 		/// \param parts list of vertexBufferPart to load into the vertex buffer
-		Ogre::VertexBufferPackedVec constructVertexBuffer(const std::vector<vertexBufferPart>& parts) const;
+		/// \param primitive where to store the vertices
+		void constructVertexBuffer(const std::vector<vertexBufferPart>& parts, primitiveData& primitive) const;
+
+		///Build the bone assignment list from the blend indices and blend weights parts
+		/// \param blendIndices the part that contains the joints, merged from JOINTS_0 and JOINTS_1
+		/// \param blendWeights the part that contains the weights, merged from WEIGHTS_0 and WEIGHTS_1
+		/// \param primitive where to store the bone assignments
+		static void extractBoneAssignments(const vertexBufferPart& blendIndices, const vertexBufferPart& blendWeights, primitiveData& primitive);
 
 		///Reference to a loaded model
 		tinygltf::Model& model;
+
+		///Reference to the object that knows where the buffers of the model are
+		const bufferResolver& buffers;
+
+		///Content of the mesh, once prepared
+		std::unique_ptr<meshData> preparedMesh;
+
+		///Name of the mesh given with setPreparedMesh. The model is empty in that case
+		std::string preparedMeshName;
+
+		///If true, vertex attributes are converted to smaller formats
+		bool quantizeVertices = false;
+
+		///If true, triangles and vertices are reordered so they are faster to draw
+		bool optimizeIndices = false;
+
+		///If true, primitives with more than 65535 vertices are cut in pieces that use 16 bit indices
+		bool splitLargeMeshes = false;
+
+		///Distance at which each generated level of detail starts to be used. Empty if none are generated
+		std::vector<float> lodDistances;
+
+		///Fraction of the triangles of the previous level each level of detail keeps
+		float lodReduction = 0.5f;
+
+		///If true, primitives with the same vertex format draw from one vertex buffer
+		bool poolVertexBuffers = false;
+
+		///If true, primitives that read the same attribute accessors share one vertex buffer
+		bool shareVertexBuffers = false;
+
+		///Largest number of bones a vertex keeps
+		size_t maxBoneInfluences = 4;
+
+		///If true, primitives get a position only shadow caster
+		bool shadowCasters = false;
+
+		///Fraction of the triangles of each level of detail its shadow caster keeps
+		float shadowCasterReduction = 1.0f;
+
+		///glTF primitive of each submesh, kept once the prepared mesh is released
+		std::vector<size_t> submeshPrimitives;
 	};
 }
\ No newline at end of file
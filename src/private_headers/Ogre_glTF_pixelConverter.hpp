@@ -0,0 +1,32 @@
+#pragma once
+
+#include <OgrePrerequisites.h>
+
+namespace Ogre_glTF
+{
+	///Copy two channels of an image with 8 bits per channel into two single channel images, in one pass over the pixels. 4 channel images
+	///use SSE2 or NEON when available, 3 channel images use NEON or a generic loop
+	/// \param source the pixels, tightly packed
+	/// \param pixelCount number of pixels
+	/// \param components number of channels of the source
+	/// \param firstChannel index of the channel copied to the first image
+	/// \param secondChannel index of the channel copied to the second image
+	/// \param first where to write the first image, one byte per pixel
+	/// \param second where to write the second image, one byte per pixel
+	void splitChannels(const Ogre::uint8* source,
+					   size_t pixelCount,
+					   size_t components,
+					   size_t firstChannel,
+					   size_t secondChannel,
+					   Ogre::uint8* first,
+					   Ogre::uint8* second);
+
+	///Convert a normal map with unsigned normalized 8 bit channels to signed normalized ones : each channel goes from [0, 255] to
+	///[-127, 127], rounded to the nearest. Alpha is set to 127 (1.0). Uses SSE2 or NEON when available, and integer math otherwise
+	/// \param source the pixels, tightly packed
+	/// \param pixelCount number of pixels
+	/// \param components number of channels of the source, 3 or 4
+	/// \param twoChannels true to only write x and y, for a shader that computes z. Otherwise all the channels of the source are written
+	/// \param destination where to write the converted pixels
+	void convertNormalsToSNORM(const Ogre::uint8* source, size_t pixelCount, size_t components, bool twoChannels, Ogre::int8* destination);
+}
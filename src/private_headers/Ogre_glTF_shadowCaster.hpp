@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Ogre_glTF_modelConverter.hpp"
+
+#include <memory>
+
+namespace Ogre_glTF
+{
+	///Make the version of a primitive drawn in shadow map passes. Its vertices only have the position, the blend indices and weights of
+	///skinned primitives, and the first texture coordinates if the material is alpha tested. Vertices that only differed by what was
+	///dropped (UV or normal seams) are welded, so the shadow pass transforms fewer of them. Every level of detail of the primitive gets
+	///the same treatment
+	/// \param primitive the prepared primitive, with its levels of detail
+	/// \param keepTextureCoordinates true if the shadow pass needs the texture coordinates, for alpha testing
+	/// \param reduction fraction of the triangles of each level the shadow caster keeps. Below 1, triangle lists are simplified further
+	/// \return the shadow caster, or null if it wouldn't be any smaller than the primitive
+	std::unique_ptr<primitiveData> makeShadowCaster(const primitiveData& primitive, bool keepTextureCoordinates, float reduction);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <OgreTexture.h>
+
+#include <cstdint>
+#include <string>
+
+namespace Ogre_glTF
+{
+	///Textures named after the content of the encoded image they are made from, instead of after the file that uses them, so every
+	///file that uses the same image gets the same texture. Only the names are kept here : Ogre's TextureManager owns the textures, and
+	///the datablocks that use them hold references to them. Can be used from any thread, except releaseUnused()
+	class sharedTextures
+	{
+	public:
+		///Get the name of a texture made from an image
+		/// \param imageHash contentHash() of the encoded image file
+		/// \param suffix distinguish the different conversions of the same image
+		static std::string getName(uint64_t imageHash, const std::string& suffix);
+
+		///Note that a texture has been created under a shared name. The references the TextureManager holds are counted now, so the
+		///caller must hold the only other one
+		/// \param texture the texture that has just been created
+		/// \param imageHash contentHash() of the encoded image file it's made from
+		static void add(const Ogre::TexturePtr& texture, uint64_t imageHash);
+
+		///Check if a texture has been created under this name and hasn't been released
+		/// \param name name of the texture
+		static bool contains(const std::string& name);
+
+		///Check if a texture made from an image has been created and hasn't been released
+		/// \param imageHash contentHash() of the encoded image file
+		static bool containsImage(uint64_t imageHash);
+
+		///Remove from the TextureManager the shared textures only the TextureManager still holds a reference to.
+		///Need to be called from the thread that owns the render system
+		/// \return number of textures removed
+		static size_t releaseUnused();
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <OgreMesh2.h>
+
+namespace Ogre_glTF
+{
+	///Meshes whose submeshes draw from the same vertex buffer. Ogre has no notion of a buffer shared between submeshes : each one destroys
+	///the buffers of its VAOs, and there's no way to create a VAO that doesn't own them. Before a mesh of this list is destroyed, the VAOs
+	///of the submeshes that don't come first to a buffer are destroyed here, so every buffer is destroyed once, by Ogre. To be sure that
+	///happens first, the meshes are kept alive, with their GPU buffers, until they are released with releaseUnused(), or until Ogre shuts
+	///down : Ogre has no other notification that comes before a mesh is destroyed. They must not be unloaded in any other way.
+	///Need to be called from the thread that owns the render system
+	class sharedVertexBuffers
+	{
+	public:
+		///Take care of a mesh that has just been created with submeshes that share vertex buffers
+		/// \param mesh the mesh. The caller must hold the only reference that isn't the resource system's, checked in debug builds
+		static void add(const Ogre::MeshPtr& mesh);
+
+		///Remove from the MeshManager the meshes of this list that only the MeshManager still holds a reference to, and forget the ones
+		///that have been removed from it and nothing else holds
+		/// \return number of meshes released
+		static size_t releaseUnused();
+
+		///Give each shared buffer to a single submesh of every mesh of this list, and forget them. Called when Ogre shuts down, once the
+		///scene managers, and the items that use the meshes, are gone
+		static void releaseAll();
+	};
+}
@@ -3,6 +3,7 @@
 #include <tiny_gltf.h>
 #include <OgrePrerequisites.h>
 #include <OgreOldBone.h>
+#include "Ogre_glTF_bufferResolver.hpp"
 
 namespace Ogre_glTF
 {
@@ -12,6 +13,9 @@ namespace Ogre_glTF
 		///Reference to the model
 		tinygltf::Model& model;
 
+		///Reference to the object that knows where the buffers of the model are
+		const bufferResolver& buffers;
+
 		using tinygltfJointNodeIndex = int;
 
 		///number to increment when creating strings for skeleton with no names in glTF files
@@ -80,9 +84,14 @@ namespace Ogre_glTF
 	public:
 		///Construct the skeleton importer
 		/// \param input model where the skeleton data is loaded from
-		skeletonImporter(tinygltf::Model& input);
+		/// \param bufferAccess where to read the content of the model's buffers from
+		skeletonImporter(tinygltf::Model& input, const bufferResolver& bufferAccess);
 
 		///Return the constructed skeleton pointer
 		Ogre::v1::SkeletonPtr getSkeleton(const std::string& adapterName);
+
+		///Create a new skeleton from the first skin of the model
+		/// \param skeletonName name of the skeleton in the OldSkeletonManager. Needs to be unique
+		Ogre::v1::SkeletonPtr createSkeleton(const std::string& skeletonName);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Ogre_glTF_modelConverter.hpp"
+
+namespace Ogre_glTF
+{
+	///What compacting the skinning attributes of a primitive did
+	struct skinReport
+	{
+		///Size of the joints and weights of all the vertices before
+		size_t originalBytes = 0;
+
+		///Size of the joints and weights of all the vertices after
+		size_t compactBytes = 0;
+
+		///Number of vertices that were influenced by more bones than allowed
+		size_t prunedVertices = 0;
+
+		///Largest weight that was dropped, before renormalization
+		float largestPrunedWeight = 0;
+	};
+
+	///Merge the skinning attributes of a primitive into a single set of 4 joints and 4 weights, the only one Ogre skins with, in the
+	///smallest formats that hold them. Vertices influenced by more than maxInfluences bones keep the ones with the largest weights,
+	///renormalized. Joints are stored as VET_UBYTE4 when every joint index fits in a byte, VET_USHORT4 otherwise
+	/// \param joints the JOINTS_0 part, replaced by the merged joints
+	/// \param weights the WEIGHTS_0 part, replaced by the merged weights
+	/// \param extraJoints the JOINTS_1 part, or nullptr
+	/// \param extraWeights the WEIGHTS_1 part, or nullptr
+	/// \param maxInfluences largest number of bones a vertex keeps, between 1 and 4
+	/// \param quantizeWeights store the weights as VET_UBYTE4_NORM instead of floats. They still add up to exactly 1
+	skinReport compactSkin(vertexBufferPart& joints,
+						   vertexBufferPart& weights,
+						   const vertexBufferPart* extraJoints,
+						   const vertexBufferPart* extraWeights,
+						   size_t maxInfluences,
+						   bool quantizeWeights);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Ogre_glTF_textureImporter.hpp"
+#include <string>
+
+namespace Ogre_glTF
+{
+	///Simple file format to store a stagedImage as it is : a small header (magic number, version, width, height, Ogre pixel format,
+	///number of mipmaps, size of the pixel data) followed by the pixels and their mipmaps. Loading it back is a single read, without any
+	///decoding or conversion
+	namespace stagedImageFile
+	{
+		///Extension used for these files
+		constexpr const char* extension = ".ogltex";
+
+		///Write an image to a file. Throws FileIOError on failure
+		/// \param path where to write the file
+		/// \param image the image to write
+		void write(const std::string& path, const stagedImage& image);
+
+		///Read an image from a file. Throws FileIOError on failure
+		/// \param path the file to read
+		stagedImage read(const std::string& path);
+	}
+}
@@ -1,11 +1,68 @@
 #pragma once
 
 #include "tiny_gltf.h"
+#include "Ogre_glTF_imageDecoder.hpp"
+#include <atomic>
+#include <cstdint>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <OgreTexture.h>
 
 namespace Ogre_glTF
 {
+	class threadPool;
+	enum class mipmapFilter;
+
+	///Pixel data converted from a glTF image, ready to be uploaded into an Ogre texture. Building it doesn't touch the render system, so it can be done on any thread
+	struct stagedImage
+	{
+		///Pixels, tightly packed, in the given format. The mipmaps follow the full size image, each level half the size of the one before
+		std::vector<Ogre::uchar> pixels;
+
+		///Width of the image
+		Ogre::uint32 width = 0;
+
+		///Height of the image
+		Ogre::uint32 height = 0;
+
+		///Format of the pixel data
+		Ogre::PixelFormat format = Ogre::PF_UNKNOWN;
+
+		///Number of mipmaps after the full size image
+		Ogre::uint8 mipmaps = 0;
+	};
+
+	///The different textures the materials make from a glTF image
+	enum class textureVariant {
+		///The image as it is
+		plain,
+
+		///Greyscale texture made from the metalness channel of a metallicRoughness image
+		metalness,
+
+		///Greyscale texture made from the roughness channel of a metallicRoughness image
+		roughness,
+
+		///Normal map converted to SNORM, with two or three channels
+		normalSNORM
+	};
+
+	///A texture made from a glTF image, converted and ready to be uploaded
+	struct stagedTexture
+	{
+		///Index of the image in the glTF file
+		int imageIndex;
+
+		///Which texture of this image it is
+		textureVariant variant;
+
+		///The pixels
+		stagedImage image;
+
+		///contentHash() of the encoded image file, or 0 if it isn't known
+		uint64_t imageHash = 0;
+	};
 
 	///Import textures described in glTF into Ogre
 	class textureImporter
@@ -13,8 +70,44 @@ namespace Ogre_glTF
 		///List of the loaded basic textures
 		std::unordered_map<int, Ogre::TexturePtr> loadedTextures;
 
+		///Converted images waiting to be uploaded, by texture name
+		std::unordered_map<std::string, stagedImage> stagedImages;
+
+		///If true, images are decoded when a texture is requested, and released once uploaded
+		bool decodeOnDemand = false;
+
+		///If true, metalness and roughness textures are full RGB(A) greyscale images made one at a time
+		bool legacyMetalRough = false;
+
+		///If true, normal maps only keep x and y, as PF_R8G8_SNORM
+		bool twoChannelNormals = false;
+
+		///If true, textures are named after the content of their image, and shared with every other importer that does the same
+		bool shareTextures = false;
+
+		///If true, the whole mipmap chain of every texture is built on the CPU and uploaded with it
+		bool generateMipmapChains = false;
+
+		///contentHash() of the encoded image files, by image index
+		std::unordered_map<int, uint64_t> imageHashes;
+
+		///Names of the textures this importer has created
+		std::unordered_set<std::string> createdTextures;
+
+		///Encoded image files, by image index. Only used when decoding on demand
+		std::unordered_map<int, std::vector<unsigned char>> encodedImages;
+
+		///Pixels of the images decoded once for several files of a batch, by image index. They aren't in the model
+		std::unordered_map<int, imageDecoder::sharedPixels> sharedImagePixels;
+
+		///Names of the textures the materials still need to get from each image, by image index. Only used when decoding on demand
+		std::unordered_map<int, std::unordered_set<std::string>> pendingTextures;
+
 		///Static counter to make unique texture name. Incremented by constructor
-		static size_t id;
+		static std::atomic<size_t> id;
+
+		///Value of the counter when this importer was created
+		const size_t importerId;
 
 		///Reference to the tinygltf
 		tinygltf::Model& model;
@@ -26,27 +119,174 @@ namespace Ogre_glTF
 		///Checks that is hardware gamma enabled
 		bool isHardwareGammaEnabled() const;
 
+		///Make sure the pixels of an image are available, decoding it if needed
+		/// \param imageIndex index of the image in the glTF file
+		void decodeImage(int imageIndex) const;
+
+		///Get the decoded pixels of an image, from the model or shared with other files
+		/// \param imageIndex index of the image in the glTF file
+		const std::vector<unsigned char>& getPixels(int imageIndex) const;
+
+		///Note that a texture made from an image has been uploaded. When decoding on demand, release the image once nothing needs it anymore.
+		///Shared textures are registered with the references that exist at this point, call it before keeping one
+		/// \param imageIndex index of the image in the glTF file
+		/// \param texture the texture that has been created
+		void textureCreated(int imageIndex, const Ogre::TexturePtr& texture);
+
+		///Check if a texture has been created, by this importer, or by any importer for a shared texture. Doesn't ask the
+		///TextureManager, can be called from a worker thread
+		/// \param name name of the texture
+		bool isTextureCreated(const std::string& name) const;
+
+		///Check if the textures made from an image are named after its content
+		/// \param imageIndex index of the image in the glTF file
+		bool isShared(int imageIndex) const;
+
+		///Get the index of the image a texture uses
+		/// \param glTFTextureIndex index of a texture in the gltf file
+		int getImageIndex(int glTFTextureIndex) const;
+
+		///Get the name of the texture made from an image
+		/// \param imageIndex index of the image in the glTF file
+		/// \param suffix distinguish the different conversions of the same image
+		std::string getTextureName(int imageIndex, const std::string& suffix = "") const;
+
+		///Get the name of the greyscale texture made from one channel of an image
+		std::string getGreyScaleTextureName(int imageIndex, int channel) const;
+
+		///Get the name of the normal map texture converted to SNORM
+		std::string getNormalSNORMTextureName(int imageIndex) const;
+
+		///Get the name of one of the textures made from an image
+		/// \param imageIndex index of the image in the glTF file
+		/// \param variant which texture
+		std::string getVariantName(int imageIndex, textureVariant variant) const;
+
+		///Call a function for each texture the materials are going to ask for, the same way materialLoader reads them.
+		///A texture used by multiple materials is listed multiple times
+		/// \param use function that takes the index of an image and a textureVariant
+		template <typename textureUse>
+		void forEachMaterialTexture(textureUse use) const;
+
+		///Get the Ogre pixel format that matches the pixels tinygltf loaded
+		/// \param image the image loaded by tinygltf
+		/// \param name name of the texture, for error reporting
+		static Ogre::PixelFormat getPixelFormat(const tinygltf::Image& image, const std::string& name);
+
+		///Build a greyscale image containing one channel of a glTF image
+		/// \param imageIndex index of the image in the glTF file
+		/// \param channel index of a channel. Starts from zero
+		stagedImage stageGreyScale(int imageIndex, int channel) const;
+
+		///Build the metalness and roughness textures of a metallicRoughness image, one byte per pixel, in a single pass over the image
+		/// \param imageIndex index of the image in the glTF file
+		/// \return the metalness image, and the roughness image
+		std::pair<stagedImage, stagedImage> stageMetalRough(int imageIndex) const;
+
+		///Check if a texture is made by stageMetalRough(), along with another one
+		/// \param variant which texture
+		bool isStagedInPairs(textureVariant variant) const;
+
+		///Stage the metalness and roughness textures of an image that aren't already waiting to be uploaded
+		/// \param imageIndex index of the image in the glTF file
+		void stageMetalRoughPair(int imageIndex);
+
+		///Build a normal map in a SNORM format from a glTF image
+		/// \param imageIndex index of the image in the glTF file
+		stagedImage stageNormalSNORM(int imageIndex) const;
+
+		///Copy the pixels of a glTF image as they are
+		/// \param imageIndex index of the image in the glTF file
+		stagedImage stagePlain(int imageIndex) const;
+
+		///Build one of the textures made from an image
+		/// \param imageIndex index of the image in the glTF file
+		/// \param variant which texture
+		stagedImage stageVariant(int imageIndex, textureVariant variant) const;
+
+		///Get how the mipmaps of one of the textures made from an image are filtered. Base colour and emissive images are sRGB
+		/// \param variant which texture
+		static mipmapFilter getMipmapFilter(textureVariant variant);
+
+		///Get the staged image for this name, or build it if it hasn't been prepared in advance
+		/// \param name name of the texture
+		/// \param stage function that builds the image
+		template <typename stagingFunction>
+		stagedImage takeStagedImage(const std::string& name, stagingFunction stage);
+
+		///Create a texture and upload a staged image into it, with all its mipmaps
+		/// \param name name of the texture to create
+		/// \param image the pixels to upload
+		Ogre::TexturePtr createTexture(const std::string& name, const stagedImage& image) const;
+
 	public:
+		///Get what is appended to the name of an image's texture to make the name of one of its variants
+		/// \param variant which texture
+		static std::string getVariantSuffix(textureVariant variant);
+
+		///Channel of the metallicRoughness images that contains the metalness (blue)
+		static constexpr int metalnessChannel = 2;
+
+		///Channel of the metallicRoughness images that contains the roughness (green)
+		static constexpr int roughnessChannel = 1;
+
 		///Construct the texture importer object. Inrement the id counter
 		/// \param input reference to the model that we are loading
 		textureImporter(tinygltf::Model& input);
 
-		///Load all the textures in the model
+		///Do the pixel conversions needed by the materials of the model in advance. Doesn't touch the render system, can be called from a worker thread
+		/// \param workers if not null, the mipmap chains of the textures are built in parallel on them
+		void prepareTextures(threadPool* workers = nullptr);
+
+		///Load all the textures in the model. Does nothing when decoding on demand, textures are then loaded when they are requested
 		void loadTextures();
 
-		///Get the loaded texture that corespound to the given index
-		/// \param glTFTextureSourceID index of a texture in the gltf file
-		Ogre::TexturePtr getTexture(int glTFTextureSourceID);
+		///Make the metalness and roughness textures the way older versions did : two full RGB(A) greyscale images, one pass over the
+		///image for each. Only useful to compare with the single channel textures made in one pass
+		/// \param enabled true to use the old conversion
+		void setLegacyMetalRough(bool enabled);
 
-		///Get the texture that corespound to the given index, but as a greyscale one containing only
-		///the information of the given channel. It seems that the order of channel on loaded textures
-		///is BGR
-		/// \param gltfTextureSourceID index of a texture in the gltf file
-		/// \param channel index of a channel. Starts from zero
-		Ogre::TexturePtr generateGreyScaleFromChannel(int gltfTextureSourceID, int channel);
+		///Store normal maps on two channels, x and y, that Hlms computes z from. Half the memory of RGBA normal maps
+		/// \param enabled true to drop z
+		void setTwoChannelNormals(bool enabled);
+
+		///Name the textures after the content of the image they're made from, so the importers of all the files that use the same image
+		///get the same texture. Needs the image hashes
+		/// \param enabled true to share the textures
+		void setTextureSharing(bool enabled);
+
+		///Build the whole mipmap chain of every texture on the CPU, and upload it with the texture. Done while the textures are
+		///prepared when possible, on the worker threads
+		/// \param enabled true to generate the mipmaps
+		void setMipmapGeneration(bool enabled);
+
+		///Give the hash of the encoded image files, used to name shared textures
+		/// \param hashes contentHash() of each image file, by image index
+		void setImageHashes(std::unordered_map<int, uint64_t> hashes);
+
+		///Give the encoded files of images that weren't decoded because shared textures were already made from them. They are only
+		///decoded if one of their textures is missing after all
+		/// \param images encoded image files, by image index
+		void addSkippedImages(std::unordered_map<int, std::vector<unsigned char>> images);
+
+		///Give the pixels of the images decoded once for several files of a batch. The model only has their size
+		/// \param pixels decoded pixels, by image index
+		void addSharedPixels(std::unordered_map<int, imageDecoder::sharedPixels> pixels);
+
+		///Switch to decoding on demand : images are only decoded when a texture that uses them is requested
+		/// \param images encoded image files, by image index
+		void setEncodedImages(std::unordered_map<int, std::vector<unsigned char>> images);
+
+		///Build every texture the materials use, without creating anything in Ogre. Used to write them to disk
+		std::vector<stagedTexture> stageAll() const;
+
+		///Give textures that have already been converted. They are uploaded as they are when the materials ask for them
+		/// \param textures the converted textures
+		void addStagedTextures(std::vector<stagedTexture> textures);
 
-		///Get the normal texture in a compatible format
-		/// \param gltfTextureSourceID index of a texture in the gltf file
-		Ogre::TexturePtr getNormalSNORM(int gltfTextureSourceID);
+		///Get one of the textures made from an image. It's created the first time it's requested
+		/// \param imageIndex index of the image in the glTF file
+		/// \param variant which texture
+		Ogre::TexturePtr getVariantTexture(int imageIndex, textureVariant variant);
 	};
-}
\ No newline at end of file
+}
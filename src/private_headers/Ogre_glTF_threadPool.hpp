@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///Fixed set of worker threads executing tasks. Each worker has its own queue : tasks pushed from a worker go to its own queue,
+	///and a worker that runs out of work steals from the others. Tasks can wait for other tasks with get(), that keeps executing
+	///queued work in the meantime, so nested tasks can't exhaust the pool
+	class threadPool
+	{
+		///Queue of tasks of one worker
+		struct workQueue
+		{
+			///Tasks waiting to be executed. The owner takes from the back, thieves from the front
+			std::deque<std::function<void()>> tasks;
+
+			///Protect the task list
+			std::mutex mutex;
+		};
+
+		///One queue per worker thread
+		std::vector<std::unique_ptr<workQueue>> queues;
+
+		///The worker threads
+		std::vector<std::thread> workers;
+
+		///Number of tasks sitting in the queues
+		std::atomic<size_t> pendingTasks { 0 };
+
+		///Used to distribute tasks pushed from outside the pool
+		std::atomic<size_t> nextQueue { 0 };
+
+		///Protect the sleeping of the workers
+		std::mutex sleepMutex;
+
+		///Signaled when a task is pushed, or when the pool is stopping
+		std::condition_variable tasksAvailable;
+
+		///Set to true by the destructor to make the workers quit
+		bool stopping = false;
+
+		///What a worker thread does until the pool is destroyed
+		/// \param index index of the worker, and of its queue
+		void workerLoop(size_t index);
+
+		///Push a task in a queue and wake up a worker
+		void push(std::function<void()> task);
+
+		///Take a task from the queue of the current worker, or steal one from another queue, and execute it
+		/// \return false if there was nothing to do
+		bool runPendingTask();
+
+		///Get the index of the queue owned by the calling thread
+		/// \return the number of queues if the calling thread isn't a worker of this pool
+		size_t currentQueue() const;
+
+	public:
+		///Start the worker threads
+		/// \param threadCount number of threads to start. 0 means one per hardware thread
+		threadPool(size_t threadCount = 0);
+
+		///Finish the remaining tasks and join the worker threads
+		~threadPool();
+
+		///Deleted copy constructor : non copyable class
+		threadPool(const threadPool&) = delete;
+
+		///Deleted assignment operator : non copyable class
+		threadPool& operator=(const threadPool&) = delete;
+
+		///Get the number of worker threads
+		size_t size() const;
+
+		///Execute a function on one of the worker threads
+		/// \param task callable object that takes no argument
+		/// \return future that will hold the value returned by the task (or the exception it has thrown)
+		template <typename Function>
+		auto submit(Function&& task) -> std::future<decltype(task())>
+		{
+			using resultType  = decltype(task());
+			auto packagedTask = std::make_shared<std::packaged_task<resultType()>>(std::forward<Function>(task));
+			auto result		  = packagedTask->get_future();
+			push([packagedTask] { (*packagedTask)(); });
+			return result;
+		}
+
+		///Wait for the result of a task, executing the queued tasks in the meantime. Safe to call from a worker thread
+		/// \param result future returned by submit(), or a shared_future made from it
+		template <typename futureType>
+		auto get(futureType& result) -> decltype(result.get())
+		{
+			while(result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				//Nothing left to help with, the task we're waiting for is running on another thread
+				if(!runPendingTask()) result.wait_for(std::chrono::milliseconds(1));
+			}
+			return result.get();
+		}
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///Where to read one vertex attribute from
+	struct vertexSource
+	{
+		///Address of the attribute of the first vertex
+		const unsigned char* address;
+
+		///Number of bytes between the attribute of two consecutive vertices
+		size_t stride;
+
+		///Size in bytes of the attribute
+		size_t size;
+	};
+
+	///Write the attributes of each vertex one after the other, in the order of the sources. The common layouts (position, normal,
+	///tangent, texture coordinates, with or without joints and weights) have copy kernels specialised for their attribute sizes : each
+	///attribute of a vertex is copied with fixed size copies, in a loop without virtual calls or runtime sizes. Other layouts use a
+	///generic loop
+	/// \param sources where to read each attribute from. Attribute sizes need to be multiples of 4 bytes, as glTF requires
+	/// \param destination where to write the interleaved vertices. Needs to hold vertexCount times the sum of the attribute sizes
+	/// \param vertexCount number of vertices to write
+	void interleaveVertices(const std::vector<vertexSource>& sources, unsigned char* destination, size_t vertexCount);
+}
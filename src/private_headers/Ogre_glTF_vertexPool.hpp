@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Ogre_glTF_modelConverter.hpp"
+
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///Put the vertices of the primitives that have the same vertex format and index type one after the other in a single buffer, uploaded
+	///once. Each primitive stays its own submesh : its indices, and the ones of its levels of detail, are moved to its range of the buffer.
+	///Primitives with 16 bit indices are only pooled while the vertices still fit 16 bit indices. Primitives that already draw from the
+	///same vertices as another one, and primitives without indices, are left alone
+	/// \param primitives the finished primitives. Their shadow casters keep their own vertices
+	/// \return number of vertex buffers the pooled primitives were put in
+	size_t poolVertices(std::vector<primitiveData>& primitives);
+}
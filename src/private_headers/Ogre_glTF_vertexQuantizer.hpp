@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Ogre_glTF_modelConverter.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Ogre_glTF
+{
+	///What quantizing the vertices of a mesh saved, and what it cost in precision
+	struct quantizationReport
+	{
+		///Size of the vertices before quantization
+		size_t originalBytes = 0;
+
+		///Size of the vertices after quantization
+		size_t quantizedBytes = 0;
+
+		///Largest distance between a quantized position and the original one
+		float maxPositionError = 0;
+
+		///Largest angle, in degrees, between a quantized normal and the original one
+		float maxNormalAngle = 0;
+
+		///Largest difference between a quantized texture coordinate and the original one
+		float maxTexCoordError = 0;
+
+		///Add the content of another report to this one
+		/// \param other report of another primitive
+		void merge(const quantizationReport& other);
+
+		///Describe the report in one line, for the log
+		std::string toString() const;
+	};
+
+	///Convert the float vertex attributes of a primitive to smaller formats Ogre can read directly :
+	///normals and tangents become a QTangent (VES_NORMAL as VET_SHORT4_SNORM, that Hlms decodes to a normal, a tangent and the bitangent
+	///reflection), texture coordinates become VET_HALF2, and positions VET_HALF4. Texture coordinates and positions are only converted if
+	///half floats are precise enough for them
+	class vertexQuantizer
+	{
+		///What has been done so far
+		quantizationReport report;
+
+		///Replace a 3 float position part with a half float one, if it's precise enough
+		/// \param position the part to convert
+		void quantizePositions(vertexBufferPart& position);
+
+		///Replace a 2 float texture coordinate part with a half float one, if it's precise enough
+		/// \param texCoords the part to convert
+		void quantizeTexCoords(vertexBufferPart& texCoords);
+
+	public:
+		///Largest error allowed on positions, relative to the diagonal of the primitive's bounding box
+		static constexpr float positionTolerance = 1.0f / 1024.0f;
+
+		///Largest error allowed on texture coordinates. A quarter of a texel of a 1024x1024 texture
+		static constexpr float texCoordTolerance = 1.0f / 4096.0f;
+
+		///Replace the normal and tangent parts with a QTangent part
+		/// \param parts attributes of the primitive
+		void encodeNormals(std::vector<vertexBufferPart>& parts);
+
+		///Quantize the attributes of a primitive. Converted parts own their data, the other ones are left as they are
+		/// \param parts attributes of the primitive
+		void quantize(std::vector<vertexBufferPart>& parts);
+
+		///Get what has been done so far
+		const quantizationReport& getReport() const;
+	};
+}